@@ -0,0 +1,341 @@
+// Throughput benchmarks of the emulator core.
+//
+// Usage: cynes_bench [--frames N] [--threads N] [--json] rom.nes [rom.nes ...]
+//
+// For each ROM, the suite first checks that `NES::step_until`, stopped every few
+// instructions or cycles, ends in the same state as a continuous `NES::step`, with and
+// without the idle loop skipping. It then measures:
+// - step: frames per second of a single headless emulator, with and without the
+//   composition of the frame buffer;
+// - state: latency of a save + load round-trip, uncompressed and compressed;
+// - scaling: aggregated frames per second of 1 to N emulators stepped on as many
+//   threads by `cynes::Pool`.
+//
+// The default output is a human readable table, `--json` prints one JSON object per
+// measurement and per line instead, to be collected and compared across commits.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cartridge.hpp"
+#include "nes.hpp"
+#include "pool.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/// Frames stepped before any measurement, skipping the boot sequence of the games.
+const unsigned int WARMUP_FRAMES = 120;
+
+/// Frames run by the consistency checks, at most.
+const unsigned int CHECK_FRAMES = 300;
+
+/// Benchmark settings.
+struct Options {
+    unsigned int frames = 600;
+    unsigned int threads = 0;
+    bool json = false;
+    std::vector<std::string> roms;
+};
+
+/// Single measurement of the suite.
+struct Result {
+    std::string rom;
+    uint16_t mapper;
+    std::string benchmark;
+    unsigned int threads;
+    double value;
+    const char* unit;
+};
+
+double get_elapsed_seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Deterministic controller inputs, so that every run emulates the same frames.
+uint16_t get_controllers(unsigned int frame) {
+    uint32_t state = frame * 0x9E3779B1u;
+    return static_cast<uint16_t>(state >> 16) & 0x00FF;
+}
+
+void warmup(cynes::NES& nes) {
+    for (unsigned int frame = 0; frame < WARMUP_FRAMES; frame++) {
+        nes.step(get_controllers(frame), 1, cynes::RenderPolicy::NONE);
+    }
+}
+
+double bench_step(
+    const std::shared_ptr<const cynes::Cartridge>& cartridge,
+    unsigned int frames,
+    cynes::RenderPolicy policy
+) {
+    cynes::NES nes{cartridge};
+    warmup(nes);
+
+    auto start = Clock::now();
+
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        nes.step(get_controllers(frame), 1, policy);
+    }
+
+    return frames / get_elapsed_seconds(start);
+}
+
+// Run the frames through `step_until` calls bounded by `options`, which must end in
+// the same state as the frames run at once.
+void check_step_until(
+    const std::shared_ptr<const cynes::Cartridge>& cartridge,
+    unsigned int frames,
+    const cynes::StepOptions& options,
+    bool idle_loop_skip
+) {
+    cynes::NES reference{cartridge};
+    cynes::NES chopped{cartridge};
+
+    reference.cpu.set_idle_loop_skip(idle_loop_skip);
+    chopped.cpu.set_idle_loop_skip(idle_loop_skip);
+
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        reference.step(get_controllers(frame), 1, cynes::RenderPolicy::NONE);
+
+        while (chopped.step_until(get_controllers(frame), 1, options, cynes::RenderPolicy::NONE).frames == 0) { }
+    }
+
+    if (chopped.state_hash() != reference.state_hash()) {
+        throw std::runtime_error(
+            std::string{"step_until diverges from step"}
+            + (idle_loop_skip ? " with the idle loop skipping." : ".")
+        );
+    }
+}
+
+void check_step(const std::shared_ptr<const cynes::Cartridge>& cartridge, unsigned int frames) {
+    for (uint64_t limit : {100u, 7000u}) {
+        cynes::StepOptions instructions{};
+        instructions.max_instructions = limit;
+
+        cynes::StepOptions cycles{};
+        cycles.max_cycles = limit;
+
+        for (bool idle_loop_skip : {false, true}) {
+            check_step_until(cartridge, frames, instructions, idle_loop_skip);
+            check_step_until(cartridge, frames, cycles, idle_loop_skip);
+        }
+    }
+}
+
+double bench_state(
+    const std::shared_ptr<const cynes::Cartridge>& cartridge,
+    unsigned int iterations,
+    bool compressed
+) {
+    cynes::NES nes{cartridge};
+    warmup(nes);
+
+    const unsigned int size = compressed ? nes.compressed_size_bound() : nes.size();
+    std::unique_ptr<uint8_t[]> buffer{new uint8_t[size]};
+
+    auto start = Clock::now();
+
+    for (unsigned int k = 0; k < iterations; k++) {
+        if (compressed) {
+            nes.load(buffer.get(), nes.save_compressed(buffer.get()));
+        } else {
+            nes.save(buffer.get());
+            nes.load(buffer.get(), size);
+        }
+    }
+
+    return get_elapsed_seconds(start) * 1e6 / iterations;
+}
+
+double bench_scaling(
+    const std::shared_ptr<const cynes::Cartridge>& cartridge,
+    unsigned int frames,
+    unsigned int threads
+) {
+    std::vector<std::unique_ptr<cynes::NES>> emulators;
+    std::vector<cynes::NES*> pointers;
+
+    for (unsigned int k = 0; k < threads; k++) {
+        emulators.emplace_back(new cynes::NES{cartridge});
+        pointers.push_back(emulators.back().get());
+    }
+
+    cynes::Pool pool{pointers, threads};
+
+    // Emulators are stepped one frame per job, giving the pool the same scheduling
+    // pattern as a reinforcement learning rollout.
+    auto run = [&](unsigned int count) {
+        for (unsigned int frame = 0; frame < count; frame++) {
+            for (size_t k = 0; k < pointers.size(); k++) {
+                uint16_t controllers = get_controllers(frame + static_cast<unsigned int>(k));
+                pool.submit({k, controllers, 1, cynes::RenderPolicy::NONE});
+            }
+
+            pool.wait_all();
+
+            cynes::StepCompletion completion;
+
+            while (pool.poll(completion)) { }
+        }
+    };
+
+    run(WARMUP_FRAMES);
+
+    auto start = Clock::now();
+    run(frames);
+
+    return frames * threads / get_elapsed_seconds(start);
+}
+
+std::string escape_json(const std::string& value) {
+    std::string escaped;
+
+    for (char character : value) {
+        if (character == '"' || character == '\\') {
+            escaped += '\\';
+        }
+
+        escaped += character;
+    }
+
+    return escaped;
+}
+
+void print_result(const Result& result, bool json) {
+    if (json) {
+        std::printf(
+            "{\"rom\": \"%s\", \"mapper\": %u, \"benchmark\": \"%s\", \"threads\": %u, "
+            "\"value\": %.3f, \"unit\": \"%s\"}\n",
+            escape_json(result.rom).c_str(),
+            result.mapper,
+            result.benchmark.c_str(),
+            result.threads,
+            result.value,
+            result.unit
+        );
+    } else {
+        std::printf(
+            "%-32s %6u  %-24s %7u %14.2f %s\n",
+            result.rom.c_str(),
+            result.mapper,
+            result.benchmark.c_str(),
+            result.threads,
+            result.value,
+            result.unit
+        );
+    }
+
+    std::fflush(stdout);
+}
+
+unsigned int parse_unsigned(const char* value, const char* option) {
+    char* end = nullptr;
+    unsigned long parsed = std::strtoul(value, &end, 10);
+
+    if (end == value || *end != '\0' || parsed == 0) {
+        throw std::invalid_argument(std::string{"Invalid value for "} + option + ".");
+    }
+
+    return static_cast<unsigned int>(parsed);
+}
+
+Options parse_options(int argc, char** argv) {
+    Options options{};
+
+    for (int k = 1; k < argc; k++) {
+        if (std::strcmp(argv[k], "--json") == 0) {
+            options.json = true;
+        } else if (std::strcmp(argv[k], "--frames") == 0 && k + 1 < argc) {
+            options.frames = parse_unsigned(argv[++k], "--frames");
+        } else if (std::strcmp(argv[k], "--threads") == 0 && k + 1 < argc) {
+            options.threads = parse_unsigned(argv[++k], "--threads");
+        } else if (argv[k][0] == '-') {
+            throw std::invalid_argument(std::string{"Unknown option "} + argv[k] + ".");
+        } else {
+            options.roms.push_back(argv[k]);
+        }
+    }
+
+    if (options.roms.empty()) {
+        throw std::invalid_argument("No ROM given.");
+    }
+
+    if (options.threads == 0) {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    return options;
+}
+}
+
+
+int main(int argc, char** argv) {
+    Options options;
+
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        std::fprintf(
+            stderr,
+            "Usage: %s [--frames N] [--threads N] [--json] rom.nes [rom.nes ...]\n",
+            argv[0]
+        );
+
+        return 2;
+    }
+
+    if (!options.json) {
+        std::printf(
+            "%-32s %6s  %-24s %7s %14s\n", "rom", "mapper", "benchmark", "threads", "value"
+        );
+    }
+
+    int status = 0;
+
+    for (const std::string& rom : options.roms) {
+        try {
+            auto cartridge = cynes::Cartridge::load(rom);
+            uint16_t mapper = cartridge->get_mapper_index();
+
+            auto report = [&](const char* benchmark, unsigned int threads, double value, const char* unit) {
+                print_result({rom, mapper, benchmark, threads, value, unit}, options.json);
+            };
+
+            check_step(cartridge, std::min(options.frames, CHECK_FRAMES));
+
+            report("step", 1, bench_step(cartridge, options.frames, cynes::RenderPolicy::ALL), "fps");
+            report("step_no_render", 1, bench_step(cartridge, options.frames, cynes::RenderPolicy::NONE), "fps");
+            report("save_load", 1, bench_state(cartridge, options.frames, false), "us");
+            report("save_load_compressed", 1, bench_state(cartridge, options.frames, true), "us");
+
+            // Powers of two, always followed by the requested thread count.
+            std::vector<unsigned int> thread_counts;
+
+            for (unsigned int threads = 1; threads < options.threads; threads <<= 1) {
+                thread_counts.push_back(threads);
+            }
+
+            thread_counts.push_back(options.threads);
+
+            for (unsigned int threads : thread_counts) {
+                report("scaling", threads, bench_scaling(cartridge, options.frames, threads), "fps");
+            }
+        } catch (const std::exception& error) {
+            std::fprintf(stderr, "%s: %s\n", rom.c_str(), error.what());
+            status = 1;
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,424 @@
+// Headless runner, for offline bulk evaluation without Python.
+//
+// Usage: cynes_run [options] rom.nes input [input ...]
+//
+// Each input is either a tape or a save state:
+// - a tape is a raw array of little-endian 16-bit controller states, run from the
+//   power-up state (or from `--start`), each action being held `--frames-per-action`
+//   frames;
+// - a save state, as written by `NES.save`, is loaded and run for `--frames` frames
+//   with the controllers released.
+//
+// Inputs are distributed over `--threads` worker threads, each owning a single emulator
+// reused across its runs. Once an input has run, its console RAM is written to
+// `<output>/<name>.ram`, and a tab separated line is printed with the number of frames,
+// the crash flag, the state hash and the RAM hash. With `--dump-every N`, the frame
+// buffer is also written every N frames to `<output>/<name>_<frame>.png` (or `.rgb`
+// with `--dump-format raw`).
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cartridge.hpp"
+#include "nes.hpp"
+
+namespace {
+/// First bytes of every save state, see `NES::save`.
+const char STATE_MAGIC[4] = {'C', 'Y', 'N', 'S'};
+
+const unsigned int FRAME_WIDTH = 256;
+const unsigned int FRAME_HEIGHT = 240;
+
+/// Runner settings.
+struct Options {
+    unsigned int threads = 0;
+    unsigned int frames = 600;
+    unsigned int frames_per_action = 1;
+    unsigned int dump_every = 0;
+    bool dump_png = true;
+    std::string start;
+    std::filesystem::path output = ".";
+    std::string rom;
+    std::vector<std::string> inputs;
+};
+
+/// Outcome of a single input.
+struct Result {
+    unsigned int frames = 0;
+    bool crashed = false;
+    uint64_t state_hash = 0;
+    uint64_t ram_hash = 0;
+    std::string error;
+};
+
+std::vector<uint8_t> read_file(const std::string& path) {
+    std::ifstream stream{path, std::ios::binary};
+
+    if (!stream.is_open()) {
+        throw std::runtime_error("The file " + path + " cannot be read.");
+    }
+
+    return {std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+}
+
+void write_file(const std::filesystem::path& path, const uint8_t* data, size_t size) {
+    std::ofstream stream{path, std::ios::binary};
+
+    if (!stream.is_open()) {
+        throw std::runtime_error("The file " + path.string() + " cannot be written.");
+    }
+
+    stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+bool is_save_state(const std::vector<uint8_t>& data) {
+    return data.size() >= 4 && std::memcmp(data.data(), STATE_MAGIC, 4) == 0;
+}
+
+uint32_t get_crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static const std::vector<uint32_t> TABLE = [] {
+        std::vector<uint32_t> table(256);
+
+        for (uint32_t k = 0; k < 256; k++) {
+            uint32_t value = k;
+
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+
+            table[k] = value;
+        }
+
+        return table;
+    }();
+
+    crc = ~crc;
+
+    for (size_t k = 0; k < size; k++) {
+        crc = TABLE[(crc ^ data[k]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+void append_u32(std::vector<uint8_t>& buffer, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        buffer.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void append_chunk(std::vector<uint8_t>& buffer, const char* type, const std::vector<uint8_t>& data) {
+    append_u32(buffer, static_cast<uint32_t>(data.size()));
+
+    size_t start = buffer.size();
+
+    buffer.insert(buffer.end(), type, type + 4);
+    buffer.insert(buffer.end(), data.begin(), data.end());
+
+    append_u32(buffer, get_crc32(buffer.data() + start, buffer.size() - start));
+}
+
+// The frames are small and written rarely, the image data is stored in uncompressed
+// deflate blocks rather than pulling a compression library in.
+std::vector<uint8_t> encode_png(const uint8_t* rgb) {
+    const size_t row_size = FRAME_WIDTH * 3;
+
+    std::vector<uint8_t> scanlines;
+    scanlines.reserve(FRAME_HEIGHT * (row_size + 1));
+
+    for (unsigned int y = 0; y < FRAME_HEIGHT; y++) {
+        scanlines.push_back(0x00);
+        scanlines.insert(scanlines.end(), rgb + y * row_size, rgb + (y + 1) * row_size);
+    }
+
+    std::vector<uint8_t> deflate{0x78, 0x01};
+
+    for (size_t offset = 0; offset < scanlines.size(); offset += 0xFFFF) {
+        size_t length = std::min<size_t>(0xFFFF, scanlines.size() - offset);
+        bool last = offset + length == scanlines.size();
+
+        deflate.push_back(last ? 0x01 : 0x00);
+        deflate.push_back(static_cast<uint8_t>(length));
+        deflate.push_back(static_cast<uint8_t>(length >> 8));
+        deflate.push_back(static_cast<uint8_t>(~length));
+        deflate.push_back(static_cast<uint8_t>(~length >> 8));
+        deflate.insert(deflate.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+    }
+
+    uint32_t a = 1;
+    uint32_t b = 0;
+
+    for (uint8_t value : scanlines) {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+
+    append_u32(deflate, b << 16 | a);
+
+    std::vector<uint8_t> header;
+    append_u32(header, FRAME_WIDTH);
+    append_u32(header, FRAME_HEIGHT);
+    header.insert(header.end(), {0x08, 0x02, 0x00, 0x00, 0x00});
+
+    std::vector<uint8_t> png{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    append_chunk(png, "IHDR", header);
+    append_chunk(png, "IDAT", deflate);
+    append_chunk(png, "IEND", {});
+
+    return png;
+}
+
+void dump_frame(const Options& options, const std::string& name, const cynes::NES& nes, unsigned int frame) {
+    std::string path = name + "_" + std::to_string(frame) + (options.dump_png ? ".png" : ".rgb");
+
+    if (options.dump_png) {
+        std::vector<uint8_t> png = encode_png(nes.get_frame_buffer());
+        write_file(options.output / path, png.data(), png.size());
+    } else {
+        write_file(options.output / path, nes.get_frame_buffer(), FRAME_WIDTH * FRAME_HEIGHT * 3);
+    }
+}
+
+/// Step the emulator, rendering only the frames that are dumped.
+/// @return The number of frames actually run, short of `frames` when the CPU crashed.
+unsigned int run_frames(
+    const Options& options,
+    const std::string& name,
+    cynes::NES& nes,
+    uint16_t controllers,
+    unsigned int frames,
+    unsigned int& frame
+) {
+    for (unsigned int k = 0; k < frames; k++) {
+        bool dumped = options.dump_every > 0 && (frame + 1) % options.dump_every == 0;
+
+        if (nes.step(controllers, 1, dumped ? cynes::RenderPolicy::ALL : cynes::RenderPolicy::NONE)) {
+            return k;
+        }
+
+        frame++;
+
+        if (dumped) {
+            dump_frame(options, name, nes, frame);
+        }
+    }
+
+    return frames;
+}
+
+Result run_input(
+    const Options& options,
+    cynes::NES& nes,
+    std::vector<uint8_t>& start,
+    const std::string& input
+) {
+    Result result{};
+
+    std::vector<uint8_t> data = read_file(input);
+    std::string name = std::filesystem::path{input}.stem().string();
+
+    if (is_save_state(data)) {
+        nes.load(data.data(), static_cast<unsigned int>(data.size()));
+
+        result.crashed = run_frames(options, name, nes, 0x00, options.frames, result.frames) < options.frames;
+    } else {
+        if (data.size() % 2 != 0) {
+            throw std::runtime_error("The tape should hold 16-bit controller states.");
+        }
+
+        nes.load(start.data(), static_cast<unsigned int>(start.size()));
+
+        for (size_t k = 0; k < data.size() && !result.crashed; k += 2) {
+            uint16_t controllers = static_cast<uint16_t>(data[k] | data[k + 1] << 8);
+            unsigned int frames = options.frames_per_action;
+
+            result.crashed = run_frames(options, name, nes, controllers, frames, result.frames) < frames;
+        }
+    }
+
+    uint8_t ram[0x800];
+
+    for (uint16_t address = 0; address < 0x800; address++) {
+        ram[address] = nes.peek_cpu(address);
+    }
+
+    write_file(options.output / (name + ".ram"), ram, sizeof(ram));
+
+    result.state_hash = nes.state_hash();
+    result.ram_hash = nes.ram_hash();
+
+    return result;
+}
+
+unsigned int parse_unsigned(const char* value, const char* option, bool positive = true) {
+    char* end = nullptr;
+    unsigned long parsed = std::strtoul(value, &end, 10);
+
+    if (end == value || *end != '\0' || (positive && parsed == 0)) {
+        throw std::invalid_argument(std::string{"Invalid value for "} + option + ".");
+    }
+
+    return static_cast<unsigned int>(parsed);
+}
+
+Options parse_options(int argc, char** argv) {
+    Options options{};
+
+    for (int k = 1; k < argc; k++) {
+        if (std::strcmp(argv[k], "--threads") == 0 && k + 1 < argc) {
+            options.threads = parse_unsigned(argv[++k], "--threads");
+        } else if (std::strcmp(argv[k], "--frames") == 0 && k + 1 < argc) {
+            options.frames = parse_unsigned(argv[++k], "--frames", false);
+        } else if (std::strcmp(argv[k], "--frames-per-action") == 0 && k + 1 < argc) {
+            options.frames_per_action = parse_unsigned(argv[++k], "--frames-per-action");
+        } else if (std::strcmp(argv[k], "--dump-every") == 0 && k + 1 < argc) {
+            options.dump_every = parse_unsigned(argv[++k], "--dump-every");
+        } else if (std::strcmp(argv[k], "--dump-format") == 0 && k + 1 < argc) {
+            std::string format = argv[++k];
+
+            if (format != "png" && format != "raw") {
+                throw std::invalid_argument("Invalid value for --dump-format.");
+            }
+
+            options.dump_png = format == "png";
+        } else if (std::strcmp(argv[k], "--start") == 0 && k + 1 < argc) {
+            options.start = argv[++k];
+        } else if (std::strcmp(argv[k], "--output") == 0 && k + 1 < argc) {
+            options.output = argv[++k];
+        } else if (argv[k][0] == '-') {
+            throw std::invalid_argument(std::string{"Unknown option "} + argv[k] + ".");
+        } else if (options.rom.empty()) {
+            options.rom = argv[k];
+        } else {
+            options.inputs.push_back(argv[k]);
+        }
+    }
+
+    if (options.rom.empty()) {
+        throw std::invalid_argument("No ROM given.");
+    }
+
+    if (options.inputs.empty()) {
+        throw std::invalid_argument("No input given.");
+    }
+
+    if (options.threads == 0) {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    options.threads = std::min<unsigned int>(options.threads, static_cast<unsigned int>(options.inputs.size()));
+
+    return options;
+}
+}
+
+
+int main(int argc, char** argv) {
+    Options options;
+
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        std::fprintf(
+            stderr,
+            "Usage: %s [--threads N] [--frames N] [--frames-per-action N] [--start STATE] "
+            "[--dump-every N] [--dump-format png|raw] [--output DIR] rom.nes input [input ...]\n",
+            argv[0]
+        );
+
+        return 2;
+    }
+
+    std::shared_ptr<const cynes::Cartridge> cartridge;
+    std::vector<uint8_t> start;
+
+    try {
+        cartridge = cynes::Cartridge::load(options.rom);
+
+        std::filesystem::create_directories(options.output);
+
+        // Tapes start from the same state, saved once and loaded by every run.
+        cynes::NES nes{cartridge};
+
+        if (!options.start.empty()) {
+            std::vector<uint8_t> state = read_file(options.start);
+            nes.load(state.data(), static_cast<unsigned int>(state.size()));
+        }
+
+        start.resize(nes.size());
+        nes.save(start.data());
+    } catch (const std::exception& error) {
+        std::fprintf(stderr, "%s: %s\n", options.rom.c_str(), error.what());
+
+        return 1;
+    }
+
+    std::vector<Result> results(options.inputs.size());
+    std::atomic<size_t> next{0};
+
+    // Each worker owns one emulator, reused for all of its inputs.
+    auto work = [&]() {
+        cynes::NES nes{cartridge};
+        std::vector<uint8_t> worker_start = start;
+
+        for (size_t k = next++; k < options.inputs.size(); k = next++) {
+            try {
+                results[k] = run_input(options, nes, worker_start, options.inputs[k]);
+            } catch (const std::exception& error) {
+                results[k].error = error.what();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int k = 1; k < options.threads; k++) {
+        workers.emplace_back(work);
+    }
+
+    work();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    int status = 0;
+
+    std::printf("input\tframes\tcrashed\tstate_hash\tram_hash\n");
+
+    for (size_t k = 0; k < options.inputs.size(); k++) {
+        const Result& result = results[k];
+
+        if (!result.error.empty()) {
+            std::fprintf(stderr, "%s: %s\n", options.inputs[k].c_str(), result.error.c_str());
+            status = 1;
+
+            continue;
+        }
+
+        std::printf(
+            "%s\t%u\t%d\t%016llx\t%016llx\n",
+            options.inputs[k].c_str(),
+            result.frames,
+            result.crashed ? 1 : 0,
+            static_cast<unsigned long long>(result.state_hash),
+            static_cast<unsigned long long>(result.ram_hash)
+        );
+    }
+
+    return status;
+}
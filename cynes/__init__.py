@@ -7,7 +7,9 @@ This package contains two sub-module:
 - `cynes.emulator` with the main `NES` class, which is a direct wrapper around the C/C++
   API. This class can be used to run an emulator in 'headless' mode, which means that
   nothing will be rendered to the screen. The content of the frame buffer can be
-  accessed nonetheless.
+  accessed nonetheless. The `VecNES` class runs a batch of headless emulators in
+  parallel, and the `ROM` class lets several emulators share a single copy of the game
+  data.
 - `cynes.windowed` with the `WindowedNES` class, derived from `NES`. This class is a
   simple wrapper around the base emulator providing a basic renderer and input handling
   using SDL2. The python wrapper `pysdl2` must be installed to use this class.
@@ -21,7 +23,21 @@ while not nes.should_close:
 ```
 """
 
-from cynes.emulator import NES, __version__
+from cynes.emulator import (
+    NES,
+    PROFILING_ENABLED,
+    ROM,
+    Comparison,
+    Counters,
+    FrameFormat,
+    PixelFormat,
+    RenderPolicy,
+    StatePool,
+    StepResult,
+    StopReason,
+    VecNES,
+    __version__,
+)
 
 NES_INPUT_RIGHT = 0x01
 NES_INPUT_LEFT = 0x02
@@ -35,6 +51,17 @@ NES_INPUT_A = 0x80
 __all__ = [
     "__version__",
     "NES",
+    "PROFILING_ENABLED",
+    "ROM",
+    "Comparison",
+    "Counters",
+    "FrameFormat",
+    "PixelFormat",
+    "RenderPolicy",
+    "StatePool",
+    "StepResult",
+    "StopReason",
+    "VecNES",
     "NES_INPUT_RIGHT",
     "NES_INPUT_LEFT",
     "NES_INPUT_DOWN",
@@ -0,0 +1,201 @@
+# cynes - C/C++ NES emulator with Python bindings
+# Copyright (C) 2021 - 2025  Combey Theo <https://www.gnu.org/licenses/>
+
+"""Throughput benchmarks of the Python bindings.
+
+This module runs the same suite as the native `cynes_bench` executable, through the
+Python API: the stepping speed of a single emulator, the latency of a save state
+round-trip, and the scaling of `VecNES` from 1 to N threads. It can be used as a script:
+```
+python -m cynes.bench --json rom_mapper0.nes rom_mapper1.nes
+```
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+from typing import Dict, Iterator, List, Union
+
+import numpy as np
+
+from cynes.emulator import NES, ROM, RenderPolicy, VecNES
+
+WARMUP_FRAMES = 120
+"""Frames stepped before any measurement, skipping the boot sequence of the games."""
+
+Result = Dict[str, Union[str, int, float]]
+
+
+def _get_controllers(frame: int) -> int:
+    # Same deterministic inputs as the native benchmarks.
+    return ((frame * 0x9E3779B1) & 0xFFFFFFFF) >> 16 & 0x00FF
+
+
+def _get_mapper(path_rom: str) -> int:
+    with open(path_rom, "rb") as file:
+        header = file.read(8)
+
+    return (header[6] >> 4) | (header[7] & 0xF0)
+
+
+def _warmup(nes: NES) -> None:
+    for frame in range(WARMUP_FRAMES):
+        nes.controller = _get_controllers(frame)
+        nes.step(1, RenderPolicy.NONE)
+
+
+def bench_step(rom: ROM, frames: int, render: RenderPolicy) -> float:
+    """Measure the stepping speed of a single emulator.
+
+    Args:
+        rom (ROM): The loaded ROM.
+        frames (int): The number of frames measured.
+        render (RenderPolicy): The frames to render.
+
+    Returns:
+        fps (float): The number of frames emulated per second.
+    """
+    nes = NES(rom)
+    _warmup(nes)
+
+    start = time.perf_counter()
+
+    for frame in range(frames):
+        nes.controller = _get_controllers(frame)
+        nes.step(1, render)
+
+    return frames / (time.perf_counter() - start)
+
+
+def bench_state(rom: ROM, iterations: int, compress: bool) -> float:
+    """Measure the latency of a save + load round-trip.
+
+    Args:
+        rom (ROM): The loaded ROM.
+        iterations (int): The number of round-trips measured.
+        compress (bool): Whether or not the save states are compressed.
+
+    Returns:
+        latency (float): The average latency of a round-trip, in microseconds.
+    """
+    nes = NES(rom)
+    _warmup(nes)
+
+    start = time.perf_counter()
+
+    for _ in range(iterations):
+        nes.load(nes.save(compress))
+
+    return (time.perf_counter() - start) * 1e6 / iterations
+
+
+def bench_scaling(rom: ROM, frames: int, threads: int) -> float:
+    """Measure the aggregated stepping speed of a batch of emulators.
+
+    Args:
+        rom (ROM): The loaded ROM.
+        frames (int): The number of frames measured.
+        threads (int): The number of emulators in the batch, and of threads.
+
+    Returns:
+        fps (float): The number of frames emulated per second by the whole batch.
+    """
+    batch = VecNES(rom, threads, threads)
+    offsets = np.arange(threads, dtype=np.uint32)
+
+    def run(count: int) -> None:
+        for frame in range(count):
+            controllers = ((frame + offsets) * 0x9E3779B1) >> 16 & 0x00FF
+            batch.step(controllers.astype(np.uint16), 1, RenderPolicy.NONE)
+
+    run(WARMUP_FRAMES)
+
+    start = time.perf_counter()
+    run(frames)
+
+    return frames * threads / (time.perf_counter() - start)
+
+
+def _get_thread_counts(threads: int) -> List[int]:
+    counts = []
+    count = 1
+
+    while count < threads:
+        counts.append(count)
+        count <<= 1
+
+    return counts + [threads]
+
+
+def run_suite(
+    path_roms: List[str], frames: int = 600, threads: int = 0
+) -> Iterator[Result]:
+    """Run the benchmark suite.
+
+    Args:
+        path_roms (List[str]): The paths of the ROMs to benchmark.
+        frames (int): The number of frames (or round-trips) of each measurement.
+            Default is 600.
+        threads (int): The maximum number of threads of the scaling benchmark. By
+            default, the hardware concurrency is used.
+
+    Yields:
+        result (Result): A single measurement, with the same fields as the JSON
+            output of `cynes_bench`.
+    """
+    threads = threads or os.cpu_count() or 1
+
+    for path_rom in path_roms:
+        rom = ROM(path_rom)
+        mapper = _get_mapper(path_rom)
+
+        def report(benchmark: str, count: int, value: float, unit: str) -> Result:
+            return {
+                "rom": path_rom,
+                "mapper": mapper,
+                "benchmark": benchmark,
+                "threads": count,
+                "value": round(value, 3),
+                "unit": unit,
+            }
+
+        yield report("step", 1, bench_step(rom, frames, RenderPolicy.ALL), "fps")
+        yield report(
+            "step_no_render", 1, bench_step(rom, frames, RenderPolicy.NONE), "fps"
+        )
+        yield report("save_load", 1, bench_state(rom, frames, False), "us")
+        yield report("save_load_compressed", 1, bench_state(rom, frames, True), "us")
+
+        for count in _get_thread_counts(threads):
+            yield report("scaling", count, bench_scaling(rom, frames, count), "fps")
+
+
+def main() -> int:
+    """Run the benchmark suite from the command line."""
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("roms", nargs="+", help="paths of the ROMs to benchmark")
+    parser.add_argument("--frames", type=int, default=600)
+    parser.add_argument("--threads", type=int, default=0)
+    parser.add_argument("--json", action="store_true", help="print JSON lines")
+    args = parser.parse_args()
+
+    if not args.json:
+        print(f"{'rom':32} {'mapper':>6}  {'benchmark':24} {'threads':>7} {'value':>14}")
+
+    for result in run_suite(args.roms, args.frames, args.threads):
+        if args.json:
+            print(json.dumps(result), flush=True)
+        else:
+            print(
+                f"{result['rom']:32} {result['mapper']:>6}  {result['benchmark']:24} "
+                f"{result['threads']:>7} {result['value']:>14.2f} {result['unit']}",
+                flush=True,
+            )
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
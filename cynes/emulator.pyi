@@ -1,11 +1,388 @@
 # cynes - C/C++ NES emulator with Python bindings
 # Copyright (C) 2021 - 2025  Combey Theo <https://www.gnu.org/licenses/>
 
+from typing import Dict, Union, overload
+
 import numpy as np
 from numpy.typing import NDArray
 
 __version__ = ...
 
+PROFILING_ENABLED: bool
+"""Whether or not the module was built with the `CYNES_PROFILE` option."""
+
+
+class Counters:
+    """Profiling counters of an emulator.
+
+    The counters are only updated when the module is built with the `CYNES_PROFILE`
+    CMake option, they otherwise stay zero. Times are expressed in timestamp counter
+    ticks on x86 hosts, in nanoseconds otherwise, and are inclusive: the DMC fetches
+    happening during an OAM DMA are also counted in `oam_dma_time`.
+    """
+
+    frames: int
+    """Number of frames stepped."""
+
+    cpu_instructions: int
+    """Number of CPU instructions executed."""
+
+    cpu_cycles: int
+    """Number of CPU cycles, including the DMA stalls."""
+
+    ppu_dots: int
+    """Number of PPU dots."""
+
+    oam_dma_stalls: int
+    """Number of CPU cycles stalled by the OAM DMA."""
+
+    dmc_stalls: int
+    """Number of CPU cycles stalled by the DMC sample fetches."""
+
+    idle_cycles: int
+    """Number of CPU cycles skipped in idle loops."""
+
+    mapper_writes: int
+    """Number of CPU writes to the mapper registers and RAM."""
+
+    non_maskable_interrupts: int
+    """Number of non-maskable interrupts serviced by the CPU."""
+
+    interrupts: int
+    """Number of interrupt requests serviced by the CPU."""
+
+    step_time: int
+    """Time spent stepping the emulator."""
+
+    ppu_time: int
+    """Time spent catching the PPU up (rendering, mapper clocks)."""
+
+    oam_dma_time: int
+    """Time spent in the OAM DMA transfers."""
+
+    dmc_time: int
+    """Time spent in the DMC sample fetches."""
+
+
+class RenderPolicy:
+    """Frames of a step composed into the framebuffer.
+
+    Skipped frames are still fully emulated (timings, sprite zero hit, mapper clocks,
+    ...), only the composition of their pixels is avoided.
+    """
+
+    ALL: "RenderPolicy"
+    """Every frame of the step is rendered."""
+
+    LAST: "RenderPolicy"
+    """Only the last frame of the step is rendered."""
+
+    NONE: "RenderPolicy"
+    """No frame is rendered, the framebuffer keeps its previous content."""
+
+
+class FrameFormat:
+    """Frame buffer written by the emulator and returned by `step`."""
+
+    RGB: "FrameFormat"
+    """RGB frame buffer, with a shape of (240, 256, 3)."""
+
+    INDEXED: "FrameFormat"
+    """Palette index frame buffer, with a shape of (240, 256).
+
+    Each pixel holds the 6-bit NES palette index of its color. The color emphasis bits
+    are kept per scanline, and applied when converting the frame.
+    """
+
+
+class Comparison:
+    """Comparison between a watched byte and the value of a done condition."""
+
+    EQUAL: "Comparison"
+    """The masked byte is equal to the value."""
+
+    NOT_EQUAL: "Comparison"
+    """The masked byte is different from the value."""
+
+    LESS: "Comparison"
+    """The masked byte is lower than the value."""
+
+    GREATER: "Comparison"
+    """The masked byte is greater than the value."""
+
+
+class PixelFormat:
+    """Pixel formats an indexed frame buffer can be converted to."""
+
+    RGB24: "PixelFormat"
+    """RGB pixels, with a shape of (240, 256, 3)."""
+
+    RGBA32: "PixelFormat"
+    """RGBA pixels with an opaque alpha channel, with a shape of (240, 256, 4)."""
+
+    LUMA: "PixelFormat"
+    """Grayscale pixels (BT.601 luma), with a shape of (240, 256)."""
+
+
+class StopReason:
+    """Reason for which a step ended."""
+
+    FRAMES: "StopReason"
+    """All the frames of the step were run."""
+
+    CRASHED: "StopReason"
+    """The CPU froze."""
+
+    DONE: "StopReason"
+    """A done condition was met."""
+
+    INSTRUCTIONS: "StopReason"
+    """The maximum number of instructions was reached."""
+
+    CYCLES: "StopReason"
+    """The maximum number of CPU cycles was reached."""
+
+    BREAKPOINT: "StopReason"
+    """The program counter reached a breakpoint."""
+
+    WATCH: "StopReason"
+    """A write changed the value of a watched byte."""
+
+    TIME: "StopReason"
+    """The maximum wall-clock duration was reached."""
+
+
+class StepResult:
+    """Outcome of a step with early stop conditions."""
+
+    reason: StopReason
+    """Reason for which the step ended."""
+
+    frames: int
+    """Number of frames completed."""
+
+    instructions: int
+    """Number of CPU instructions executed, interrupt sequences included."""
+
+    cycles: int
+    """Number of CPU cycles elapsed, DMA stalls included."""
+
+
+class ROM:
+    """A ROM image, parsed once and shared by every emulator created from it.
+
+    Creating many emulators from the same `ROM` avoids reading and copying the game data
+    for each of them: the PRG-ROM and CHR-ROM are kept in a single read-only copy, while
+    each emulator only allocates its own RAM (CHR-RAM, PRG-RAM and nametables).
+    """
+
+    def __init__(self, path_rom: str) -> None:
+        """Load a ROM file.
+
+        Args:
+            path_rom (str): The path to the NES ROM file containing the game data.
+
+        Raises:
+            RuntimeError: Error raised if the file cannot be read or is not a valid ROM
+                file.
+        """
+        ...
+
+    @staticmethod
+    def from_bytes(data: bytes) -> "ROM":
+        """Parse a ROM from an in-memory iNES or NES 2.0 image.
+
+        Nothing is read from the disk, which allows ROMs fetched from the network or an
+        object store to be used directly.
+
+        Args:
+            data (bytes): A contiguous buffer of bytes (e.g. `bytes`, `bytearray` or a
+                NumPy array of `uint8`) containing the image.
+
+        Returns:
+            rom (ROM): The loaded ROM.
+
+        Raises:
+            RuntimeError: Error raised if the data is not a valid ROM image.
+        """
+        ...
+
+    @property
+    def mapper(self) -> int:
+        """The iNES mapper id used by the ROM."""
+        ...
+
+    @property
+    def submapper(self) -> int:
+        """The NES 2.0 submapper id, always 0 for iNES headers."""
+        ...
+
+    @property
+    def nes2(self) -> bool:
+        """Indicate whether the header uses the NES 2.0 format."""
+        ...
+
+    @property
+    def has_battery(self) -> bool:
+        """Indicate whether the cartridge has a battery keeping its memory powered."""
+        ...
+
+    @property
+    def prg_size(self) -> int:
+        """The size of the PRG-ROM in bytes."""
+        ...
+
+    @property
+    def chr_size(self) -> int:
+        """The size of the CHR memory in bytes."""
+        ...
+
+    @property
+    def has_chr_ram(self) -> bool:
+        """Indicate whether the cartridge uses CHR-RAM instead of CHR-ROM."""
+        ...
+
+    @property
+    def prg_ram_size(self) -> int:
+        """The size of the volatile PRG-RAM in bytes.
+
+        iNES headers do not store it, 8 KiB are then reported when the cartridge has no
+        battery.
+        """
+        ...
+
+    @property
+    def prg_nvram_size(self) -> int:
+        """The size of the battery backed PRG-RAM in bytes.
+
+        iNES headers do not store it, 8 KiB are then reported when the cartridge has a
+        battery.
+        """
+        ...
+
+    @property
+    def chr_ram_size(self) -> int:
+        """The size of the volatile CHR-RAM in bytes, as declared by the header.
+
+        iNES headers do not store it, 8 KiB are then reported when the cartridge has no
+        CHR-ROM.
+        """
+        ...
+
+    @property
+    def chr_nvram_size(self) -> int:
+        """The size of the battery backed CHR-RAM in bytes, always 0 for iNES headers."""
+        ...
+
+
+class StatePool:
+    """Fixed-size save state slots allocated from a single native arena.
+
+    Keeping many states alive (e.g. the nodes of a tree search) as separate NumPy arrays
+    fragments the heap and costs a Python object each. The pool allocates every slot at
+    once, either on the heap or mapped from a file when it should outgrow the physical
+    memory, and hands them out from a free list. Slots are plain integers, saved and
+    loaded with `NES.save_slot` / `NES.load_slot` or in batches with
+    `VecNES.save_slots` / `VecNES.load_slots`.
+    """
+
+    def __init__(self, slot_size: int, capacity: int, path: str = "") -> None:
+        """Allocate the arena of the pool, on the heap or mapped from a file.
+
+        Args:
+            slot_size (int): The size of a slot in bytes, the `state_size` of the
+                emulators.
+            capacity (int): The number of slots.
+            path (str): The path of the file backing the arena, created or truncated.
+                Empty to allocate the arena on the heap. Default is empty.
+
+        Raises:
+            ValueError: Error raised if the slot size or the capacity is zero.
+            RuntimeError: Error raised if the file cannot be mapped.
+            MemoryError: Error raised if the arena cannot be allocated.
+        """
+        ...
+
+    def allocate(self) -> int:
+        """Allocate a free slot.
+
+        Returns:
+            slot (int): The slot index.
+
+        Raises:
+            RuntimeError: Error raised if every slot is allocated.
+        """
+        ...
+
+    def allocate_batch(self, count: int) -> NDArray[np.uint64]:
+        """Allocate the given amount of free slots at once.
+
+        Args:
+            count (int): The number of slots to allocate.
+
+        Returns:
+            slots (NDArray[np.uint64]): The slot indices.
+
+        Raises:
+            RuntimeError: Error raised if there are not enough free slots, in which
+                case nothing is allocated.
+        """
+        ...
+
+    def release(self, slot: int) -> None:
+        """Release an allocated slot.
+
+        Args:
+            slot (int): The slot index.
+
+        Raises:
+            IndexError: Error raised if the slot is not allocated.
+        """
+        ...
+
+    def copy(self, source: int, destination: int) -> None:
+        """Copy the content of a slot to another one.
+
+        Args:
+            source (int): The index of the source slot.
+            destination (int): The index of the destination slot.
+
+        Raises:
+            IndexError: Error raised if one of the slots is not allocated.
+        """
+        ...
+
+    def is_saved(self, slot: int) -> bool:
+        """Indicate whether a slot holds a state, saved or copied since its allocation.
+
+        Args:
+            slot (int): The slot index.
+
+        Raises:
+            IndexError: Error raised if the slot is not allocated.
+        """
+        ...
+
+    @property
+    def slot_size(self) -> int:
+        """The size of a slot in bytes."""
+        ...
+
+    @property
+    def capacity(self) -> int:
+        """The number of slots."""
+        ...
+
+    @property
+    def free_count(self) -> int:
+        """The number of free slots."""
+        ...
+
+    @property
+    def is_mapped(self) -> bool:
+        """Indicate whether the arena is mapped from a file."""
+        ...
+
 
 class NES:
     """The base emulator class."""
@@ -31,6 +408,27 @@ class NES:
     by resetting the corresponding bit in the register.
     """
 
+    frame_buffers: int
+    """Number of frame buffers rotated through by `step_async`.
+
+    With a single frame buffer, every step overwrites the frame buffer returned by the
+    previous one. With two or more, `step_async` composes into the next frame buffer,
+    so the frame buffer returned by the previous step stays untouched while the next
+    one is emulated. The frame buffers are only released with the emulator. Default is
+    1.
+    """
+
+    idle_loop_skip: bool
+    """Whether or not the idle loops are fast-forwarded.
+
+    Once enabled, a loop that only reads RAM or the PPU status register before branching
+    back to itself is detected after its first iteration, and its following iterations
+    are skipped at once up to the next event that could break it (vertical blank, NMI,
+    mapper IRQ, frame IRQ, DMC fetch, ...). The emulation stays cycle-exact. Default is
+    False.
+    """
+
+    @overload
     def __init__(self, path_rom: str) -> None:
         """Initialize the NES emulator.
 
@@ -45,6 +443,17 @@ class NES:
         """
         ...
 
+    @overload
+    def __init__(self, rom: ROM) -> None:
+        """Initialize the NES emulator from an already loaded ROM.
+
+        The ROM data is shared with every other emulator created from the same `ROM`.
+
+        Args:
+            rom (ROM): The loaded ROM.
+        """
+        ...
+
     def __setitem__(self, address: int, value: int) -> None:
         """Write a value to the emulator's memory at the specified address.
 
@@ -108,7 +517,28 @@ class NES:
         """
         ...
 
-    def step(self, frames: int = 1) -> NDArray[np.uint8]:
+    def copy(self) -> "NES":
+        """Create an independent copy of the emulator, sharing its ROM.
+
+        The ROM is not parsed again and the power-up sequence is skipped: the state of
+        the emulator is copied directly, without going through a save state, which is
+        several times faster than creating a new emulator and loading a state into it.
+        The controller, the crashed flag, the frame buffer, the frame stack, the watch
+        list and the done conditions are copied as well, the profiling counters and the
+        snapshot base are not. `copy.copy` is supported too.
+
+        Returns:
+            nes (NES): The new emulator. Copies of a subclass (such as `WindowedNES`)
+                are plain headless `NES` instances.
+        """
+        ...
+
+    def __copy__(self) -> "NES":
+        ...
+
+    def step(
+        self, frames: int = 1, render: RenderPolicy = RenderPolicy.ALL
+    ) -> NDArray[np.uint8]:
         """Run the emulator for the specified number of frames.
 
         This method advances the emulator's state by the specified number of frames. By
@@ -116,16 +546,155 @@ class NES:
 
         Args:
             frames (int): The number of frames to run the emulator for. Default is 1.
+            render (RenderPolicy): The frames of the step to render. Skipping the
+                rendering of frames that are not used (e.g. with frame skipping) is
+                faster and does not affect the emulation. Default is
+                `RenderPolicy.ALL`.
 
         Returns:
             framebuffer (NDArray[np.uint8]): A NumPy array containing the frame buffer
-                in RGB format. The array has a shape of (240, 256, 3) and provides a
-                read-only view of the framebuffer. If modifications are needed, a copy
+                in the format selected by `frame_format`. The array has a shape of
+                (240, 256, 3) in RGB format, (240, 256) in indexed format, and provides
+                a read-only view of the framebuffer. If modifications are needed, a copy
                 of the array should be made.
         """
         ...
 
-    def save(self) -> NDArray[np.uint8]:
+    def step_async(
+        self, frames: int = 1, render: RenderPolicy = RenderPolicy.ALL
+    ) -> None:
+        """Start running the emulator for the specified number of frames, in the
+        background.
+
+        The step runs on a worker thread while Python keeps going, e.g. running a model
+        on the frame of the previous step, and `wait` returns its frame buffer. Unless
+        nothing is rendered, the step composes into the next of the `frame_buffers`
+        rotating frame buffers, without any copy. The controller state is read right
+        away. Every other method waits for the pending step before touching the
+        emulator, only `wait` and the frame buffers of the previous steps overlap
+        with it. The worker thread is started once and reused by the following steps.
+
+        Args:
+            frames (int): The number of frames to run the emulator for. Default is 1.
+            render (RenderPolicy): The frames of the step to render. Default is
+                `RenderPolicy.ALL`.
+        """
+        ...
+
+    def wait(self) -> NDArray[np.uint8]:
+        """Wait for the step started by `step_async`, releasing the GIL meanwhile.
+
+        Returns:
+            framebuffer (NDArray[np.uint8]): A read-only view of the frame buffer
+                written by the step, in the format selected by `frame_format`. The view
+                stays valid until `frame_buffers - 1` more steps have been started.
+        """
+        ...
+
+    def step_until(
+        self,
+        frames: int = 1,
+        render: RenderPolicy = RenderPolicy.ALL,
+        max_instructions: int = 0,
+        max_cycles: int = 0,
+        max_seconds: float = 0.0,
+        breakpoints: NDArray[np.uint16] = ...,
+        stop_on_watch_change: bool = False,
+    ) -> StepResult:
+        """Run the emulator until the end of its frames or an early stop condition.
+
+        The stop conditions are checked between two instructions, so the step stops
+        on an instruction boundary, possibly in the middle of a frame. The frame buffer
+        then holds a partially rendered frame. The frame stack is not updated.
+
+        Args:
+            frames (int): The maximum number of frames to run the emulator for.
+                Default is 1.
+            render (RenderPolicy): The frames of the step to render. Default is
+                `RenderPolicy.ALL`.
+            max_instructions (int): The maximum number of CPU instructions, 0 to
+                disable the limit. Default is 0.
+            max_cycles (int): The maximum number of CPU cycles, 0 to disable the
+                limit. The step ends on the first instruction boundary past the limit.
+                Default is 0.
+            max_seconds (float): The maximum wall-clock duration of the step in
+                seconds, 0 to disable the limit. Default is 0.
+            breakpoints (NDArray[np.uint16]): The program counter values stopping the
+                step before their instruction runs, with a shape of (K,). Default is
+                no breakpoint.
+            stop_on_watch_change (bool): Whether or not a write changing the value of
+                a byte of the watch list stops the step. Default is False.
+
+        Returns:
+            result (StepResult): The reason for which the step ended, and the number of
+                frames, instructions and cycles it ran.
+        """
+        ...
+
+    def run_tape(
+        self,
+        controllers: NDArray[np.uint16],
+        frames_per_action: int = 1,
+        capture_every: int = 0,
+        capture_frames: bool = False,
+        capture_states: bool = False,
+        capture_watch: bool = True,
+    ) -> Dict[str, Union[int, NDArray[np.uint8]]]:
+        """Run the emulator through a whole tape of controller states in a single call.
+
+        Each action of the tape is held for `frames_per_action` frames. The tape stops
+        early if the CPU crashes or if a done condition is met. Only the captured frames
+        are rendered (the last frame of every action when only the end of a tape with
+        done conditions is captured), and the frame stack is not updated. A tape
+        ending on a crash captures the last frame rendered before it.
+
+        Args:
+            controllers (NDArray[np.uint16]): The controller state of each action, with
+                a shape of (T,).
+            frames_per_action (int): The number of frames each action is held for.
+                Default is 1.
+            capture_every (int): The number of actions between two captures. By
+                default, only the end of the tape is captured.
+            capture_frames (bool): Whether or not the frame buffers are captured, in
+                the format selected by `frame_format`. Default is False.
+            capture_states (bool): Whether or not the save states are captured. Default
+                is False.
+            capture_watch (bool): Whether or not the values of the watch list are
+                captured. Default is True.
+
+        Returns:
+            result (Dict[str, Union[int, NDArray[np.uint8]]]): A dictionary holding the
+                number of actions run (`length`), and the requested captures with a
+                leading dimension of C = T // capture_every (or 1): `frames`, `states`
+                and `watch_values`. The captures past an early stop are left zeroed.
+
+        Raises:
+            ValueError: Error raised if the tape is empty.
+        """
+        ...
+
+    def convert_frame(
+        self, format: PixelFormat = PixelFormat.RGB24, downsample: int = 1
+    ) -> NDArray[np.uint8]:
+        """Convert the indexed frame buffer into the given pixel format.
+
+        Args:
+            format (PixelFormat): The output pixel format. Default is
+                `PixelFormat.RGB24`.
+            downsample (int): The downsampling factor, each output pixel being the
+                mean of a square block of pixels. Only luma frames can be downsampled,
+                by a factor of 2 or 4. Default is 1.
+
+        Returns:
+            frame (NDArray[np.uint8]): A new NumPy array containing the converted frame.
+
+        Raises:
+            RuntimeError: Error raised if `frame_format` is not `FrameFormat.INDEXED`.
+            ValueError: Error raised if the downsampling factor is invalid.
+        """
+        ...
+
+    def save(self, compress: bool = False) -> NDArray[np.uint8]:
         """Dump the current emulator state into a save state.
 
         This method creates a snapshot of the emulator's current state, which can be
@@ -133,6 +702,14 @@ class NES:
         mapper used by the currently running game. This save state can be restored at
         any time without corrupting the NES memory by using the `load` method.
 
+        Save states are portable: they start with a header identifying the format
+        version and the ROM, followed by the state of the console stored in
+        little-endian.
+
+        Args:
+            compress (bool): If set to True, the state is compressed using the LZ4 block
+                format, which makes it smaller to store or to send. Default is False.
+
         Returns:
             buffer (NDArray[np.uint8]): A NumPy array containing the dump of the
                 emulator's state.
@@ -142,23 +719,648 @@ class NES:
     def load(self, buffer: NDArray[np.uint8]) -> None:
         """Restore the emulator state from a save state.
 
-        This method restores a save state generated using the `save` method. When
-        restoring a save state, you must ensure that the emulator was instantiated using
-        the exact same ROM as the one used to generate the state.
+        This method restores a save state generated using the `save` method, compressed
+        or not. The header of the save state is checked beforehand, a save state
+        generated from another ROM or by an incompatible version is rejected.
 
         Args:
             buffer (NDArray[np.uint8]): A NumPy array containing the dump of the
                 emulator's state to be restored.
+
+        Raises:
+            ValueError: Error raised if the buffer is not a valid save state for this
+                emulator.
+            RuntimeError: Error raised if the compressed data is corrupted.
         """
         ...
 
-    @property
-    def has_crashed(self) -> int:
-        """Indicate whether the CPU has crashed due to encountering an invalid op-code.
+    def save_into(self, buffer: NDArray[np.uint8]) -> None:
+        """Dump the current emulator state into a preallocated buffer.
 
-        This method returns a flag that signals if the emulator has crashed. When the
-        emulator is in a crashed state, subsequent calls to the `step` method will have
-        no effect. To resume normal operation, the emulator must be reset or a valid
-        save state must be loaded, which will clear this crash flag.
-        """
+        Unlike `save`, nothing is allocated: the state is written in place into the
+        given buffer.
+
+        Args:
+            buffer (NDArray[np.uint8]): A writable contiguous buffer of bytes (e.g. a
+                NumPy array of `uint8` or a `bytearray`) of `state_size` bytes.
+
+        Raises:
+            ValueError: Error raised if the buffer does not have the expected size.
+        """
+        ...
+
+    def load_from(self, buffer: NDArray[np.uint8]) -> None:
+        """Restore the emulator state from a buffer, without copying it.
+
+        Args:
+            buffer (NDArray[np.uint8]): A contiguous buffer of bytes containing a save
+                state of the same ROM, compressed or not.
+
+        Raises:
+            ValueError: Error raised if the buffer is not a valid save state for this
+                emulator.
+            RuntimeError: Error raised if the compressed data is corrupted.
+        """
+        ...
+
+    @property
+    def state_size(self) -> int:
+        """The size of an uncompressed save state in bytes."""
+        ...
+
+    def save_slot(self, pool: StatePool, slot: int) -> None:
+        """Dump the current emulator state into a slot of a state pool.
+
+        Args:
+            pool (StatePool): The state pool, whose slot size is `state_size`.
+            slot (int): The index of an allocated slot.
+
+        Raises:
+            ValueError: Error raised if the slot size does not match the state size.
+            IndexError: Error raised if the slot is not allocated.
+        """
+        ...
+
+    def load_slot(self, pool: StatePool, slot: int) -> None:
+        """Restore the emulator state from a slot of a state pool.
+
+        Args:
+            pool (StatePool): The state pool, whose slot size is `state_size`.
+            slot (int): The index of an allocated slot holding a state of the same ROM.
+
+        Raises:
+            ValueError: Error raised if the slot size does not match the state size, or
+                if the slot does not hold a valid save state.
+            IndexError: Error raised if the slot is not allocated.
+        """
+        ...
+
+    def state_hash(self, ram_only: bool = False) -> int:
+        """Compute a 64-bit fingerprint of the emulator state.
+
+        The state is hashed in place using XXH64, without building a save state: the
+        hash is the same as the one of the uncompressed save state without its 24-byte
+        header, and costs a few microseconds. Equal states always have equal hashes,
+        which makes it suitable for deduplication and transposition tables.
+
+        Args:
+            ram_only (bool): Whether or not only the console RAM and the cartridge
+                PRG-RAM are hashed. Default is False.
+
+        Returns:
+            hash (int): The 64-bit hash.
+        """
+        ...
+
+    def set_snapshot_base(self) -> None:
+        """Use the current emulator state as the base of the incremental snapshots.
+
+        Incremental snapshots only store the 1 KiB memory blocks (console RAM, mapper
+        RAM and CHR-RAM) written since the base, along with the registers of the
+        console components. Changing the base invalidates the snapshots taken
+        previously.
+        """
+        ...
+
+    def save_snapshot(self) -> NDArray[np.uint8]:
+        """Dump the current emulator state into an incremental snapshot.
+
+        Saving and restoring a snapshot only costs as much as the number of memory
+        blocks written since the snapshot base, which makes them much cheaper than
+        `save` and `load` when branching often from nearby states.
+
+        Returns:
+            buffer (NDArray[np.uint8]): A NumPy array containing the snapshot.
+
+        Raises:
+            RuntimeError: Error raised if `set_snapshot_base` has not been called.
+        """
+        ...
+
+    def load_snapshot(self, buffer: NDArray[np.uint8]) -> None:
+        """Restore the emulator state from an incremental snapshot.
+
+        The snapshot must have been taken by the same emulator since the last call to
+        `set_snapshot_base`.
+
+        Args:
+            buffer (NDArray[np.uint8]): A NumPy array containing the snapshot.
+
+        Raises:
+            RuntimeError: Error raised if `set_snapshot_base` has not been called.
+            ValueError: Error raised if the buffer is not a valid snapshot, or if it
+                was taken by another emulator or from another snapshot base.
+        """
+        ...
+
+    @property
+    def has_crashed(self) -> int:
+        """Indicate whether the CPU has crashed due to encountering an invalid op-code.
+
+        This method returns a flag that signals if the emulator has crashed. When the
+        emulator is in a crashed state, subsequent calls to the `step` method will have
+        no effect. To resume normal operation, the emulator must be reset or a valid
+        save state must be loaded, which will clear this crash flag.
+        """
+        ...
+
+    @property
+    def counters(self) -> Counters:
+        """Copy of the profiling counters of the emulator.
+
+        The counters accumulate across steps, resets and save state loads, until
+        `reset_counters` is called. They stay zero unless `PROFILING_ENABLED` is True.
+        """
+        ...
+
+    def reset_counters(self) -> None:
+        """Reset the profiling counters to zero."""
+        ...
+
+    def set_watch_list(self, addresses: NDArray[np.uint16]) -> None:
+        """Set the addresses whose values are gathered at the end of every frame.
+
+        The values are read without any side effect, so that only the console RAM
+        `$0000 - $1FFF` and the mapper address space `$4020 - $FFFF` can be watched.
+
+        Args:
+            addresses (NDArray[np.uint16]): The watched addresses.
+
+        Raises:
+            ValueError: Error raised if an address targets the I/O registers.
+        """
+        ...
+
+    @property
+    def watch_values(self) -> NDArray[np.uint8]:
+        """Values of the watched addresses, as of the end of the last frame."""
+        ...
+
+    def add_done_condition(
+        self,
+        address: int,
+        value: int,
+        comparison: Comparison = Comparison.EQUAL,
+        mask: int = 0xFF,
+    ) -> None:
+        """Add a condition on a byte of the memory ending the steps early.
+
+        The condition is checked each time the CPU writes to its address, and at the
+        end of every frame. Once it is met, `step` stops at the end of the current
+        frame and `done` is set, e.g. with `add_done_condition(0x075A, 0)` on the lives
+        counter of a game.
+
+        Args:
+            address (int): The address of the byte, following the rules of the watch
+                list.
+            value (int): The value compared against.
+            comparison (Comparison): The comparison between the masked byte and the
+                value. Default is `Comparison.EQUAL`.
+            mask (int): The mask applied to the byte before the comparison. Default is
+                0xFF.
+
+        Raises:
+            ValueError: Error raised if the address targets the I/O registers.
+        """
+        ...
+
+    def clear_done_conditions(self) -> None:
+        """Remove every done condition."""
+        ...
+
+    @property
+    def done(self) -> bool:
+        """Indicate whether a done condition ended the last step."""
+        ...
+
+    def enable_frame_stack(
+        self,
+        depth: int = 4,
+        format: PixelFormat = PixelFormat.LUMA,
+        downsample: int = 1,
+        max_pool: bool = True,
+    ) -> None:
+        """Keep a ring of the last processed observations, updated by every step.
+
+        Each step writes a single observation: its last frame converted into the given
+        pixel format and, when `max_pool` is set, max-pooled with the frame before it
+        (the usual Atari preprocessing). Only the observed frames are rendered, unless
+        `step` is called with `RenderPolicy.ALL`. The ring is filled with the current
+        frame when enabled.
+
+        Args:
+            depth (int): The number of observations kept. Default is 4.
+            format (PixelFormat): The pixel format of the observations. Default is
+                `PixelFormat.LUMA`.
+            downsample (int): The downsampling factor, 2 or 4 for luma observations
+                only. Default is 1.
+            max_pool (bool): Whether or not the observations are max-pooled over the
+                last two frames of each step. Default is True.
+
+        Raises:
+            RuntimeError: Error raised if `frame_format` is not `FrameFormat.INDEXED`.
+            ValueError: Error raised if the depth or the downsampling factor is invalid.
+        """
+        ...
+
+    def disable_frame_stack(self) -> None:
+        """Stop updating the ring of observations, and release it."""
+        ...
+
+    def reset_frame_stack(self) -> None:
+        """Fill the ring of observations with the current frame.
+
+        This method should be called at the start of each episode, after a reset or a
+        load, so that the ring does not hold observations of the previous episode.
+        """
+        ...
+
+    @property
+    def frame_stack(self) -> NDArray[np.uint8]:
+        """Read-only view of the ring of observations, with a shape of (K, H, W[, C]).
+
+        The view is updated in place by every step, without any copy. The slots are
+        written in a rotating order, the oldest observation being at
+        `frame_stack_start`: `np.roll(nes.frame_stack, -nes.frame_stack_start, 0)`
+        orders them from the oldest to the most recent.
+        """
+        ...
+
+    @property
+    def frame_stack_start(self) -> int:
+        """Slot of the ring holding the oldest observation."""
+        ...
+
+    def enable_audio(self, sample_rate: int = 44100, depth: int = 4) -> None:
+        """Start synthesizing the audio of the following frames.
+
+        Each frame writes its mono samples, in the range [-1, 1], to a slot of a ring.
+        The synthesizer is not part of the save states nor of the copies. It is seeded
+        from the APU registers when enabled, and again whenever a state is loaded or
+        the emulator is reset, its timers and envelopes then restarting from the
+        register values. Emulators without audio do not pay anything for it.
+
+        Args:
+            sample_rate (int): The output sample rate in Hz. Default is 44100.
+            depth (int): The number of frames kept in the ring. Default is 4.
+
+        Raises:
+            ValueError: Error raised if the sample rate or the depth is zero.
+        """
+        ...
+
+    def disable_audio(self) -> None:
+        """Stop synthesizing audio, and release the ring of samples."""
+        ...
+
+    @property
+    def audio(self) -> NDArray[np.float32]:
+        """Read-only view of the ring of samples, with a shape of (K, C).
+
+        Each slot holds the samples of a single frame, only the first
+        `audio_lengths[k]` samples of the slot `k` being valid (around 735 at 44100 Hz).
+        The slots are written in a rotating order, the oldest frame being at
+        `audio_start`.
+
+        Raises:
+            RuntimeError: Error raised if the audio is not enabled.
+        """
+        ...
+
+    @property
+    def audio_lengths(self) -> NDArray[np.uint32]:
+        """Read-only view of the number of samples written to each slot of the ring.
+
+        Raises:
+            RuntimeError: Error raised if the audio is not enabled.
+        """
+        ...
+
+    @property
+    def audio_start(self) -> int:
+        """Slot of the ring holding the oldest frame of samples.
+
+        Raises:
+            RuntimeError: Error raised if the audio is not enabled.
+        """
+        ...
+
+    def read_audio(self, frames: int = 1) -> NDArray[np.float32]:
+        """Gather the samples of the last frames, in chronological order.
+
+        Args:
+            frames (int): The number of frames, at most the depth of the ring. Default
+                is 1.
+
+        Returns:
+            samples (NDArray[np.float32]): The concatenated samples.
+
+        Raises:
+            RuntimeError: Error raised if the audio is not enabled.
+            ValueError: Error raised if the number of frames is zero or greater than
+                the depth of the ring.
+        """
+        ...
+
+
+class VecNES:
+    """A batch of emulators running the same ROM, stepped in parallel."""
+
+    frame_format: FrameFormat
+    """Frame buffer written by every emulator and returned by `step`.
+
+    Default is `FrameFormat.RGB`.
+    """
+
+    idle_loop_skip: bool
+    """Whether or not the idle loops of every emulator are fast-forwarded.
+
+    See `NES.idle_loop_skip`. Default is False.
+    """
+
+    lockstep: bool
+    """Whether or not the identical emulators are only stepped once.
+
+    Once enabled, the emulators whose states have the same hash, and which are stepped
+    with the same controller state, are grouped before every step. Only the first
+    emulator of each group is stepped, its state and frame buffer are then copied to the
+    rest of the group. This is useful when many emulators of the batch go through the
+    same sequences (resets, menus, cutscenes ignoring the inputs, ...). With
+    `RenderPolicy.NONE`, the frame buffers are not copied. The lockstep is ignored while
+    the frame stack is enabled. Default is False.
+    """
+
+    @property
+    def stepped_count(self) -> int:
+        """Number of emulators actually stepped by the last step."""
+        ...
+
+    @overload
+    def __init__(self, path_rom: str, count: int, threads: int = 0) -> None:
+        """Initialize the batch of NES emulators.
+
+        Every emulator of the batch loads the same ROM file. The emulators are stepped
+        on a pool of native worker threads, releasing the GIL for the whole duration of
+        the emulation. The initialization can fail for the same reasons as `NES`.
+
+        Args:
+            path_rom (str): The path to the NES ROM file containing the game data.
+            count (int): The number of emulators in the batch.
+            threads (int): The number of threads used to step the emulators. By
+                default, the hardware concurrency is used.
+        """
+        ...
+
+    @overload
+    def __init__(self, rom: ROM, count: int, threads: int = 0) -> None:
+        """Initialize the batch of NES emulators from an already loaded ROM.
+
+        Args:
+            rom (ROM): The loaded ROM, shared by every emulator of the batch.
+            count (int): The number of emulators in the batch.
+            threads (int): The number of threads used to step the emulators. By
+                default, the hardware concurrency is used.
+        """
+        ...
+
+    def __len__(self) -> int:
+        """Get the number of emulators in the batch."""
+        ...
+
+    def reset(self) -> None:
+        """Send a reset signal to every emulator of the batch.
+
+        This also clears the crashed flags of the emulators.
+        """
+        ...
+
+    def step(
+        self,
+        controllers: NDArray[np.uint16],
+        frames: int = 1,
+        render: RenderPolicy = RenderPolicy.ALL,
+    ) -> tuple[NDArray[np.uint8], NDArray[np.bool_]]:
+        """Run every emulator of the batch for the specified number of frames.
+
+        Args:
+            controllers (NDArray[np.uint16]): The controller states of each emulator,
+                with a shape of (N,). Each value follows the same layout as
+                `NES.controller`.
+            frames (int): The number of frames to run the emulators for. Default is 1.
+            render (RenderPolicy): The frames of the step to render. With
+                `RenderPolicy.NONE`, the returned framebuffers are left untouched.
+                Default is `RenderPolicy.ALL`.
+
+        Returns:
+            framebuffers (NDArray[np.uint8]): A NumPy array containing the frame
+                buffers of every emulator in the format selected by `frame_format`. The
+                array has a shape of (N, 240, 256, 3) in RGB format, (N, 240, 256) in
+                indexed format, and provides a read-only view of a buffer reused by
+                subsequent calls. If modifications are needed, a copy of the array
+                should be made.
+            crashed (NDArray[np.bool_]): A read-only NumPy array of shape (N,)
+                indicating whether each emulator has crashed.
+        """
+        ...
+
+    def run_tape(
+        self,
+        controllers: NDArray[np.uint16],
+        frames_per_action: int = 1,
+        capture_every: int = 0,
+        capture_frames: bool = False,
+        capture_states: bool = False,
+        capture_watch: bool = True,
+    ) -> Dict[str, NDArray[np.generic]]:
+        """Run every emulator through its own tape of controller states, in parallel.
+
+        See `NES.run_tape`. The tapes have a shape of (N, T), `length` is an array of
+        shape (N,) and every capture has two leading dimensions (N, C).
+        """
+        ...
+
+    def save_into(self, buffer: NDArray[np.uint8]) -> None:
+        """Dump the state of every emulator into a preallocated buffer.
+
+        The states are written in place, in parallel, without allocating anything.
+
+        Args:
+            buffer (NDArray[np.uint8]): A writable contiguous NumPy array of `uint8`
+                with a shape of (N, `state_size`).
+
+        Raises:
+            ValueError: Error raised if the buffer does not have the expected shape.
+        """
+        ...
+
+    def load_from(self, buffer: NDArray[np.uint8]) -> None:
+        """Restore the state of every emulator from a buffer, without copying it.
+
+        This also clears the crashed flags of the emulators.
+
+        Args:
+            buffer (NDArray[np.uint8]): A contiguous NumPy array of `uint8` with a
+                shape of (N, `state_size`).
+
+        Raises:
+            ValueError: Error raised if the buffer does not have the expected shape.
+        """
+        ...
+
+    @property
+    def state_size(self) -> int:
+        """The size of the save state of a single emulator in bytes."""
+        ...
+
+    def save_slots(self, pool: StatePool, slots: NDArray[np.uint64]) -> None:
+        """Dump the state of every emulator into its own slot of a state pool.
+
+        The states are written in parallel, without allocating anything.
+
+        Args:
+            pool (StatePool): The state pool, whose slot size is `state_size`.
+            slots (NDArray[np.uint64]): The distinct allocated slot of each emulator,
+                with a shape of (N,).
+
+        Raises:
+            ValueError: Error raised if the slot size does not match the state size, or
+                if the slots do not have the expected shape or are not distinct.
+            IndexError: Error raised if a slot is not allocated.
+        """
+        ...
+
+    def load_slots(self, pool: StatePool, slots: NDArray[np.uint64]) -> None:
+        """Restore the state of every emulator from a slot of a state pool.
+
+        The same slot can be loaded by several emulators. This also clears the crashed
+        flags of the emulators.
+
+        Args:
+            pool (StatePool): The state pool, whose slot size is `state_size`.
+            slots (NDArray[np.uint64]): The allocated slot of each emulator, with a
+                shape of (N,), each holding a state of the same ROM.
+
+        Raises:
+            ValueError: Error raised if the slot size does not match the state size, if
+                the slots do not have the expected shape or if a slot does not hold a
+                state.
+            IndexError: Error raised if a slot is not allocated.
+        """
+        ...
+
+    def state_hash(self, ram_only: bool = False) -> NDArray[np.uint64]:
+        """Compute a 64-bit fingerprint of the state of every emulator.
+
+        Args:
+            ram_only (bool): Whether or not only the console RAM and the cartridge
+                PRG-RAM are hashed. Default is False.
+
+        Returns:
+            hashes (NDArray[np.uint64]): The hash of each emulator, see
+                `NES.state_hash`.
+        """
+        ...
+
+    def convert_frames(
+        self, format: PixelFormat = PixelFormat.RGB24, downsample: int = 1
+    ) -> NDArray[np.uint8]:
+        """Convert the indexed frame buffer of every emulator into the given format.
+
+        The conversion is run in parallel on the worker threads of the batch.
+
+        Args:
+            format (PixelFormat): The output pixel format. Default is
+                `PixelFormat.RGB24`.
+            downsample (int): The downsampling factor, only luma frames can be
+                downsampled, by a factor of 2 or 4. Default is 1.
+
+        Returns:
+            frames (NDArray[np.uint8]): A new NumPy array of shape (N, H, W) or
+                (N, H, W, C) containing the converted frames.
+
+        Raises:
+            RuntimeError: Error raised if `frame_format` is not `FrameFormat.INDEXED`.
+            ValueError: Error raised if the downsampling factor is invalid.
+        """
+        ...
+
+    @property
+    def has_crashed(self) -> NDArray[np.bool_]:
+        """Indicate whether each CPU has crashed due to an invalid op-code.
+
+        Once an emulator has crashed, subsequent calls to the `step` method have no
+        effect on it. Resetting the batch clears every flag.
+        """
+        ...
+
+    def set_watch_list(self, addresses: NDArray[np.uint16]) -> None:
+        """Set the addresses gathered at the end of every frame, for every emulator.
+
+        Args:
+            addresses (NDArray[np.uint16]): The watched addresses, see
+                `NES.set_watch_list`.
+
+        Raises:
+            ValueError: Error raised if an address targets the I/O registers.
+        """
+        ...
+
+    @property
+    def watch_values(self) -> NDArray[np.uint8]:
+        """Values of the watched addresses, with a shape of (N, K)."""
+        ...
+
+    def add_done_condition(
+        self,
+        address: int,
+        value: int,
+        comparison: Comparison = Comparison.EQUAL,
+        mask: int = 0xFF,
+    ) -> None:
+        """Add a condition ending the steps of every emulator early.
+
+        Each emulator stops at the end of the frame meeting the condition, while the
+        others run the whole step. See `NES.add_done_condition`.
+        """
+        ...
+
+    def clear_done_conditions(self) -> None:
+        """Remove every done condition."""
+        ...
+
+    @property
+    def done(self) -> NDArray[np.bool_]:
+        """Indicate whether a done condition ended the last step of each emulator."""
+        ...
+
+    def enable_frame_stack(
+        self,
+        depth: int = 4,
+        format: PixelFormat = PixelFormat.LUMA,
+        downsample: int = 1,
+        max_pool: bool = True,
+    ) -> None:
+        """Keep a ring of the last processed observations of every emulator.
+
+        See `NES.enable_frame_stack`, every emulator writes to the same slot of the
+        ring on each step.
+        """
+        ...
+
+    def disable_frame_stack(self) -> None:
+        """Stop updating the ring of observations, and release it."""
+        ...
+
+    def reset_frame_stack(self) -> None:
+        """Fill the ring of observations of every emulator with its current frame."""
+        ...
+
+    @property
+    def frame_stack(self) -> NDArray[np.uint8]:
+        """Read-only view of the ring of observations, with a shape of (N, K, H, W[, C])."""
+        ...
+
+    @property
+    def frame_stack_start(self) -> int:
+        """Slot of the ring holding the oldest observation of every emulator."""
         ...
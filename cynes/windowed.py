@@ -19,7 +19,7 @@ from cynes import (
     NES_INPUT_START,
     NES_INPUT_UP,
 )
-from cynes.emulator import NES
+from cynes.emulator import NES, RenderPolicy
 
 
 class SDLContext:
@@ -248,7 +248,8 @@ class WindowedNES(NES):
                     self.close()
                     return
 
-        frame_buffer = super().step(frames=frames)
+        # Only the last frame of the step is displayed.
+        frame_buffer = super().step(frames=frames, render=RenderPolicy.LAST)
 
         self._context.render_frame(frame_buffer)
         self.controller = previous_state
@@ -3,16 +3,17 @@
 #include "ppu.hpp"
 #include "nes.hpp"
 
+#include <algorithm>
 #include <cstring>
 
-constexpr uint8_t LENGTH_COUNTER_TABLE[0x20] = {
+const uint8_t cynes::LENGTH_COUNTER_TABLE[0x20] = {
     0x0A, 0xFE, 0x14, 0x02, 0x28, 0x04, 0x50, 0x06,
     0xA0, 0x08, 0x3C, 0x0A, 0x0E, 0x0C, 0x1A, 0x0E,
     0x0C, 0x10, 0x18, 0x12, 0x30, 0x14, 0x60, 0x16,
     0xC0, 0x18, 0x48, 0x1A, 0x10, 0x1C, 0x20, 0x1E
 };
 
-constexpr uint16_t PERIOD_DMC_TABLE[0x10] = {
+const uint16_t cynes::PERIOD_DMC_TABLE[0x10] = {
     0x1AC, 0x17C, 0x154, 0x140, 0x11E, 0x0FE, 0x0E2, 0x0D6,
     0x0BE, 0x0A0, 0x08E, 0x080, 0x06A, 0x054, 0x048, 0x036
 };
@@ -20,11 +21,13 @@ constexpr uint16_t PERIOD_DMC_TABLE[0x10] = {
 
 cynes::APU::APU(NES& nes)
     : _nes{nes}
+    , _audio{nullptr}
     , _latch_cycle{false}
     , _delay_dma{0x00}
     , _address_dma{0x00}
     , _pending_dma{false}
     , _internal_open_bus{0x00}
+    , _registers{}
     , _frame_counter_clock{0x0000}
     , _delay_frame_reset{0x0000}
     , _channels_counters{}
@@ -37,6 +40,7 @@ cynes::APU::APU(NES& nes)
     , _delta_channel_sample_length{0x0000}
     , _delta_channel_period_counter{0x0000}
     , _delta_channel_period_load{0x0000}
+    , _delta_channel_sample_address{0xC000}
     , _delta_channel_bits_in_buffer{0x00}
     , _delta_channel_should_loop{false}
     , _delta_channel_enable_interrupt{false}
@@ -56,6 +60,8 @@ void cynes::APU::power() {
     _pending_dma = false;
     _internal_open_bus = 0x00;
     _frame_counter_clock = 0x0000;
+
+    std::memset(_registers, 0x00, 0x18);
     _delay_frame_reset = 0x0000;
 
     std::memset(_channels_counters, 0x00, 4);
@@ -69,6 +75,7 @@ void cynes::APU::power() {
     _delta_channel_sample_length = 0x0000;
     _delta_channel_period_counter = PERIOD_DMC_TABLE[0];
     _delta_channel_period_load = PERIOD_DMC_TABLE[0];
+    _delta_channel_sample_address = 0xC000;
     _delta_channel_bits_in_buffer = 0x08;
     _delta_channel_should_loop = false;
     _delta_channel_enable_interrupt = false;
@@ -155,6 +162,14 @@ void cynes::APU::tick(bool reading, bool prevent_load) {
 }
 
 void cynes::APU::write(uint8_t address, uint8_t value) {
+    if (address < 0x18) {
+        _registers[address] = value;
+    }
+
+    if (_audio) {
+        _audio->write(_nes.get_dot(), address, value);
+    }
+
     switch (static_cast<Register>(address)) {
     case Register::PULSE_1_0: {
         _channel_halted[0x0] = value & 0x20;
@@ -244,6 +259,8 @@ void cynes::APU::write(uint8_t address, uint8_t value) {
         } else {
             if (_delta_channel_remaining_bytes == 0) {
                 _delta_channel_remaining_bytes = _delta_channel_sample_length;
+                _delta_channel_sample_address = 0xC000 | (_registers[0x12] << 6);
+
                 if (_delta_channel_sample_buffer_empty) {
                     load_delta_channel_byte(false);
                 }
@@ -301,6 +318,8 @@ void cynes::APU::update_counters() {
 }
 
 void cynes::APU::load_delta_channel_byte(bool reading) {
+    CYNES_PROFILE_TIME(_nes.counters.dmc_time);
+
     uint8_t delay = _delay_dma;
 
     if (delay == 0) {
@@ -311,21 +330,31 @@ void cynes::APU::load_delta_channel_byte(bool reading) {
         }
     }
 
+    CYNES_PROFILE_COUNT(_nes.counters.dmc_stalls, delay);
+    CYNES_PROFILE_COUNT(_nes.counters.cpu_cycles, delay);
+
     for (uint8_t i = 0; i < delay; i++) {
         tick(false, true);
 
-        _nes.ppu.tick();
-        _nes.ppu.tick();
-        _nes.ppu.tick();
+        _nes.clock_ppu(3);
         _nes.cpu.poll();
     }
 
+    if (_audio) {
+        _audio->load_sample(_nes.get_dot(), _nes.peek_cpu(_delta_channel_sample_address));
+    }
+
+    _delta_channel_sample_address = _delta_channel_sample_address == 0xFFFF
+        ? 0x8000
+        : _delta_channel_sample_address + 1;
+
     _delta_channel_sample_buffer_empty = false;
     _delta_channel_remaining_bytes--;
 
     if (_delta_channel_remaining_bytes == 0) {
         if (_delta_channel_should_loop) {
             _delta_channel_remaining_bytes = _delta_channel_sample_length;
+            _delta_channel_sample_address = 0xC000 | (_registers[0x12] << 6);
         } else if (_delta_channel_enable_interrupt) {
             set_delta_interrupt(true);
         }
@@ -342,7 +371,23 @@ void cynes::APU::perform_pending_dma() {
         return;
     }
 
+    CYNES_PROFILE_TIME(_nes.counters.oam_dma_time);
+    CYNES_PROFILE_COUNT(_nes.counters.oam_dma_stalls, _latch_cycle ? 513 : 514);
+
     _pending_dma = false;
+
+    // Transfers from the console RAM are done at once when nothing can happen during
+    // them, the rest of the console being moved forward by the whole transfer.
+    const unsigned int cycles = _latch_cycle ? 513 : 514;
+
+    if (_address_dma < 0x20 && get_event_distance() > cycles && _nes.transfer_oam(_address_dma, cycles)) {
+        skip(cycles);
+
+        _delay_dma = 0x0;
+
+        return;
+    }
+
     _delay_dma = 0x2;
 
     if (!_latch_cycle) {
@@ -373,6 +418,63 @@ void cynes::APU::perform_pending_dma() {
     }
 }
 
+unsigned int cynes::APU::get_event_distance() const {
+    const uint32_t clock = _frame_counter_clock;
+
+    uint32_t next;
+
+    if (clock < 14913) {
+        next = 14913;
+    } else {
+        next = _step_mode ? 37281 : 29828;
+    }
+
+    unsigned int distance = next > clock ? next - clock - 1 : 0;
+
+    if (_delay_frame_reset > 0) {
+        distance = std::min<unsigned int>(distance, _delay_frame_reset - 1);
+    }
+
+    // Expiring the DMC timer is harmless, unless a sample byte is fetched.
+    if (_delta_channel_remaining_bytes > 0) {
+        distance = std::min<unsigned int>(
+            distance,
+            _delta_channel_period_counter + (_delta_channel_bits_in_buffer - 1) * _delta_channel_period_load - 1
+        );
+    }
+
+    return distance;
+}
+
+void cynes::APU::skip(unsigned int cycles) {
+    if (cycles & 1) {
+        _latch_cycle = !_latch_cycle;
+    }
+
+    if (_delay_frame_reset > 0) {
+        _delay_frame_reset -= cycles;
+    }
+
+    _frame_counter_clock += cycles;
+
+    if (cycles < _delta_channel_period_counter) {
+        _delta_channel_period_counter -= cycles;
+
+        return;
+    }
+
+    const unsigned int remaining = cycles - _delta_channel_period_counter;
+    const unsigned int expirations = 1 + remaining / _delta_channel_period_load;
+
+    _delta_channel_period_counter = _delta_channel_period_load - remaining % _delta_channel_period_load;
+
+    if (expirations >= _delta_channel_bits_in_buffer) {
+        _delta_channel_sample_buffer_empty = true;
+    }
+
+    _delta_channel_bits_in_buffer = (_delta_channel_bits_in_buffer + 7 - expirations % 8) % 8 + 1;
+}
+
 void cynes::APU::set_frame_interrupt(bool interrupt) {
     _send_frame_interrupt = interrupt;
     _nes.cpu.set_frame_interrupt(interrupt);
@@ -382,3 +484,23 @@ void cynes::APU::set_delta_interrupt(bool interrupt) {
     _send_delta_channel_interrupt = interrupt;
     _nes.cpu.set_delta_interrupt(interrupt);
 }
+
+void cynes::APU::enable_audio(unsigned int sample_rate, size_t depth) {
+    _audio.reset(new AudioSynthesizer{sample_rate, depth, _nes.get_dot()});
+
+    synchronize_audio();
+}
+
+void cynes::APU::disable_audio() {
+    _audio.reset();
+}
+
+void cynes::APU::synchronize_audio() {
+    if (_audio) {
+        _audio->synchronize(_nes.get_dot(), _registers, _channels_counters, _step_mode, _frame_counter_clock);
+    }
+}
+
+void cynes::APU::end_audio_frame() {
+    _audio->end_frame(_nes.get_dot());
+}
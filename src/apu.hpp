@@ -1,17 +1,27 @@
 #ifndef __CYNES_APU__
 #define __CYNES_APU__
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 
+#include "audio.hpp"
 #include "utils.hpp"
 
 namespace cynes {
 // Forward declaration.
 class NES;
 
+/// Values loaded into the length counters, indexed by the upper bits of $4003.
+extern const uint8_t LENGTH_COUNTER_TABLE[0x20];
+
+/// Periods of the DMC timer in CPU cycles, indexed by the lower bits of $4010.
+extern const uint16_t PERIOD_DMC_TABLE[0x10];
+
 /// Audio Processing Unit (see https://www.nesdev.org/wiki/APU).
-/// This implementation does not produce any sound, it is only emulated for timing and
-/// interrupt purposes.
+/// The APU is emulated for timing and interrupt purposes. Sound is only produced when
+/// audio is enabled, by an `AudioSynthesizer` fed with the register writes, which costs
+/// nothing to the emulation otherwise.
 class APU {
 public:
     /// Initialize the APU.
@@ -45,9 +55,47 @@ public:
     /// @return The value stored at the given address.
     uint8_t read(uint8_t address);
 
+    /// Synthesize the audio of the frame that just ended, if audio is enabled.
+    inline void end_frame() {
+        if (_audio) {
+            end_audio_frame();
+        }
+    }
+
+    /// Start synthesizing the audio of the following frames.
+    /// @note The synthesizer is seeded from the current state of the APU, see
+    /// `APU::synchronize_audio`. Enabling audio again replaces the synthesizer.
+    /// @param sample_rate Output sample rate in Hz.
+    /// @param depth Number of frames kept in the ring of samples.
+    void enable_audio(unsigned int sample_rate, size_t depth);
+
+    /// Stop synthesizing audio, and release the synthesizer.
+    void disable_audio();
+
+    /// Seed the synthesizer, if any, from the current state of the APU.
+    /// @note Should be called whenever the state of the APU is replaced rather than
+    /// written through its registers (state loads, copies and resets).
+    void synchronize_audio();
+
+    /// Get the audio synthesizer, `nullptr` when audio is disabled.
+    inline const AudioSynthesizer* get_audio() const { return _audio.get(); }
+
+    /// Get the number of cycles the APU can be ticked without any event.
+    /// @note Events are the frame sequencer steps and the DMC sample fetches, the
+    /// interrupts being raised by them.
+    /// @return The number of CPU cycles.
+    unsigned int get_event_distance() const;
+
+    /// Move the APU forward at once, as if it had been ticked.
+    /// @note The number of cycles should not exceed `APU::get_event_distance`.
+    /// @param cycles Number of CPU cycles.
+    void skip(unsigned int cycles);
+
 private:
     NES& _nes;
 
+    std::unique_ptr<AudioSynthesizer> _audio;
+
 private:
     void update_counters();
     void load_delta_channel_byte(bool reading);
@@ -58,6 +106,8 @@ private:
     void set_frame_interrupt(bool interrupt);
     void set_delta_interrupt(bool interrupt);
 
+    void end_audio_frame();
+
 private:
     bool _latch_cycle;
 
@@ -68,6 +118,9 @@ private:
 
     uint8_t _internal_open_bus;
 
+    // Last values written to $4000-$4017, only used to seed the synthesizer.
+    uint8_t _registers[0x18];
+
 private:
     uint32_t _frame_counter_clock;
     uint32_t _delay_frame_reset;
@@ -87,6 +140,7 @@ private:
     uint16_t _delta_channel_sample_length;
     uint16_t _delta_channel_period_counter;
     uint16_t _delta_channel_period_load;
+    uint16_t _delta_channel_sample_address;
 
     uint8_t _delta_channel_bits_in_buffer;
 
@@ -121,6 +175,7 @@ public:
         cynes::dump<operation>(buffer, _delay_dma);
         cynes::dump<operation>(buffer, _address_dma);
         cynes::dump<operation>(buffer, _pending_dma);
+        cynes::dump<operation>(buffer, _registers);
 
         cynes::dump<operation>(buffer, _frame_counter_clock);
         cynes::dump<operation>(buffer, _delay_frame_reset);
@@ -135,6 +190,7 @@ public:
         cynes::dump<operation>(buffer, _delta_channel_sample_length);
         cynes::dump<operation>(buffer, _delta_channel_period_counter);
         cynes::dump<operation>(buffer, _delta_channel_period_load);
+        cynes::dump<operation>(buffer, _delta_channel_sample_address);
         cynes::dump<operation>(buffer, _delta_channel_bits_in_buffer);
         cynes::dump<operation>(buffer, _delta_channel_should_loop);
         cynes::dump<operation>(buffer, _delta_channel_enable_interrupt);
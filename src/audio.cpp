@@ -0,0 +1,692 @@
+#include "audio.hpp"
+#include "apu.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+
+namespace {
+constexpr double CPU_CLOCK_RATE = 1789773.0;
+constexpr unsigned int DOTS_PER_FRAME = 262 * 341;
+constexpr unsigned int CYCLES_PER_FRAME = 29781;
+
+// Frames end once the vertical blank starts.
+constexpr unsigned int FRAME_END_DOT = 241 * 341 + 1;
+
+constexpr size_t KERNEL_WIDTH = 16;
+constexpr size_t KERNEL_PHASES = 64;
+
+constexpr float PULSE_GAIN = 0.00752f;
+constexpr float TRIANGLE_GAIN = 0.00851f;
+constexpr float NOISE_GAIN = 0.00494f;
+constexpr float DELTA_GAIN = 0.00335f;
+
+constexpr double HIGH_PASS_FREQUENCY = 90.0;
+
+constexpr uint8_t DUTY_TABLE[0x4][0x8] = {
+    {0, 1, 0, 0, 0, 0, 0, 0},
+    {0, 1, 1, 0, 0, 0, 0, 0},
+    {0, 1, 1, 1, 1, 0, 0, 0},
+    {1, 0, 0, 1, 1, 1, 1, 1}
+};
+
+constexpr uint8_t TRIANGLE_SEQUENCE[0x20] = {
+    15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+};
+
+constexpr uint16_t NOISE_PERIOD_TABLE[0x10] = {
+    4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068
+};
+
+// Frame sequencer steps of the 4-step and 5-step modes, the last one resets the
+// sequencer without clocking anything.
+constexpr uint32_t SEQUENCER_STEPS[0x2][0x5] = {
+    {7457, 14913, 22371, 29829, 29830},
+    {7457, 14913, 22371, 37281, 37282}
+};
+
+// Band-limited impulses (Blackman-windowed sinc), for each fractional position of the
+// step. Once integrated, they make band-limited steps.
+using Kernel = std::array<std::array<float, KERNEL_WIDTH>, KERNEL_PHASES>;
+
+const Kernel& get_kernel() {
+    static const Kernel kernel = []() {
+        const double pi = std::acos(-1.0);
+        const double cutoff = 0.9;
+
+        Kernel result{};
+
+        for (size_t phase = 0; phase < KERNEL_PHASES; phase++) {
+            const double offset = static_cast<double>(phase) / KERNEL_PHASES;
+            double sum = 0.0;
+
+            std::array<double, KERNEL_WIDTH> taps{};
+
+            for (size_t k = 0; k < KERNEL_WIDTH; k++) {
+                double x = static_cast<double>(k) - (KERNEL_WIDTH / 2 - 1) - offset;
+                double sinc = x == 0.0 ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+                double window = 0.42
+                    + 0.5 * std::cos(2.0 * pi * x / KERNEL_WIDTH)
+                    + 0.08 * std::cos(4.0 * pi * x / KERNEL_WIDTH);
+
+                taps[k] = sinc * std::max(window, 0.0);
+                sum += taps[k];
+            }
+
+            for (size_t k = 0; k < KERNEL_WIDTH; k++) {
+                result[phase][k] = static_cast<float>(taps[k] / sum);
+            }
+        }
+
+        return result;
+    }();
+
+    return kernel;
+}
+}
+
+
+cynes::AudioSynthesizer::AudioSynthesizer(unsigned int sample_rate, size_t depth, unsigned int dot)
+    : _sample_rate{sample_rate}
+    , _depth{depth}
+    , _frame_capacity{static_cast<size_t>(std::ceil(2.0 * CYCLES_PER_FRAME * sample_rate / CPU_CLOCK_RATE))}
+    , _samples_per_cycle{sample_rate / CPU_CLOCK_RATE}
+    , _frame_dot{FRAME_END_DOT}
+    , _dot_remainder{0}
+    , _frame_cycle{0}
+    , _cycle{CYCLES_PER_FRAME}
+    , _samples_written{static_cast<uint64_t>(CYCLES_PER_FRAME * _samples_per_cycle)}
+    , _sequencer_clock{0}
+    , _sequencer_mode{false}
+    , _pulses{}
+    , _triangle{}
+    , _noise{}
+    , _delta{}
+    , _integrator{0.0f}
+    , _filter_input{0.0f}
+    , _filter_output{0.0f}
+    , _filter_factor{0.0f}
+    , _next{0}
+{
+    if (sample_rate == 0 || depth == 0) {
+        throw std::invalid_argument("The sample rate and the depth should be positive.");
+    }
+
+    const double time_constant = 1.0 / (2.0 * std::acos(-1.0) * HIGH_PASS_FREQUENCY);
+    _filter_factor = static_cast<float>(time_constant / (time_constant + 1.0 / sample_rate));
+
+    for (uint8_t k = 0; k < 0x2; k++) {
+        _pulses[k].timer = 2;
+        _pulses[k].negate_offset = k == 0 ? 1 : 0;
+    }
+
+    _triangle.timer = 1;
+
+    _noise.shifter = 0x0001;
+    _noise.period = NOISE_PERIOD_TABLE[0];
+    _noise.timer = NOISE_PERIOD_TABLE[0];
+
+    _delta.period = PERIOD_DMC_TABLE[0];
+    _delta.timer = PERIOD_DMC_TABLE[0];
+    _delta.bits_remaining = 8;
+    _delta.silence = true;
+
+    _events.reserve(0x100);
+
+    _deltas.reset(new float[_frame_capacity + KERNEL_WIDTH]);
+    std::memset(_deltas.get(), 0x00, (_frame_capacity + KERNEL_WIDTH) * sizeof(float));
+
+    _samples.reset(new float[depth * _frame_capacity]);
+    std::memset(_samples.get(), 0x00, depth * _frame_capacity * sizeof(float));
+
+    _lengths.reset(new uint32_t[depth]);
+    std::memset(_lengths.get(), 0x00, depth * sizeof(uint32_t));
+
+    rebase(dot);
+}
+
+void cynes::AudioSynthesizer::write(unsigned int dot, uint8_t address, uint8_t value) {
+    // The DMC sample address and length are handled by the APU, which fetches the bytes.
+    if (address > 0x17 || address == 0x12 || address == 0x13 || address == 0x14 || address == 0x16) {
+        return;
+    }
+
+    _events.push_back({advance(dot, false), EventType::WRITE, address, value});
+}
+
+void cynes::AudioSynthesizer::synchronize(
+    unsigned int dot,
+    const uint8_t* registers,
+    const uint8_t* lengths,
+    bool sequencer_mode,
+    uint32_t sequencer_clock
+) {
+    for (const Event& event : _events) {
+        run(event.cycle);
+        apply(event);
+    }
+
+    _events.clear();
+
+    rebase(dot);
+
+    // The status register comes first, the other writes then follow the enabled
+    // channels, and the length counters are overwritten by the ones of the APU.
+    apply({_cycle, EventType::WRITE, 0x15, registers[0x15]});
+
+    for (uint8_t address = 0x00; address < 0x12; address++) {
+        apply({_cycle, EventType::WRITE, address, registers[address]});
+    }
+
+    _pulses[0x0].length = lengths[0x0];
+    _pulses[0x1].length = lengths[0x1];
+    _triangle.length = lengths[0x2];
+    _noise.length = lengths[0x3];
+
+    _sequencer_mode = sequencer_mode;
+    _sequencer_clock = std::min(sequencer_clock, SEQUENCER_STEPS[_sequencer_mode][0x4] - 1);
+
+    update_pulse(_pulses[0x0], _cycle);
+    update_pulse(_pulses[0x1], _cycle);
+    update_triangle(_cycle);
+    update_noise(_cycle);
+    update_delta(_cycle);
+}
+
+void cynes::AudioSynthesizer::load_sample(unsigned int dot, uint8_t value) {
+    _events.push_back({advance(dot, false), EventType::SAMPLE, 0x00, value});
+}
+
+void cynes::AudioSynthesizer::end_frame(unsigned int dot) {
+    const uint64_t cycle = advance(dot, true);
+
+    for (const Event& event : _events) {
+        run(event.cycle);
+        apply(event);
+    }
+
+    _events.clear();
+
+    run(cycle);
+
+    const uint64_t target = static_cast<uint64_t>(cycle * _samples_per_cycle);
+    const size_t count = std::min<uint64_t>(target - _samples_written, _frame_capacity);
+
+    float* slot = _samples.get() + _next * _frame_capacity;
+
+    for (size_t k = 0; k < count; k++) {
+        _integrator += _deltas[k];
+        _filter_output = _filter_factor * (_filter_output + _integrator - _filter_input);
+        _filter_input = _integrator;
+
+        slot[k] = _filter_output;
+    }
+
+    const size_t buffer_size = _frame_capacity + KERNEL_WIDTH;
+
+    std::memmove(_deltas.get(), _deltas.get() + count, (buffer_size - count) * sizeof(float));
+    std::memset(_deltas.get() + buffer_size - count, 0x00, count * sizeof(float));
+
+    // Samples beyond the capacity of a slot are dropped, along with their steps.
+    _samples_written = target;
+    _lengths[_next] = static_cast<uint32_t>(count);
+    _next = (_next + 1) % _depth;
+}
+
+uint64_t cynes::AudioSynthesizer::advance(unsigned int dot, bool frame_end) {
+    dot %= DOTS_PER_FRAME;
+
+    // Timestamps are relative to the end of the previous frame. Frames end a few dots
+    // apart from each other, depending on the last instruction, the end of a frame
+    // being roughly a whole frame after the previous one.
+    unsigned int elapsed = (dot + DOTS_PER_FRAME - _frame_dot) % DOTS_PER_FRAME;
+
+    if (frame_end && elapsed < DOTS_PER_FRAME / 2) {
+        elapsed += DOTS_PER_FRAME;
+    }
+
+    const uint64_t cycle = _frame_cycle + (_dot_remainder + elapsed) / 3;
+
+    if (frame_end) {
+        _dot_remainder = (_dot_remainder + elapsed) % 3;
+        _frame_cycle = cycle;
+        _frame_dot = dot;
+    }
+
+    return cycle;
+}
+
+void cynes::AudioSynthesizer::rebase(unsigned int dot) {
+    // The current dot is mapped onto the current cycle, relative to the end of the
+    // previous frame. The timeline starts a frame late, so that it never goes negative.
+    const unsigned int elapsed = (dot % DOTS_PER_FRAME + DOTS_PER_FRAME - _frame_dot) % DOTS_PER_FRAME;
+
+    _frame_cycle = _cycle - elapsed / 3;
+    _dot_remainder = 0;
+}
+
+void cynes::AudioSynthesizer::run(uint64_t cycle) {
+    while (_cycle < cycle) {
+        const uint32_t* steps = SEQUENCER_STEPS[_sequencer_mode];
+
+        uint8_t step = 0;
+
+        while (steps[step] <= _sequencer_clock) {
+            step++;
+        }
+
+        const uint64_t next = _cycle + (steps[step] - _sequencer_clock);
+        const uint64_t end = std::min(next, cycle);
+
+        run_pulse(_pulses[0x0], _cycle, end);
+        run_pulse(_pulses[0x1], _cycle, end);
+        run_triangle(_cycle, end);
+        run_noise(_cycle, end);
+        run_delta(_cycle, end);
+
+        _sequencer_clock += static_cast<uint32_t>(end - _cycle);
+        _cycle = end;
+
+        if (end != next) {
+            break;
+        }
+
+        if (step == 0x4) {
+            _sequencer_clock = 0;
+            continue;
+        }
+
+        clock_quarter_frame();
+
+        if (step == 0x1 || step == 0x3) {
+            clock_half_frame();
+        }
+
+        update_pulse(_pulses[0x0], _cycle);
+        update_pulse(_pulses[0x1], _cycle);
+        update_triangle(_cycle);
+        update_noise(_cycle);
+    }
+}
+
+void cynes::AudioSynthesizer::apply(const Event& event) {
+    const uint8_t value = event.value;
+
+    if (event.type == EventType::SAMPLE) {
+        _delta.buffer = value;
+        _delta.buffer_full = true;
+        return;
+    }
+
+    switch (event.address) {
+    case 0x00: case 0x04: {
+        PulseChannel& pulse = _pulses[event.address >> 2];
+
+        pulse.duty = value >> 6;
+        pulse.halted = value & 0x20;
+        pulse.envelope.loop = value & 0x20;
+        pulse.envelope.constant = value & 0x10;
+        pulse.envelope.period = value & 0x0F;
+        break;
+    }
+
+    case 0x01: case 0x05: {
+        PulseChannel& pulse = _pulses[event.address >> 2];
+
+        pulse.sweep_enabled = value & 0x80;
+        pulse.sweep_period = (value >> 4) & 0x07;
+        pulse.sweep_negate = value & 0x08;
+        pulse.sweep_shift = value & 0x07;
+        pulse.sweep_reload = true;
+        break;
+    }
+
+    case 0x02: case 0x06: {
+        PulseChannel& pulse = _pulses[event.address >> 2];
+
+        pulse.period = (pulse.period & 0x0700) | value;
+        break;
+    }
+
+    case 0x03: case 0x07: {
+        PulseChannel& pulse = _pulses[event.address >> 2];
+
+        pulse.period = (pulse.period & 0x00FF) | ((value & 0x07) << 8);
+        pulse.phase = 0;
+        pulse.envelope.start = true;
+
+        if (pulse.enabled) {
+            pulse.length = LENGTH_COUNTER_TABLE[value >> 3];
+        }
+
+        break;
+    }
+
+    case 0x08: {
+        _triangle.halted = value & 0x80;
+        _triangle.linear_load = value & 0x7F;
+        break;
+    }
+
+    case 0x0A: {
+        _triangle.period = (_triangle.period & 0x0700) | value;
+        break;
+    }
+
+    case 0x0B: {
+        _triangle.period = (_triangle.period & 0x00FF) | ((value & 0x07) << 8);
+        _triangle.linear_reload = true;
+
+        if (_triangle.enabled) {
+            _triangle.length = LENGTH_COUNTER_TABLE[value >> 3];
+        }
+
+        break;
+    }
+
+    case 0x0C: {
+        _noise.halted = value & 0x20;
+        _noise.envelope.loop = value & 0x20;
+        _noise.envelope.constant = value & 0x10;
+        _noise.envelope.period = value & 0x0F;
+        break;
+    }
+
+    case 0x0E: {
+        _noise.mode = value & 0x80;
+        _noise.period = NOISE_PERIOD_TABLE[value & 0x0F];
+        break;
+    }
+
+    case 0x0F: {
+        _noise.envelope.start = true;
+
+        if (_noise.enabled) {
+            _noise.length = LENGTH_COUNTER_TABLE[value >> 3];
+        }
+
+        break;
+    }
+
+    case 0x10: {
+        _delta.period = PERIOD_DMC_TABLE[value & 0x0F];
+        break;
+    }
+
+    case 0x11: {
+        _delta.level = value & 0x7F;
+        break;
+    }
+
+    case 0x15: {
+        _pulses[0x0].enabled = value & 0x01;
+        _pulses[0x1].enabled = value & 0x02;
+        _triangle.enabled = value & 0x04;
+        _noise.enabled = value & 0x08;
+
+        for (PulseChannel& pulse : _pulses) {
+            if (!pulse.enabled) {
+                pulse.length = 0;
+            }
+        }
+
+        if (!_triangle.enabled) {
+            _triangle.length = 0;
+        }
+
+        if (!_noise.enabled) {
+            _noise.length = 0;
+        }
+
+        break;
+    }
+
+    case 0x17: {
+        _sequencer_mode = value & 0x80;
+        _sequencer_clock = 0;
+
+        if (_sequencer_mode) {
+            clock_quarter_frame();
+            clock_half_frame();
+        }
+
+        break;
+    }
+
+    default: break;
+    }
+
+    update_pulse(_pulses[0x0], event.cycle);
+    update_pulse(_pulses[0x1], event.cycle);
+    update_triangle(event.cycle);
+    update_noise(event.cycle);
+    update_delta(event.cycle);
+}
+
+void cynes::AudioSynthesizer::clock_quarter_frame() {
+    auto clock_envelope = [](Envelope& envelope) {
+        if (envelope.start) {
+            envelope.start = false;
+            envelope.decay = 15;
+            envelope.divider = envelope.period;
+        } else if (envelope.divider > 0) {
+            envelope.divider--;
+        } else {
+            envelope.divider = envelope.period;
+
+            if (envelope.decay > 0) {
+                envelope.decay--;
+            } else if (envelope.loop) {
+                envelope.decay = 15;
+            }
+        }
+    };
+
+    clock_envelope(_pulses[0x0].envelope);
+    clock_envelope(_pulses[0x1].envelope);
+    clock_envelope(_noise.envelope);
+
+    if (_triangle.linear_reload) {
+        _triangle.linear_counter = _triangle.linear_load;
+    } else if (_triangle.linear_counter > 0) {
+        _triangle.linear_counter--;
+    }
+
+    if (!_triangle.halted) {
+        _triangle.linear_reload = false;
+    }
+}
+
+void cynes::AudioSynthesizer::clock_half_frame() {
+    for (PulseChannel& pulse : _pulses) {
+        if (!pulse.halted && pulse.length > 0) {
+            pulse.length--;
+        }
+
+        int change = pulse.period >> pulse.sweep_shift;
+        int target = pulse.sweep_negate ? pulse.period - change - pulse.negate_offset : pulse.period + change;
+
+        bool muted = pulse.period < 8 || target > 0x7FF;
+
+        if (pulse.sweep_divider == 0 && pulse.sweep_enabled && pulse.sweep_shift > 0 && !muted) {
+            pulse.period = static_cast<uint16_t>(std::max(target, 0));
+        }
+
+        if (pulse.sweep_divider == 0 || pulse.sweep_reload) {
+            pulse.sweep_divider = pulse.sweep_period;
+            pulse.sweep_reload = false;
+        } else {
+            pulse.sweep_divider--;
+        }
+    }
+
+    if (!_triangle.halted && _triangle.length > 0) {
+        _triangle.length--;
+    }
+
+    if (!_noise.halted && _noise.length > 0) {
+        _noise.length--;
+    }
+}
+
+void cynes::AudioSynthesizer::run_pulse(PulseChannel& pulse, uint64_t start, uint64_t end) {
+    uint64_t remaining = end - start;
+
+    while (pulse.timer <= remaining) {
+        start += pulse.timer;
+        remaining -= pulse.timer;
+
+        pulse.timer = (pulse.period + 1) * 2;
+        pulse.phase = (pulse.phase + 1) & 0x7;
+
+        update_pulse(pulse, start);
+    }
+
+    pulse.timer -= static_cast<uint32_t>(remaining);
+}
+
+void cynes::AudioSynthesizer::run_triangle(uint64_t start, uint64_t end) {
+    // Ultrasonic periods are not stepped, to avoid aliasing the output.
+    if (_triangle.period < 2) {
+        return;
+    }
+
+    uint64_t remaining = end - start;
+
+    while (_triangle.timer <= remaining) {
+        start += _triangle.timer;
+        remaining -= _triangle.timer;
+
+        _triangle.timer = _triangle.period + 1;
+
+        if (_triangle.length > 0 && _triangle.linear_counter > 0) {
+            _triangle.phase = (_triangle.phase + 1) & 0x1F;
+            update_triangle(start);
+        }
+    }
+
+    _triangle.timer -= static_cast<uint32_t>(remaining);
+}
+
+void cynes::AudioSynthesizer::run_noise(uint64_t start, uint64_t end) {
+    uint64_t remaining = end - start;
+
+    while (_noise.timer <= remaining) {
+        start += _noise.timer;
+        remaining -= _noise.timer;
+
+        _noise.timer = _noise.period;
+
+        uint16_t feedback = (_noise.shifter ^ (_noise.shifter >> (_noise.mode ? 6 : 1))) & 0x1;
+        _noise.shifter = (_noise.shifter >> 1) | (feedback << 14);
+
+        update_noise(start);
+    }
+
+    _noise.timer -= static_cast<uint32_t>(remaining);
+}
+
+void cynes::AudioSynthesizer::run_delta(uint64_t start, uint64_t end) {
+    uint64_t remaining = end - start;
+
+    while (_delta.timer <= remaining) {
+        start += _delta.timer;
+        remaining -= _delta.timer;
+
+        _delta.timer = _delta.period;
+
+        if (!_delta.silence) {
+            if (_delta.shifter & 0x1) {
+                if (_delta.level <= 125) {
+                    _delta.level += 2;
+                }
+            } else if (_delta.level >= 2) {
+                _delta.level -= 2;
+            }
+        }
+
+        _delta.shifter >>= 1;
+
+        if (--_delta.bits_remaining == 0) {
+            _delta.bits_remaining = 8;
+            _delta.silence = !_delta.buffer_full;
+
+            if (_delta.buffer_full) {
+                _delta.shifter = _delta.buffer;
+                _delta.buffer_full = false;
+            }
+        }
+
+        update_delta(start);
+    }
+
+    _delta.timer -= static_cast<uint32_t>(remaining);
+}
+
+void cynes::AudioSynthesizer::update_pulse(PulseChannel& pulse, uint64_t cycle) {
+    int change = pulse.period >> pulse.sweep_shift;
+    int target = pulse.sweep_negate ? pulse.period - change - pulse.negate_offset : pulse.period + change;
+
+    int output = 0;
+
+    if (pulse.length > 0 && pulse.period >= 8 && target <= 0x7FF && DUTY_TABLE[pulse.duty][pulse.phase]) {
+        output = pulse.envelope.constant ? pulse.envelope.period : pulse.envelope.decay;
+    }
+
+    if (output != pulse.output) {
+        add_step(cycle, PULSE_GAIN * (output - pulse.output));
+        pulse.output = output;
+    }
+}
+
+void cynes::AudioSynthesizer::update_triangle(uint64_t cycle) {
+    int output = TRIANGLE_SEQUENCE[_triangle.phase];
+
+    if (output != _triangle.output) {
+        add_step(cycle, TRIANGLE_GAIN * (output - _triangle.output));
+        _triangle.output = output;
+    }
+}
+
+void cynes::AudioSynthesizer::update_noise(uint64_t cycle) {
+    int output = 0;
+
+    if (_noise.length > 0 && !(_noise.shifter & 0x1)) {
+        output = _noise.envelope.constant ? _noise.envelope.period : _noise.envelope.decay;
+    }
+
+    if (output != _noise.output) {
+        add_step(cycle, NOISE_GAIN * (output - _noise.output));
+        _noise.output = output;
+    }
+}
+
+void cynes::AudioSynthesizer::update_delta(uint64_t cycle) {
+    int output = _delta.level;
+
+    if (output != _delta.output) {
+        add_step(cycle, DELTA_GAIN * (output - _delta.output));
+        _delta.output = output;
+    }
+}
+
+void cynes::AudioSynthesizer::add_step(uint64_t cycle, float delta) {
+    double position = std::max(cycle * _samples_per_cycle - _samples_written, 0.0);
+    size_t index = static_cast<size_t>(position);
+
+    if (index >= _frame_capacity) {
+        return;
+    }
+
+    const std::array<float, KERNEL_WIDTH>& kernel = get_kernel()[
+        static_cast<size_t>((position - index) * KERNEL_PHASES)
+    ];
+
+    for (size_t k = 0; k < KERNEL_WIDTH; k++) {
+        _deltas[index + k] += delta * kernel[k];
+    }
+}
@@ -0,0 +1,218 @@
+#ifndef __CYNES_AUDIO__
+#define __CYNES_AUDIO__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cynes {
+/// Band-limited synthesizer of the APU channels (pulse, triangle, noise and DMC).
+/// @note The synthesizer is only fed by the APU when audio is enabled: register writes
+/// and DMC sample fetches are logged with their timestamp while the frame runs, and the
+/// whole frame is synthesized at once when it ends. The channels are mixed linearly
+/// (see https://www.nesdev.org/wiki/APU_Mixer), each output change being added as a
+/// band-limited step, then high-passed. Each frame writes its samples to a slot of a
+/// ring, which rotates at the end of every frame.
+/// The synthesizer is not part of the save states. Whenever the state of the APU is
+/// replaced, the channels are seeded again from the last values written to the APU
+/// registers, see `AudioSynthesizer::synchronize`.
+class AudioSynthesizer {
+public:
+    /// Initialize the synthesizer, every channel being silent.
+    /// @param sample_rate Output sample rate in Hz.
+    /// @param depth Number of frames kept in the ring.
+    /// @param dot Current PPU dot of the console, see `NES::get_dot`.
+    AudioSynthesizer(unsigned int sample_rate, size_t depth, unsigned int dot);
+
+    /// Default destructor.
+    ~AudioSynthesizer() = default;
+
+public:
+    /// Log a write to the APU registers.
+    /// @param dot Current PPU dot of the console.
+    /// @param address Register address within the APU memory address space.
+    /// @param value Written value.
+    void write(unsigned int dot, uint8_t address, uint8_t value);
+
+    /// Log a DMC sample byte fetch.
+    /// @param dot Current PPU dot of the console.
+    /// @param value Fetched sample byte.
+    void load_sample(unsigned int dot, uint8_t value);
+
+    /// Seed the channels from the state of the APU.
+    /// @note The logged writes are applied first, the timeline then continues from the
+    /// current dot of the console. The length counters and the frame sequencer are
+    /// taken from the APU, the other channel parameters are set from the last register
+    /// values. The timers, waveform phases, envelopes, sweep dividers, linear counter
+    /// and DMC output level are not emulated by the APU, they restart from these values.
+    /// @param dot Current PPU dot of the console.
+    /// @param registers Last values written to $4000-$4017.
+    /// @param lengths Length counters of the pulse, triangle and noise channels.
+    /// @param sequencer_mode Whether or not the frame sequencer is in its 5-step mode.
+    /// @param sequencer_clock Cycles elapsed since the start of the sequence.
+    void synchronize(
+        unsigned int dot,
+        const uint8_t* registers,
+        const uint8_t* lengths,
+        bool sequencer_mode,
+        uint32_t sequencer_clock
+    );
+
+    /// Synthesize the logged frame into the current slot of the ring, and rotate it.
+    /// @param dot Current PPU dot of the console.
+    void end_frame(unsigned int dot);
+
+    /// Get a pointer to the ring, with a shape of (depth, frame capacity).
+    inline const float* get_data() const { return _samples.get(); }
+
+    /// Get a pointer to the number of samples written to each slot of the ring.
+    inline const uint32_t* get_lengths() const { return _lengths.get(); }
+
+    /// Get the slot holding the oldest frame, the following slots (modulo the depth)
+    /// hold the more recent ones.
+    inline size_t get_start() const { return _next; }
+
+    /// Get the number of frames kept in the ring.
+    inline size_t get_depth() const { return _depth; }
+
+    /// Get the maximum number of samples of a single frame.
+    inline size_t get_frame_capacity() const { return _frame_capacity; }
+
+    /// Get the output sample rate in Hz.
+    inline unsigned int get_sample_rate() const { return _sample_rate; }
+
+private:
+    struct Envelope {
+        bool start;
+        bool loop;
+        bool constant;
+        uint8_t period;
+        uint8_t divider;
+        uint8_t decay;
+    };
+
+    struct PulseChannel {
+        Envelope envelope;
+        uint8_t duty;
+        uint8_t phase;
+        uint16_t period;
+        uint32_t timer;
+        uint8_t length;
+        bool halted;
+        bool enabled;
+        bool sweep_enabled;
+        bool sweep_negate;
+        bool sweep_reload;
+        uint8_t sweep_period;
+        uint8_t sweep_shift;
+        uint8_t sweep_divider;
+        uint8_t negate_offset;
+        int output;
+    };
+
+    struct TriangleChannel {
+        uint8_t phase;
+        uint16_t period;
+        uint32_t timer;
+        uint8_t length;
+        bool halted;
+        bool enabled;
+        bool linear_reload;
+        uint8_t linear_load;
+        uint8_t linear_counter;
+        int output;
+    };
+
+    struct NoiseChannel {
+        Envelope envelope;
+        bool mode;
+        uint16_t shifter;
+        uint16_t period;
+        uint32_t timer;
+        uint8_t length;
+        bool halted;
+        bool enabled;
+        int output;
+    };
+
+    struct DeltaChannel {
+        uint16_t period;
+        uint32_t timer;
+        uint8_t level;
+        uint8_t shifter;
+        uint8_t bits_remaining;
+        uint8_t buffer;
+        bool buffer_full;
+        bool silence;
+        int output;
+    };
+
+    enum class EventType : uint8_t {
+        WRITE, SAMPLE
+    };
+
+    struct Event {
+        uint64_t cycle;
+        EventType type;
+        uint8_t address;
+        uint8_t value;
+    };
+
+private:
+    const unsigned int _sample_rate;
+    const size_t _depth;
+    const size_t _frame_capacity;
+    const double _samples_per_cycle;
+
+    unsigned int _frame_dot;
+    unsigned int _dot_remainder;
+    uint64_t _frame_cycle;
+
+    uint64_t _cycle;
+    uint64_t _samples_written;
+
+    uint32_t _sequencer_clock;
+    bool _sequencer_mode;
+
+    PulseChannel _pulses[0x2];
+    TriangleChannel _triangle;
+    NoiseChannel _noise;
+    DeltaChannel _delta;
+
+    std::vector<Event> _events;
+
+    std::unique_ptr<float[]> _deltas;
+    float _integrator;
+    float _filter_input;
+    float _filter_output;
+    float _filter_factor;
+
+    std::unique_ptr<float[]> _samples;
+    std::unique_ptr<uint32_t[]> _lengths;
+    size_t _next;
+
+private:
+    uint64_t advance(unsigned int dot, bool frame_end);
+    void rebase(unsigned int dot);
+    void run(uint64_t cycle);
+    void apply(const Event& event);
+
+    void clock_quarter_frame();
+    void clock_half_frame();
+
+    void run_pulse(PulseChannel& pulse, uint64_t start, uint64_t end);
+    void run_triangle(uint64_t start, uint64_t end);
+    void run_noise(uint64_t start, uint64_t end);
+    void run_delta(uint64_t start, uint64_t end);
+
+    void update_pulse(PulseChannel& pulse, uint64_t cycle);
+    void update_triangle(uint64_t cycle);
+    void update_noise(uint64_t cycle);
+    void update_delta(uint64_t cycle);
+
+    void add_step(uint64_t cycle, float delta);
+};
+}
+
+#endif
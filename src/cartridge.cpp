@@ -0,0 +1,148 @@
+#include "cartridge.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+
+namespace {
+uint64_t hash_bytes(uint64_t hash, const uint8_t* data, size_t size) {
+    for (size_t k = 0; k < size; k++) {
+        hash = (hash ^ data[k]) * 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+/// Decode a NES 2.0 ROM size, either in banks or in exponent-multiplier notation.
+size_t get_rom_size(uint8_t lsb, uint8_t msb, size_t bank_size) {
+    if (msb != 0x0F) {
+        return (static_cast<size_t>(msb) << 8 | lsb) * bank_size;
+    }
+
+    if ((lsb >> 2) > 30) {
+        throw std::runtime_error("The size of the ROM is not supported.");
+    }
+
+    return (size_t{1} << (lsb >> 2)) * ((lsb & 0x03) * 2 + 1);
+}
+
+/// Decode a NES 2.0 RAM size, stored as a shift count.
+size_t get_ram_size(uint8_t shift) {
+    return shift == 0 ? 0 : size_t{64} << shift;
+}
+}
+
+
+std::shared_ptr<const cynes::Cartridge> cynes::Cartridge::load(
+    const std::filesystem::path& path_rom
+) {
+    std::ifstream stream{path_rom, std::ios::binary};
+
+    if (!stream.is_open()) {
+        throw std::runtime_error("The file cannot be read.");
+    }
+
+    std::vector<uint8_t> data{
+        std::istreambuf_iterator<char>{stream},
+        std::istreambuf_iterator<char>{}
+    };
+
+    stream.close();
+
+    return load(data.data(), data.size());
+}
+
+std::shared_ptr<const cynes::Cartridge> cynes::Cartridge::load(
+    const uint8_t* data,
+    size_t size
+) {
+    if (size < 0x10 || std::memcmp(data, "NES\x1A", 4) != 0) {
+        throw std::runtime_error("The specified file is not a NES ROM.");
+    }
+
+    uint8_t flag6 = data[6];
+    uint8_t flag7 = data[7];
+
+    std::shared_ptr<Cartridge> cartridge{new Cartridge{}};
+
+    cartridge->_mapper_index = (flag7 & 0xF0) | flag6 >> 4;
+    cartridge->_mirroring_mode = (flag6 & 0x01) == 1
+        ? MirroringMode::VERTICAL
+        : MirroringMode::HORIZONTAL;
+
+    cartridge->_nes2 = (flag7 & 0x0C) == 0x08;
+    cartridge->_battery = flag6 & 0x02;
+
+    size_t size_prg;
+    size_t size_chr;
+
+    if (cartridge->_nes2) {
+        cartridge->_mapper_index |= static_cast<uint16_t>(data[8] & 0x0F) << 8;
+        cartridge->_submapper_index = data[8] >> 4;
+
+        size_prg = get_rom_size(data[4], data[9] & 0x0F, 0x4000);
+        size_chr = get_rom_size(data[5], data[9] >> 4, 0x2000);
+
+        cartridge->_size_prg_ram = get_ram_size(data[10] & 0x0F);
+        cartridge->_size_prg_nvram = get_ram_size(data[10] >> 4);
+        cartridge->_size_chr_ram = get_ram_size(data[11] & 0x0F);
+        cartridge->_size_chr_nvram = get_ram_size(data[11] >> 4);
+    } else {
+        size_prg = static_cast<size_t>(data[4]) << 14;
+        size_chr = static_cast<size_t>(data[5]) << 13;
+
+        // The PRG-RAM size is not reliably stored by iNES headers, 8 KiB are assumed.
+        if (cartridge->_battery) {
+            cartridge->_size_prg_nvram = 0x2000;
+        } else {
+            cartridge->_size_prg_ram = 0x2000;
+        }
+
+        cartridge->_size_chr_ram = size_chr > 0 ? 0x00 : 0x2000;
+    }
+
+    const size_t MAX_SIZE = size_t{0xFFFF} << 10;
+
+    if ((size_prg | size_chr) & 0x3FF || size_prg > MAX_SIZE || size_chr > MAX_SIZE) {
+        throw std::runtime_error("The size of the ROM is not supported.");
+    }
+
+    cartridge->_size_prg = static_cast<uint16_t>(size_prg >> 10);
+    cartridge->_size_chr = static_cast<uint16_t>(size_chr >> 10);
+    cartridge->_read_only_chr = size_chr > 0;
+
+    size_t size_trainer = (flag6 & 0x04) ? 0x200 : 0x00;
+
+    if (size < 0x10 + size_trainer + size_prg + size_chr) {
+        throw std::runtime_error("The specified ROM is truncated.");
+    }
+
+    const uint8_t* cursor = data + 0x10;
+
+    if (size_trainer > 0) {
+        cartridge->_trainer.reset(new uint8_t[0x200]);
+        std::memcpy(cartridge->_trainer.get(), cursor, 0x200);
+        cursor += 0x200;
+    }
+
+    cartridge->_size_rom = size_prg + size_chr;
+    cartridge->_memory_rom.reset(new uint8_t[cartridge->_size_rom]);
+    std::memcpy(cartridge->_memory_rom.get(), cursor, cartridge->_size_rom);
+
+    if (!cartridge->_read_only_chr) {
+        cartridge->_size_chr = 8;
+    }
+
+    cartridge->_hash = 0xCBF29CE484222325ULL;
+
+    if (cartridge->_trainer) {
+        cartridge->_hash = hash_bytes(cartridge->_hash, cartridge->_trainer.get(), 0x200);
+    }
+
+    cartridge->_hash = hash_bytes(cartridge->_hash, cartridge->get_memory_rom(), cartridge->_size_rom);
+
+    return cartridge;
+}
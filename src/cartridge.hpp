@@ -0,0 +1,118 @@
+#ifndef __CYNES_CARTRIDGE__
+#define __CYNES_CARTRIDGE__
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace cynes {
+enum class MirroringMode : uint8_t {
+    NONE, ONE_SCREEN_LOW, ONE_SCREEN_HIGH, HORIZONTAL, VERTICAL
+};
+
+/// Immutable ROM image parsed from an iNES or NES 2.0 file.
+/// @note A cartridge is parsed once and can be shared by any number of emulators, each
+/// mapper only allocates its own RAM (CHR-RAM, PRG-RAM and nametables).
+class Cartridge {
+public:
+    /// Load and parse a ROM file.
+    /// @param path_rom Path to the NES ROM file.
+    /// @return A pointer to the shared ROM image.
+    static std::shared_ptr<const Cartridge> load(const std::filesystem::path& path_rom);
+
+    /// Parse a ROM from an in-memory iNES or NES 2.0 image.
+    /// @param data Pointer to the image.
+    /// @param size Size of the image in bytes.
+    /// @return A pointer to the shared ROM image.
+    static std::shared_ptr<const Cartridge> load(const uint8_t* data, size_t size);
+
+    /// Default destructor.
+    ~Cartridge() = default;
+
+public:
+    /// Get the iNES mapper id used by the ROM.
+    inline uint16_t get_mapper_index() const { return _mapper_index; }
+
+    /// Check whether or not the header uses the NES 2.0 format.
+    inline bool is_nes2() const { return _nes2; }
+
+    /// Get the NES 2.0 submapper id, always 0 for iNES headers.
+    inline uint8_t get_submapper_index() const { return _submapper_index; }
+
+    /// Check whether or not the cartridge has a battery keeping its memory powered.
+    inline bool has_battery() const { return _battery; }
+
+    /// Get the nametable mirroring mode hardwired on the cartridge.
+    inline MirroringMode get_mirroring_mode() const { return _mirroring_mode; }
+
+    /// Get the size of the PRG-ROM in 1 KiB banks.
+    inline uint16_t get_size_prg() const { return _size_prg; }
+
+    /// Get the size of the CHR memory in 1 KiB banks.
+    /// @note When the cartridge has no CHR-ROM, 8 KiB of CHR-RAM are reported.
+    inline uint16_t get_size_chr() const { return _size_chr; }
+
+    /// Check whether or not the CHR memory is a read only CHR-ROM.
+    inline bool is_read_only_chr() const { return _read_only_chr; }
+
+    /// Get the size of the volatile PRG-RAM in bytes.
+    /// @note iNES headers do not store it, 8 KiB are then reported when the cartridge has
+    /// no battery.
+    inline size_t get_size_prg_ram() const { return _size_prg_ram; }
+
+    /// Get the size of the battery backed PRG-RAM in bytes.
+    /// @note iNES headers do not store it, 8 KiB are then reported when the cartridge has
+    /// a battery.
+    inline size_t get_size_prg_nvram() const { return _size_prg_nvram; }
+
+    /// Get the size of the volatile CHR-RAM in bytes, as declared by the header.
+    /// @note iNES headers do not store it, 8 KiB are then reported when the cartridge has
+    /// no CHR-ROM.
+    inline size_t get_size_chr_ram() const { return _size_chr_ram; }
+
+    /// Get the size of the battery backed CHR-RAM in bytes, 0 for iNES headers.
+    inline size_t get_size_chr_nvram() const { return _size_chr_nvram; }
+
+    /// Get the size of the read only memory (PRG-ROM followed by the CHR-ROM, if any).
+    inline size_t get_size_rom() const { return _size_rom; }
+
+    /// Get a pointer to the read only memory (PRG-ROM followed by the CHR-ROM, if any).
+    inline const uint8_t* get_memory_rom() const { return _memory_rom.get(); }
+
+    /// Get a pointer to the 512 bytes trainer, or nullptr if the ROM has none.
+    inline const uint8_t* get_trainer() const { return _trainer.get(); }
+
+    /// Get the 64-bit FNV-1a hash of the ROM content (trainer, PRG-ROM and CHR-ROM).
+    /// @note The hash is stored in the save states to identify the ROM they belong to.
+    inline uint64_t get_hash() const { return _hash; }
+
+private:
+    Cartridge() = default;
+
+private:
+    uint16_t _mapper_index = 0x00;
+    uint8_t _submapper_index = 0x00;
+    MirroringMode _mirroring_mode = MirroringMode::NONE;
+
+    bool _nes2 = false;
+    bool _battery = false;
+
+    uint16_t _size_prg = 0x00;
+    uint16_t _size_chr = 0x00;
+    bool _read_only_chr = true;
+
+    size_t _size_prg_ram = 0x00;
+    size_t _size_prg_nvram = 0x00;
+    size_t _size_chr_ram = 0x00;
+    size_t _size_chr_nvram = 0x00;
+
+    size_t _size_rom = 0x00;
+    uint64_t _hash = 0x00;
+
+    std::unique_ptr<uint8_t[]> _memory_rom;
+    std::unique_ptr<uint8_t[]> _trainer;
+};
+}
+
+#endif
@@ -0,0 +1,215 @@
+#include "compression.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+
+// Minimal match length, and the end of block restrictions of the LZ4 block format.
+constexpr size_t MINIMUM_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MATCH_LIMIT = 12;
+
+constexpr size_t MAXIMUM_OFFSET = 0xFFFF;
+constexpr unsigned int HASH_BITS = 12;
+
+
+namespace {
+inline uint32_t read_sequence(const uint8_t* pointer) {
+    uint32_t value;
+    std::memcpy(&value, pointer, sizeof(uint32_t));
+    return value;
+}
+
+inline uint32_t hash_sequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+inline void write_length(uint8_t*& output, size_t length) {
+    while (length >= 0xFF) {
+        *output++ = 0xFF;
+        length -= 0xFF;
+    }
+
+    *output++ = static_cast<uint8_t>(length);
+}
+
+inline size_t read_length(const uint8_t* source, size_t size, size_t& cursor) {
+    size_t length = 0;
+    uint8_t value;
+
+    do {
+        if (cursor >= size) {
+            throw std::runtime_error("The compressed data is truncated.");
+        }
+
+        value = source[cursor++];
+        length += value;
+    } while (value == 0xFF);
+
+    return length;
+}
+
+void write_sequence(
+    uint8_t*& output,
+    const uint8_t* literals,
+    size_t literals_length,
+    size_t offset,
+    size_t match_length
+) {
+    uint8_t* token = output++;
+
+    *token = static_cast<uint8_t>((literals_length < 0xF ? literals_length : 0xF) << 4);
+
+    if (literals_length >= 0xF) {
+        write_length(output, literals_length - 0xF);
+    }
+
+    if (literals_length > 0) {
+        std::memcpy(output, literals, literals_length);
+        output += literals_length;
+    }
+
+    if (match_length == 0) {
+        return;
+    }
+
+    *output++ = static_cast<uint8_t>(offset);
+    *output++ = static_cast<uint8_t>(offset >> 8);
+
+    match_length -= MINIMUM_MATCH;
+
+    *token |= static_cast<uint8_t>(match_length < 0xF ? match_length : 0xF);
+
+    if (match_length >= 0xF) {
+        write_length(output, match_length - 0xF);
+    }
+}
+}
+
+
+size_t cynes::compression::compress_bound(size_t size) {
+    return size + size / 0xFF + 0x10;
+}
+
+size_t cynes::compression::compress(const uint8_t* source, size_t size, uint8_t* destination) {
+    uint8_t* output = destination;
+    size_t anchor = 0;
+
+    if (size > MATCH_LIMIT) {
+        uint32_t table[1 << HASH_BITS] = {};
+
+        const size_t limit = size - MATCH_LIMIT;
+        size_t cursor = 1;
+
+        while (cursor < limit) {
+            uint32_t sequence = read_sequence(source + cursor);
+            uint32_t& entry = table[hash_sequence(sequence)];
+
+            size_t reference = entry;
+            entry = static_cast<uint32_t>(cursor);
+
+            if (
+                reference >= cursor
+                || cursor - reference > MAXIMUM_OFFSET
+                || read_sequence(source + reference) != sequence
+            ) {
+                cursor++;
+                continue;
+            }
+
+            // Extend the match backwards over the pending literals, then forwards up to
+            // the last literals of the block.
+            while (cursor > anchor && reference > 0 && source[cursor - 1] == source[reference - 1]) {
+                cursor--;
+                reference--;
+            }
+
+            size_t length = MINIMUM_MATCH;
+            const size_t maximum_length = size - LAST_LITERALS - cursor;
+
+            while (length < maximum_length && source[cursor + length] == source[reference + length]) {
+                length++;
+            }
+
+            write_sequence(output, source + anchor, cursor - anchor, cursor - reference, length);
+
+            cursor += length;
+            anchor = cursor;
+        }
+    }
+
+    write_sequence(output, source + anchor, size - anchor, 0, 0);
+
+    return static_cast<size_t>(output - destination);
+}
+
+size_t cynes::compression::decompress(
+    const uint8_t* source,
+    size_t size,
+    uint8_t* destination,
+    size_t capacity
+) {
+    size_t cursor = 0;
+    size_t written = 0;
+
+    while (true) {
+        if (cursor >= size) {
+            throw std::runtime_error("The compressed data is truncated.");
+        }
+
+        uint8_t token = source[cursor++];
+        size_t literals_length = token >> 4;
+
+        if (literals_length == 0xF) {
+            literals_length += read_length(source, size, cursor);
+        }
+
+        if (literals_length > size - cursor || literals_length > capacity - written) {
+            throw std::runtime_error("The compressed data is corrupted.");
+        }
+
+        std::memcpy(destination + written, source + cursor, literals_length);
+
+        cursor += literals_length;
+        written += literals_length;
+
+        // The last sequence of the block only contains literals.
+        if (cursor == size) {
+            break;
+        }
+
+        if (size - cursor < 2) {
+            throw std::runtime_error("The compressed data is truncated.");
+        }
+
+        size_t offset = source[cursor] | static_cast<size_t>(source[cursor + 1]) << 8;
+        cursor += 2;
+
+        size_t match_length = token & 0xF;
+
+        if (match_length == 0xF) {
+            match_length += read_length(source, size, cursor);
+        }
+
+        match_length += MINIMUM_MATCH;
+
+        if (offset == 0 || offset > written || match_length > capacity - written) {
+            throw std::runtime_error("The compressed data is corrupted.");
+        }
+
+        uint8_t* output = destination + written;
+        const uint8_t* match = output - offset;
+
+        if (offset >= match_length) {
+            std::memcpy(output, match, match_length);
+        } else {
+            for (size_t k = 0; k < match_length; k++) {
+                output[k] = match[k];
+            }
+        }
+
+        written += match_length;
+    }
+
+    return written;
+}
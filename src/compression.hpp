@@ -0,0 +1,35 @@
+#ifndef __CYNES_COMPRESSION__
+#define __CYNES_COMPRESSION__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cynes {
+namespace compression {
+/// Get the maximum size of a compressed buffer.
+/// @param size Size of the uncompressed data.
+/// @return The worst case size of the compressed data.
+size_t compress_bound(size_t size);
+
+/// Compress a buffer using the LZ4 block format.
+/// @note The output can be decoded by any LZ4 block decoder. The compression favors
+/// speed over ratio, save states are mostly made of long runs of repeated bytes.
+/// @param source Uncompressed data.
+/// @param size Size of the uncompressed data.
+/// @param destination Output buffer, at least `compress_bound(size)` bytes large.
+/// @return The size of the compressed data.
+size_t compress(const uint8_t* source, size_t size, uint8_t* destination);
+
+/// Decompress a buffer encoded using the LZ4 block format.
+/// @note Every read and write is bounds checked, a corrupted input raises an error
+/// instead of overflowing the output.
+/// @param source Compressed data.
+/// @param size Size of the compressed data.
+/// @param destination Output buffer.
+/// @param capacity Size of the output buffer.
+/// @return The size of the uncompressed data.
+size_t decompress(const uint8_t* source, size_t size, uint8_t* destination, size_t capacity);
+}
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef __CYNES_COUNTERS__
+#define __CYNES_COUNTERS__
+
+#include <cstdint>
+
+#ifdef CYNES_PROFILE
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+namespace cynes {
+/// Whether or not the counters are updated (`CYNES_PROFILE` build option).
+#ifdef CYNES_PROFILE
+constexpr bool PROFILING_ENABLED = true;
+#else
+constexpr bool PROFILING_ENABLED = false;
+#endif
+
+/// Counters of the emulated events and of the host time spent in each subsystem.
+/// @note The counters are only updated when the core is built with `CYNES_PROFILE`,
+/// they otherwise stay zero and cost nothing. Times are expressed in timestamp counter
+/// ticks on x86 hosts, in nanoseconds otherwise.
+struct Counters {
+    /// Number of frames stepped.
+    uint64_t frames;
+
+    /// Number of CPU instructions executed.
+    uint64_t cpu_instructions;
+
+    /// Number of CPU cycles, including the DMA stalls.
+    uint64_t cpu_cycles;
+
+    /// Number of PPU dots.
+    uint64_t ppu_dots;
+
+    /// Number of CPU cycles stalled by the OAM DMA.
+    uint64_t oam_dma_stalls;
+
+    /// Number of CPU cycles stalled by the DMC sample fetches.
+    uint64_t dmc_stalls;
+
+    /// Number of CPU cycles skipped in idle loops.
+    uint64_t idle_cycles;
+
+    /// Number of CPU writes to the mapper registers and RAM.
+    uint64_t mapper_writes;
+
+    /// Number of non-maskable interrupts serviced by the CPU.
+    uint64_t non_maskable_interrupts;
+
+    /// Number of interrupt requests serviced by the CPU.
+    uint64_t interrupts;
+
+    /// Time spent stepping the emulator.
+    uint64_t step_time;
+
+    /// Time spent catching the PPU up (rendering, mapper clocks).
+    uint64_t ppu_time;
+
+    /// Time spent in the OAM DMA transfers.
+    uint64_t oam_dma_time;
+
+    /// Time spent in the DMC sample fetches.
+    uint64_t dmc_time;
+};
+
+#ifdef CYNES_PROFILE
+/// Read the host timestamp counter.
+inline uint64_t read_timestamp() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count());
+#endif
+}
+
+/// Accumulate the time elapsed in its scope into a counter.
+class ProfileTimer {
+public:
+    ProfileTimer(uint64_t& counter) : _counter{counter}, _start{read_timestamp()} { }
+    ~ProfileTimer() { _counter += read_timestamp() - _start; }
+
+private:
+    uint64_t& _counter;
+    const uint64_t _start;
+};
+
+#define CYNES_PROFILE_COUNT(counter, value) ((counter) += (value))
+#define CYNES_PROFILE_TIME(counter) cynes::ProfileTimer _profile_timer{counter}
+#else
+#define CYNES_PROFILE_COUNT(counter, value) ((void) 0)
+#define CYNES_PROFILE_TIME(counter) ((void) 0)
+#endif
+}
+
+#endif
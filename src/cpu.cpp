@@ -1,80 +1,93 @@
 #include "cpu.hpp"
 #include "nes.hpp"
 
+#include <algorithm>
 #include <cstring>
 
-using _addr_ptr = void (cynes::CPU::*)();;
+// Opcode table: each entry gives the opcode, its addressing mode and its operation. Both
+// dispatch strategies below are generated from this single list.
+#define CYNES_CPU_OPCODES(X) \
+    X(0x00, imp, brk) X(0x01, ixr, ora) X(0x02, acc, jam) X(0x03, ixr, slo) \
+    X(0x04, zpr, nop) X(0x05, zpr, ora) X(0x06, zpr, asl) X(0x07, zpr, slo) \
+    X(0x08, imp, php) X(0x09, imm, ora) X(0x0A, acc, aal) X(0x0B, imm, anc) \
+    X(0x0C, abr, nop) X(0x0D, abr, ora) X(0x0E, abr, asl) X(0x0F, abr, slo) \
+    X(0x10, rel, bpl) X(0x11, iyr, ora) X(0x12, acc, jam) X(0x13, iym, slo) \
+    X(0x14, zxr, nop) X(0x15, zxr, ora) X(0x16, zxr, asl) X(0x17, zxr, slo) \
+    X(0x18, imp, clc) X(0x19, ayr, ora) X(0x1A, imp, nop) X(0x1B, aym, slo) \
+    X(0x1C, axr, nop) X(0x1D, axr, ora) X(0x1E, axm, asl) X(0x1F, axm, slo) \
+    X(0x20, abw, jsr) X(0x21, ixr, and) X(0x22, acc, jam) X(0x23, ixr, rla) \
+    X(0x24, zpr, bit) X(0x25, zpr, and) X(0x26, zpr, rol) X(0x27, zpr, rla) \
+    X(0x28, imp, plp) X(0x29, imm, and) X(0x2A, acc, ral) X(0x2B, imm, anc) \
+    X(0x2C, abr, bit) X(0x2D, abr, and) X(0x2E, abr, rol) X(0x2F, abr, rla) \
+    X(0x30, rel, bmi) X(0x31, iyr, and) X(0x32, acc, jam) X(0x33, iym, rla) \
+    X(0x34, zxr, nop) X(0x35, zxr, and) X(0x36, zxr, rol) X(0x37, zxr, rla) \
+    X(0x38, imp, sec) X(0x39, ayr, and) X(0x3A, imp, nop) X(0x3B, aym, rla) \
+    X(0x3C, axr, nop) X(0x3D, axr, and) X(0x3E, axm, rol) X(0x3F, axm, rla) \
+    X(0x40, imp, rti) X(0x41, ixr, eor) X(0x42, acc, jam) X(0x43, ixr, sre) \
+    X(0x44, zpr, nop) X(0x45, zpr, eor) X(0x46, zpr, lsr) X(0x47, zpr, sre) \
+    X(0x48, imp, pha) X(0x49, imm, eor) X(0x4A, acc, lar) X(0x4B, imm, alr) \
+    X(0x4C, abw, jmp) X(0x4D, abr, eor) X(0x4E, abr, lsr) X(0x4F, abr, sre) \
+    X(0x50, rel, bvc) X(0x51, iyr, eor) X(0x52, acc, jam) X(0x53, iym, sre) \
+    X(0x54, zxr, nop) X(0x55, zxr, eor) X(0x56, zxr, lsr) X(0x57, zxr, sre) \
+    X(0x58, imp, cli) X(0x59, ayr, eor) X(0x5A, imp, nop) X(0x5B, aym, sre) \
+    X(0x5C, axr, nop) X(0x5D, axr, eor) X(0x5E, axm, lsr) X(0x5F, axm, sre) \
+    X(0x60, imp, rts) X(0x61, ixr, adc) X(0x62, acc, jam) X(0x63, ixr, rra) \
+    X(0x64, zpr, nop) X(0x65, zpr, adc) X(0x66, zpr, ror) X(0x67, zpr, rra) \
+    X(0x68, imp, pla) X(0x69, imm, adc) X(0x6A, acc, rar) X(0x6B, imm, arr) \
+    X(0x6C, ind, jmp) X(0x6D, abr, adc) X(0x6E, abr, ror) X(0x6F, abr, rra) \
+    X(0x70, rel, bvs) X(0x71, iyr, adc) X(0x72, acc, jam) X(0x73, iym, rra) \
+    X(0x74, zxr, nop) X(0x75, zxr, adc) X(0x76, zxr, ror) X(0x77, zxr, rra) \
+    X(0x78, imp, sei) X(0x79, ayr, adc) X(0x7A, imp, nop) X(0x7B, aym, rra) \
+    X(0x7C, axr, nop) X(0x7D, axr, adc) X(0x7E, axm, ror) X(0x7F, axm, rra) \
+    X(0x80, imm, nop) X(0x81, ixw, sta) X(0x82, imm, nop) X(0x83, ixw, sax) \
+    X(0x84, zpw, sty) X(0x85, zpw, sta) X(0x86, zpw, stx) X(0x87, zpw, sax) \
+    X(0x88, imp, dey) X(0x89, imm, nop) X(0x8A, imp, txa) X(0x8B, imm, ane) \
+    X(0x8C, abw, sty) X(0x8D, abw, sta) X(0x8E, abw, stx) X(0x8F, abw, sax) \
+    X(0x90, rel, bcc) X(0x91, iyw, sta) X(0x92, acc, jam) X(0x93, iyw, sha) \
+    X(0x94, zxw, sty) X(0x95, zxw, sta) X(0x96, zyw, stx) X(0x97, zyw, sax) \
+    X(0x98, imp, tya) X(0x99, ayw, sta) X(0x9A, imp, txs) X(0x9B, ayw, tas) \
+    X(0x9C, axw, shy) X(0x9D, axw, sta) X(0x9E, ayw, shx) X(0x9F, ayw, sha) \
+    X(0xA0, imm, ldy) X(0xA1, ixr, lda) X(0xA2, imm, ldx) X(0xA3, ixr, lax) \
+    X(0xA4, zpr, ldy) X(0xA5, zpr, lda) X(0xA6, zpr, ldx) X(0xA7, zpr, lax) \
+    X(0xA8, imp, tay) X(0xA9, imm, lda) X(0xAA, imp, tax) X(0xAB, imm, lxa) \
+    X(0xAC, abr, ldy) X(0xAD, abr, lda) X(0xAE, abr, ldx) X(0xAF, abr, lax) \
+    X(0xB0, rel, bcs) X(0xB1, iyr, lda) X(0xB2, acc, jam) X(0xB3, iyr, lax) \
+    X(0xB4, zxr, ldy) X(0xB5, zxr, lda) X(0xB6, zyr, ldx) X(0xB7, zyr, lax) \
+    X(0xB8, imp, clv) X(0xB9, ayr, lda) X(0xBA, imp, tsx) X(0xBB, ayr, las) \
+    X(0xBC, axr, ldy) X(0xBD, axr, lda) X(0xBE, ayr, ldx) X(0xBF, ayr, lax) \
+    X(0xC0, imm, cpy) X(0xC1, ixr, cmp) X(0xC2, imm, nop) X(0xC3, ixr, dcp) \
+    X(0xC4, zpr, cpy) X(0xC5, zpr, cmp) X(0xC6, zpr, dec) X(0xC7, zpr, dcp) \
+    X(0xC8, imp, iny) X(0xC9, imm, cmp) X(0xCA, imp, dex) X(0xCB, imm, sbx) \
+    X(0xCC, abr, cpy) X(0xCD, abr, cmp) X(0xCE, abr, dec) X(0xCF, abr, dcp) \
+    X(0xD0, rel, bne) X(0xD1, iyr, cmp) X(0xD2, acc, jam) X(0xD3, iym, dcp) \
+    X(0xD4, zxr, nop) X(0xD5, zxr, cmp) X(0xD6, zxr, dec) X(0xD7, zxr, dcp) \
+    X(0xD8, imp, cld) X(0xD9, ayr, cmp) X(0xDA, imp, nop) X(0xDB, aym, dcp) \
+    X(0xDC, axr, nop) X(0xDD, axr, cmp) X(0xDE, axm, dec) X(0xDF, axm, dcp) \
+    X(0xE0, imm, cpx) X(0xE1, ixr, sbc) X(0xE2, imm, nop) X(0xE3, ixr, isc) \
+    X(0xE4, zpr, cpx) X(0xE5, zpr, sbc) X(0xE6, zpr, inc) X(0xE7, zpr, isc) \
+    X(0xE8, imp, inx) X(0xE9, imm, sbc) X(0xEA, imp, nop) X(0xEB, imm, usb) \
+    X(0xEC, abr, cpx) X(0xED, abr, sbc) X(0xEE, abr, inc) X(0xEF, abr, isc) \
+    X(0xF0, rel, beq) X(0xF1, iyr, sbc) X(0xF2, acc, jam) X(0xF3, iym, isc) \
+    X(0xF4, zxr, nop) X(0xF5, zxr, sbc) X(0xF6, zxr, inc) X(0xF7, zxr, isc) \
+    X(0xF8, imp, sed) X(0xF9, ayr, sbc) X(0xFA, imp, nop) X(0xFB, aym, isc) \
+    X(0xFC, axr, nop) X(0xFD, axr, sbc) X(0xFE, axm, inc) X(0xFF, axm, isc)
+
+#define CYNES_CPU_ADDRESSING_MODE(opcode, mode, operation) &cynes::CPU::addr_##mode,
+#define CYNES_CPU_INSTRUCTION(opcode, mode, operation) &cynes::CPU::op_##operation,
+
+using _addr_ptr = void (cynes::CPU::*)();
 const _addr_ptr cynes::CPU::ADDRESSING_MODES[256] = {
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ixr, &cynes::CPU::addr_acc, &cynes::CPU::addr_ixr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_acc, &cynes::CPU::addr_imm, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr,
-    &cynes::CPU::addr_rel, &cynes::CPU::addr_iyr, &cynes::CPU::addr_acc, &cynes::CPU::addr_iym, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ayr, &cynes::CPU::addr_imp, &cynes::CPU::addr_aym, &cynes::CPU::addr_axr, &cynes::CPU::addr_axr, &cynes::CPU::addr_axm, &cynes::CPU::addr_axm,
-    &cynes::CPU::addr_abw, &cynes::CPU::addr_ixr, &cynes::CPU::addr_acc, &cynes::CPU::addr_ixr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_acc, &cynes::CPU::addr_imm, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr,
-    &cynes::CPU::addr_rel, &cynes::CPU::addr_iyr, &cynes::CPU::addr_acc, &cynes::CPU::addr_iym, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ayr, &cynes::CPU::addr_imp, &cynes::CPU::addr_aym, &cynes::CPU::addr_axr, &cynes::CPU::addr_axr, &cynes::CPU::addr_axm, &cynes::CPU::addr_axm,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ixr, &cynes::CPU::addr_acc, &cynes::CPU::addr_ixr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_acc, &cynes::CPU::addr_imm, &cynes::CPU::addr_abw, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr,
-    &cynes::CPU::addr_rel, &cynes::CPU::addr_iyr, &cynes::CPU::addr_acc, &cynes::CPU::addr_iym, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ayr, &cynes::CPU::addr_imp, &cynes::CPU::addr_aym, &cynes::CPU::addr_axr, &cynes::CPU::addr_axr, &cynes::CPU::addr_axm, &cynes::CPU::addr_axm,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ixr, &cynes::CPU::addr_acc, &cynes::CPU::addr_ixr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_acc, &cynes::CPU::addr_imm, &cynes::CPU::addr_ind, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr,
-    &cynes::CPU::addr_rel, &cynes::CPU::addr_iyr, &cynes::CPU::addr_acc, &cynes::CPU::addr_iym, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ayr, &cynes::CPU::addr_imp, &cynes::CPU::addr_aym, &cynes::CPU::addr_axr, &cynes::CPU::addr_axr, &cynes::CPU::addr_axm, &cynes::CPU::addr_axm,
-    &cynes::CPU::addr_imm, &cynes::CPU::addr_ixw, &cynes::CPU::addr_imm, &cynes::CPU::addr_ixw, &cynes::CPU::addr_zpw, &cynes::CPU::addr_zpw, &cynes::CPU::addr_zpw, &cynes::CPU::addr_zpw,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_abw, &cynes::CPU::addr_abw, &cynes::CPU::addr_abw, &cynes::CPU::addr_abw,
-    &cynes::CPU::addr_rel, &cynes::CPU::addr_iyw, &cynes::CPU::addr_acc, &cynes::CPU::addr_iyw, &cynes::CPU::addr_zxw, &cynes::CPU::addr_zxw, &cynes::CPU::addr_zyw, &cynes::CPU::addr_zyw,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ayw, &cynes::CPU::addr_imp, &cynes::CPU::addr_ayw, &cynes::CPU::addr_axw, &cynes::CPU::addr_axw, &cynes::CPU::addr_ayw, &cynes::CPU::addr_ayw,
-    &cynes::CPU::addr_imm, &cynes::CPU::addr_ixr, &cynes::CPU::addr_imm, &cynes::CPU::addr_ixr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr,
-    &cynes::CPU::addr_rel, &cynes::CPU::addr_iyr, &cynes::CPU::addr_acc, &cynes::CPU::addr_iyr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zyr, &cynes::CPU::addr_zyr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ayr, &cynes::CPU::addr_imp, &cynes::CPU::addr_ayr, &cynes::CPU::addr_axr, &cynes::CPU::addr_axr, &cynes::CPU::addr_ayr, &cynes::CPU::addr_ayr,
-    &cynes::CPU::addr_imm, &cynes::CPU::addr_ixr, &cynes::CPU::addr_imm, &cynes::CPU::addr_ixr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr,
-    &cynes::CPU::addr_rel, &cynes::CPU::addr_iyr, &cynes::CPU::addr_acc, &cynes::CPU::addr_iym, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ayr, &cynes::CPU::addr_imp, &cynes::CPU::addr_aym, &cynes::CPU::addr_axr, &cynes::CPU::addr_axr, &cynes::CPU::addr_axm, &cynes::CPU::addr_axm,
-    &cynes::CPU::addr_imm, &cynes::CPU::addr_ixr, &cynes::CPU::addr_imm, &cynes::CPU::addr_ixr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr, &cynes::CPU::addr_zpr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_imp, &cynes::CPU::addr_imm, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr, &cynes::CPU::addr_abr,
-    &cynes::CPU::addr_rel, &cynes::CPU::addr_iyr, &cynes::CPU::addr_acc, &cynes::CPU::addr_iym, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr, &cynes::CPU::addr_zxr,
-    &cynes::CPU::addr_imp, &cynes::CPU::addr_ayr, &cynes::CPU::addr_imp, &cynes::CPU::addr_aym, &cynes::CPU::addr_axr, &cynes::CPU::addr_axr, &cynes::CPU::addr_axm, &cynes::CPU::addr_axm
+    CYNES_CPU_OPCODES(CYNES_CPU_ADDRESSING_MODE)
 };
 
-using _op_ptr = void (cynes::CPU::*)();;
+using _op_ptr = void (cynes::CPU::*)();
 const _op_ptr cynes::CPU::INSTRUCTIONS[256] = {
-    &cynes::CPU::op_brk, &cynes::CPU::op_ora, &cynes::CPU::op_jam, &cynes::CPU::op_slo, &cynes::CPU::op_nop, &cynes::CPU::op_ora, &cynes:: CPU::op_asl, &cynes::CPU::op_slo,
-    &cynes::CPU::op_php, &cynes::CPU::op_ora, &cynes::CPU::op_aal, &cynes::CPU::op_anc, &cynes::CPU::op_nop, &cynes::CPU::op_ora, &cynes:: CPU::op_asl, &cynes::CPU::op_slo,
-    &cynes::CPU::op_bpl, &cynes::CPU::op_ora, &cynes::CPU::op_jam, &cynes::CPU::op_slo, &cynes::CPU::op_nop, &cynes::CPU::op_ora, &cynes:: CPU::op_asl, &cynes::CPU::op_slo,
-    &cynes::CPU::op_clc, &cynes::CPU::op_ora, &cynes::CPU::op_nop, &cynes::CPU::op_slo, &cynes::CPU::op_nop, &cynes::CPU::op_ora, &cynes:: CPU::op_asl, &cynes::CPU::op_slo,
-    &cynes::CPU::op_jsr, &cynes::CPU::op_and, &cynes::CPU::op_jam, &cynes::CPU::op_rla, &cynes::CPU::op_bit, &cynes::CPU::op_and, &cynes:: CPU::op_rol, &cynes::CPU::op_rla,
-    &cynes::CPU::op_plp, &cynes::CPU::op_and, &cynes::CPU::op_ral, &cynes::CPU::op_anc, &cynes::CPU::op_bit, &cynes::CPU::op_and, &cynes:: CPU::op_rol, &cynes::CPU::op_rla,
-    &cynes::CPU::op_bmi, &cynes::CPU::op_and, &cynes::CPU::op_jam, &cynes::CPU::op_rla, &cynes::CPU::op_nop, &cynes::CPU::op_and, &cynes:: CPU::op_rol, &cynes::CPU::op_rla,
-    &cynes::CPU::op_sec, &cynes::CPU::op_and, &cynes::CPU::op_nop, &cynes::CPU::op_rla, &cynes::CPU::op_nop, &cynes::CPU::op_and, &cynes:: CPU::op_rol, &cynes::CPU::op_rla,
-    &cynes::CPU::op_rti, &cynes::CPU::op_eor, &cynes::CPU::op_jam, &cynes::CPU::op_sre, &cynes::CPU::op_nop, &cynes::CPU::op_eor, &cynes:: CPU::op_lsr, &cynes::CPU::op_sre,
-    &cynes::CPU::op_pha, &cynes::CPU::op_eor, &cynes::CPU::op_lar, &cynes::CPU::op_alr, &cynes::CPU::op_jmp, &cynes::CPU::op_eor, &cynes:: CPU::op_lsr, &cynes::CPU::op_sre,
-    &cynes::CPU::op_bvc, &cynes::CPU::op_eor, &cynes::CPU::op_jam, &cynes::CPU::op_sre, &cynes::CPU::op_nop, &cynes::CPU::op_eor, &cynes:: CPU::op_lsr, &cynes::CPU::op_sre,
-    &cynes::CPU::op_cli, &cynes::CPU::op_eor, &cynes::CPU::op_nop, &cynes::CPU::op_sre, &cynes::CPU::op_nop, &cynes::CPU::op_eor, &cynes:: CPU::op_lsr, &cynes::CPU::op_sre,
-    &cynes::CPU::op_rts, &cynes::CPU::op_adc, &cynes::CPU::op_jam, &cynes::CPU::op_rra, &cynes::CPU::op_nop, &cynes::CPU::op_adc, &cynes:: CPU::op_ror, &cynes::CPU::op_rra,
-    &cynes::CPU::op_pla, &cynes::CPU::op_adc, &cynes::CPU::op_rar, &cynes::CPU::op_arr, &cynes::CPU::op_jmp, &cynes::CPU::op_adc, &cynes:: CPU::op_ror, &cynes::CPU::op_rra,
-    &cynes::CPU::op_bvs, &cynes::CPU::op_adc, &cynes::CPU::op_jam, &cynes::CPU::op_rra, &cynes::CPU::op_nop, &cynes::CPU::op_adc, &cynes:: CPU::op_ror, &cynes::CPU::op_rra,
-    &cynes::CPU::op_sei, &cynes::CPU::op_adc, &cynes::CPU::op_nop, &cynes::CPU::op_rra, &cynes::CPU::op_nop, &cynes::CPU::op_adc, &cynes:: CPU::op_ror, &cynes::CPU::op_rra,
-    &cynes::CPU::op_nop, &cynes::CPU::op_sta, &cynes::CPU::op_nop, &cynes::CPU::op_sax, &cynes::CPU::op_sty, &cynes::CPU::op_sta, &cynes:: CPU::op_stx, &cynes::CPU::op_sax,
-    &cynes::CPU::op_dey, &cynes::CPU::op_nop, &cynes::CPU::op_txa, &cynes::CPU::op_ane, &cynes::CPU::op_sty, &cynes::CPU::op_sta, &cynes:: CPU::op_stx, &cynes::CPU::op_sax,
-    &cynes::CPU::op_bcc, &cynes::CPU::op_sta, &cynes::CPU::op_jam, &cynes::CPU::op_sha, &cynes::CPU::op_sty, &cynes::CPU::op_sta, &cynes:: CPU::op_stx, &cynes::CPU::op_sax,
-    &cynes::CPU::op_tya, &cynes::CPU::op_sta, &cynes::CPU::op_txs, &cynes::CPU::op_tas, &cynes::CPU::op_shy, &cynes::CPU::op_sta, &cynes:: CPU::op_shx, &cynes::CPU::op_sha,
-    &cynes::CPU::op_ldy, &cynes::CPU::op_lda, &cynes::CPU::op_ldx, &cynes::CPU::op_lax, &cynes::CPU::op_ldy, &cynes::CPU::op_lda, &cynes:: CPU::op_ldx, &cynes::CPU::op_lax,
-    &cynes::CPU::op_tay, &cynes::CPU::op_lda, &cynes::CPU::op_tax, &cynes::CPU::op_lxa, &cynes::CPU::op_ldy, &cynes::CPU::op_lda, &cynes:: CPU::op_ldx, &cynes::CPU::op_lax,
-    &cynes::CPU::op_bcs, &cynes::CPU::op_lda, &cynes::CPU::op_jam, &cynes::CPU::op_lax, &cynes::CPU::op_ldy, &cynes::CPU::op_lda, &cynes:: CPU::op_ldx, &cynes::CPU::op_lax,
-    &cynes::CPU::op_clv, &cynes::CPU::op_lda, &cynes::CPU::op_tsx, &cynes::CPU::op_las, &cynes::CPU::op_ldy, &cynes::CPU::op_lda, &cynes:: CPU::op_ldx, &cynes::CPU::op_lax,
-    &cynes::CPU::op_cpy, &cynes::CPU::op_cmp, &cynes::CPU::op_nop, &cynes::CPU::op_dcp, &cynes::CPU::op_cpy, &cynes::CPU::op_cmp, &cynes:: CPU::op_dec, &cynes::CPU::op_dcp,
-    &cynes::CPU::op_iny, &cynes::CPU::op_cmp, &cynes::CPU::op_dex, &cynes::CPU::op_sbx, &cynes::CPU::op_cpy, &cynes::CPU::op_cmp, &cynes:: CPU::op_dec, &cynes::CPU::op_dcp,
-    &cynes::CPU::op_bne, &cynes::CPU::op_cmp, &cynes::CPU::op_jam, &cynes::CPU::op_dcp, &cynes::CPU::op_nop, &cynes::CPU::op_cmp, &cynes:: CPU::op_dec, &cynes::CPU::op_dcp,
-    &cynes::CPU::op_cld, &cynes::CPU::op_cmp, &cynes::CPU::op_nop, &cynes::CPU::op_dcp, &cynes::CPU::op_nop, &cynes::CPU::op_cmp, &cynes:: CPU::op_dec, &cynes::CPU::op_dcp,
-    &cynes::CPU::op_cpx, &cynes::CPU::op_sbc, &cynes::CPU::op_nop, &cynes::CPU::op_isc, &cynes::CPU::op_cpx, &cynes::CPU::op_sbc, &cynes:: CPU::op_inc, &cynes::CPU::op_isc,
-    &cynes::CPU::op_inx, &cynes::CPU::op_sbc, &cynes::CPU::op_nop, &cynes::CPU::op_usb, &cynes::CPU::op_cpx, &cynes::CPU::op_sbc, &cynes:: CPU::op_inc, &cynes::CPU::op_isc,
-    &cynes::CPU::op_beq, &cynes::CPU::op_sbc, &cynes::CPU::op_jam, &cynes::CPU::op_isc, &cynes::CPU::op_nop, &cynes::CPU::op_sbc, &cynes:: CPU::op_inc, &cynes::CPU::op_isc,
-    &cynes::CPU::op_sed, &cynes::CPU::op_sbc, &cynes::CPU::op_nop, &cynes::CPU::op_isc, &cynes::CPU::op_nop, &cynes::CPU::op_sbc, &cynes:: CPU::op_inc, &cynes::CPU::op_isc
+    CYNES_CPU_OPCODES(CYNES_CPU_INSTRUCTION)
 };
 
+#undef CYNES_CPU_ADDRESSING_MODE
+#undef CYNES_CPU_INSTRUCTION
+
 
 cynes::CPU::CPU(NES& nes)
 : _nes{nes}
@@ -94,6 +107,12 @@ cynes::CPU::CPU(NES& nes)
 , _edge_detector_non_maskable_interrupt{false}
 , _delay_non_maskable_interrupt{false}
 , _should_issue_non_maskable_interrupt{false}
+, _idle_loop_skip{false}
+, _idle_loop_armed{false}
+, _idle_loop_status{false}
+, _idle_loop_branch{0x0000}
+, _idle_loop_period{0}
+, _idle_loop_length{0}
 , _status{0x00}
 , _target_address{0x0000} {}
 
@@ -109,6 +128,7 @@ void cynes::CPU::power() {
     _register_y = 0x00;
     _stack_pointer = 0xFD;
     _status = Flag::I;
+    _idle_loop_armed = false;
     _program_counter = _nes.read_cpu(0xFFFC);
     _program_counter |= _nes.read_cpu(0xFFFD) << 8;
 }
@@ -121,6 +141,7 @@ void cynes::CPU::reset() {
     _line_delta_interrupt = false;
     _stack_pointer -= 3;
     _status |= Flag::I;
+    _idle_loop_armed = false;
     _program_counter = _nes.read_cpu(0xFFFC);
     _program_counter |= _nes.read_cpu(0xFFFD) << 8;
 }
@@ -130,10 +151,22 @@ void cynes::CPU::tick() {
         return;
     }
 
+    CYNES_PROFILE_COUNT(_nes.counters.cpu_instructions, 1);
+
     uint8_t instruction = fetch_next();
 
+#ifdef CYNES_CPU_SWITCH_DISPATCH
+#define CYNES_CPU_CASE(opcode, mode, operation) case opcode: addr_##mode(); op_##operation(); break;
+
+    switch (instruction) {
+        CYNES_CPU_OPCODES(CYNES_CPU_CASE)
+    }
+
+#undef CYNES_CPU_CASE
+#else
     (this->*ADDRESSING_MODES[instruction])();
     (this->*INSTRUCTIONS[instruction])();
+#endif
 
     if (_delay_non_maskable_interrupt || _delay_interrupt) {
         _nes.read(_program_counter);
@@ -144,7 +177,14 @@ void cynes::CPU::tick() {
 
         uint16_t address = _should_issue_non_maskable_interrupt ? 0xFFFA : 0xFFFE;
 
+        if (address == 0xFFFA) {
+            CYNES_PROFILE_COUNT(_nes.counters.non_maskable_interrupts, 1);
+        } else {
+            CYNES_PROFILE_COUNT(_nes.counters.interrupts, 1);
+        }
+
         _should_issue_non_maskable_interrupt = false;
+        _idle_loop_armed = false;
 
         _nes.write(0x100 | _stack_pointer--, _status | Flag::U);
 
@@ -188,6 +228,112 @@ bool cynes::CPU::is_frozen() const {
     return _frozen;
 }
 
+void cynes::CPU::set_idle_loop_skip(bool skip) {
+    _idle_loop_skip = skip;
+    _idle_loop_armed = false;
+}
+
+void cynes::CPU::update_idle_loop(uint16_t branch, uint16_t target) {
+    if (_idle_loop_armed && _idle_loop_branch == branch) {
+        if (_idle_loop_period > 0) {
+            skip_idle_loop();
+        }
+
+        return;
+    }
+
+    // Any other jump disarms the loop, so that a whole iteration has run once the same
+    // branch is taken again.
+    _idle_loop_branch = branch;
+    _idle_loop_armed = target <= branch;
+    _idle_loop_period = _idle_loop_armed ? get_idle_loop_period(branch, target) : 0;
+}
+
+unsigned int cynes::CPU::get_idle_loop_period(uint16_t branch, uint16_t target) {
+    if (branch >= 0x1FFD && (target < 0x6000 || branch > 0xFFFC)) {
+        return 0;
+    }
+
+    unsigned int period = 0;
+    uint16_t address = target;
+
+    _idle_loop_status = false;
+    _idle_loop_length = 1;
+
+    // The body should only load and compare values, every iteration then leaving the
+    // CPU in the same state as long as the memory does not change.
+    while (address < branch) {
+        switch (_nes.peek_cpu(address)) {
+        case 0x29: case 0xA0: case 0xA2: case 0xA9: case 0xC0: case 0xC9: case 0xE0: {
+            period += 2;
+            address += 2;
+            _idle_loop_length++;
+
+            break;
+        }
+
+        case 0x24: case 0x25: case 0xA4: case 0xA5: case 0xA6: case 0xC4: case 0xC5: case 0xE4: {
+            period += 3;
+            address += 2;
+            _idle_loop_length++;
+
+            break;
+        }
+
+        case 0x2C: case 0x2D: case 0xAC: case 0xAD: case 0xAE: case 0xCC: case 0xCD: case 0xEC: {
+            uint16_t operand = _nes.peek_cpu(address + 1) | (_nes.peek_cpu(address + 2) << 8);
+
+            if (operand >= 0x2000 && (operand >= 0x4000 || (operand & 0x07) != 0x02)) {
+                return 0;
+            }
+
+            _idle_loop_status |= operand >= 0x2000;
+
+            period += 4;
+            address += 3;
+            _idle_loop_length++;
+
+            break;
+        }
+
+        default: return 0;
+        }
+    }
+
+    if (address != branch) {
+        return 0;
+    }
+
+    uint8_t instruction = _nes.peek_cpu(branch);
+
+    if (instruction == 0x4C) {
+        return period + 3;
+    } else if ((instruction & 0x1F) != 0x10) {
+        return 0;
+    }
+
+    return period + (((branch + 2) & 0xFF00) != (target & 0xFF00) ? 4 : 3);
+}
+
+void cynes::CPU::skip_idle_loop() {
+    if (_should_issue_interrupt || _delay_interrupt || _should_issue_non_maskable_interrupt || _delay_non_maskable_interrupt) {
+        return;
+    }
+
+    unsigned int iterations = _nes.get_idle_distance(_idle_loop_status) / _idle_loop_period;
+
+    if (iterations < 2) {
+        return;
+    }
+
+    // The last iteration is run normally.
+    unsigned int skipped = std::min(iterations - 1, _nes.get_idle_instruction_budget() / _idle_loop_length);
+
+    if (skipped > 0) {
+        _nes.skip_idle_cycles(skipped * _idle_loop_period, skipped * _idle_loop_length);
+    }
+}
+
 uint8_t cynes::CPU::fetch_next() {
     return _nes.read(_program_counter++);
 }
@@ -497,6 +643,10 @@ void cynes::CPU::op_bcc() {
             _nes.read(_program_counter);
         }
 
+        if (_idle_loop_skip) {
+            update_idle_loop(_program_counter - 2, translated);
+        }
+
         _program_counter = translated;
     }
 }
@@ -515,6 +665,10 @@ void cynes::CPU::op_bcs() {
             _nes.read(_program_counter);
         }
 
+        if (_idle_loop_skip) {
+            update_idle_loop(_program_counter - 2, translated);
+        }
+
         _program_counter = translated;
     }
 }
@@ -533,6 +687,10 @@ void cynes::CPU::op_beq() {
             _nes.read(_program_counter);
         }
 
+        if (_idle_loop_skip) {
+            update_idle_loop(_program_counter - 2, translated);
+        }
+
         _program_counter = translated;
     }
 }
@@ -557,6 +715,10 @@ void cynes::CPU::op_bmi() {
             _nes.read(_program_counter);
         }
 
+        if (_idle_loop_skip) {
+            update_idle_loop(_program_counter - 2, translated);
+        }
+
         _program_counter = translated;
     }
 }
@@ -575,6 +737,10 @@ void cynes::CPU::op_bne() {
             _nes.read(_program_counter);
         }
 
+        if (_idle_loop_skip) {
+            update_idle_loop(_program_counter - 2, translated);
+        }
+
         _program_counter = translated;
     }
 }
@@ -593,11 +759,17 @@ void cynes::CPU::op_bpl() {
             _nes.read(_program_counter);
         }
 
+        if (_idle_loop_skip) {
+            update_idle_loop(_program_counter - 2, translated);
+        }
+
         _program_counter = translated;
     }
 }
 
 void cynes::CPU::op_brk() {
+    _idle_loop_armed = false;
+
     _program_counter++;
 
     _nes.write(0x100 | _stack_pointer--, _program_counter >> 8);
@@ -631,6 +803,10 @@ void cynes::CPU::op_bvc() {
             _nes.read(_program_counter);
         }
 
+        if (_idle_loop_skip) {
+            update_idle_loop(_program_counter - 2, translated);
+        }
+
         _program_counter = translated;
     }
 }
@@ -649,6 +825,10 @@ void cynes::CPU::op_bvs() {
             _nes.read(_program_counter);
         }
 
+        if (_idle_loop_skip) {
+            update_idle_loop(_program_counter - 2, translated);
+        }
+
         _program_counter = translated;
     }
 }
@@ -783,10 +963,16 @@ void cynes::CPU::op_jam() {
 }
 
 void cynes::CPU::op_jmp() {
+    if (_idle_loop_skip) {
+        update_idle_loop(_program_counter - 3, _target_address);
+    }
+
     _program_counter = _target_address;
 }
 
 void cynes::CPU::op_jsr() {
+    _idle_loop_armed = false;
+
     _nes.read(_program_counter);
 
     _program_counter--;
@@ -980,6 +1166,8 @@ void cynes::CPU::op_rra() {
 }
 
 void cynes::CPU::op_rti() {
+    _idle_loop_armed = false;
+
     _stack_pointer++;
     _nes.read(_program_counter);
     _status = _nes.read(0x100 | _stack_pointer) & 0xCF;
@@ -988,6 +1176,8 @@ void cynes::CPU::op_rti() {
 }
 
 void cynes::CPU::op_rts() {
+    _idle_loop_armed = false;
+
     _stack_pointer++;
 
     _nes.read(_program_counter);
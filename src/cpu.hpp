@@ -50,6 +50,21 @@ public:
     /// Check whether or not the CPU has hit an invalid opcode.
     bool is_frozen() const;
 
+    /// Get the address of the next instruction.
+    inline uint16_t get_program_counter() const { return _program_counter; }
+
+    /// Enable or disable the idle loop skipping.
+    /// @note Idle loops only read from the console RAM or the PPU status register, and
+    /// spin until an interrupt or a PPU event. Once a loop has run twice in a row with
+    /// nothing pending, the console is moved forward by as many whole iterations as
+    /// possible before the next event, the last iteration being run normally. The
+    /// emulation is the same either way, only faster.
+    /// @param skip True to skip the idle loops, false otherwise.
+    void set_idle_loop_skip(bool skip);
+
+    /// Check whether or not the idle loops are skipped.
+    inline bool get_idle_loop_skip() const { return _idle_loop_skip; }
+
 private:
     NES& _nes;
 
@@ -80,6 +95,19 @@ private:
     bool _delay_non_maskable_interrupt;
     bool _should_issue_non_maskable_interrupt;
 
+private:
+    bool _idle_loop_skip;
+    bool _idle_loop_armed;
+    bool _idle_loop_status;
+
+    uint16_t _idle_loop_branch;
+    unsigned int _idle_loop_period;
+    unsigned int _idle_loop_length;
+
+    void update_idle_loop(uint16_t branch, uint16_t target);
+    unsigned int get_idle_loop_period(uint16_t branch, uint16_t target);
+    void skip_idle_loop();
+
 private:
     uint8_t _status;
 
@@ -210,6 +238,10 @@ private:
 public:
     template<DumpOperation operation, typename T>
     constexpr void dump(T& buffer) {
+        if constexpr (operation == DumpOperation::LOAD) {
+            _idle_loop_armed = false;
+        }
+
         cynes::dump<operation>(buffer, _frozen);
         cynes::dump<operation>(buffer, _register_a);
         cynes::dump<operation>(buffer, _register_x);
@@ -0,0 +1,137 @@
+#include "frame_stack.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+
+cynes::FrameStack::FrameStack(
+    size_t count,
+    size_t depth,
+    palette::PixelFormat format,
+    uint8_t factor,
+    bool max_pool
+) : _count{count}
+  , _depth{depth}
+  , _format{format}
+  , _factor{factor}
+  , _max_pool{max_pool}
+  , _observation_size{0}
+  , _next{0}
+{
+    if (count == 0 || depth == 0) {
+        throw std::invalid_argument("The number of emulators and the depth should be positive.");
+    }
+
+    if (factor != 1 && (format != palette::PixelFormat::LUMA || (factor != 2 && factor != 4))) {
+        throw std::invalid_argument("Only luma frames can be downsampled, by a factor of 2 or 4.");
+    }
+
+    switch (format) {
+    case palette::PixelFormat::RGB24: _observation_size = 240 * 256 * 3; break;
+    case palette::PixelFormat::RGBA32: _observation_size = 240 * 256 * 4; break;
+    case palette::PixelFormat::LUMA: _observation_size = (240 / factor) * (256 / factor); break;
+    }
+
+    _data.reset(new uint8_t[count * depth * _observation_size]);
+    std::memset(_data.get(), 0x00, count * depth * _observation_size);
+
+    if (max_pool) {
+        _previous.reset(new uint8_t[count * _observation_size]);
+        std::memset(_previous.get(), 0x00, count * _observation_size);
+    }
+}
+
+cynes::FrameStack::FrameStack(const FrameStack& other)
+    : FrameStack{other._count, other._depth, other._format, other._factor, other._max_pool}
+{
+    _next = other._next;
+
+    std::memcpy(_data.get(), other._data.get(), _count * _depth * _observation_size);
+
+    if (_max_pool) {
+        std::memcpy(_previous.get(), other._previous.get(), _count * _observation_size);
+    }
+}
+
+bool cynes::FrameStack::step(
+    size_t index,
+    NES& nes,
+    uint16_t controllers,
+    unsigned int frames,
+    RenderPolicy policy
+) {
+    if (frames == 0) {
+        return nes.step(controllers, 0, policy);
+    }
+
+    const RenderPolicy skipped = policy == RenderPolicy::ALL ? RenderPolicy::ALL : RenderPolicy::NONE;
+    const unsigned int pooled = _max_pool && frames > 1 ? 2 : 1;
+
+    uint8_t* previous = _max_pool ? _previous.get() + index * _observation_size : nullptr;
+
+    // The step is split around the observed frames, which is equivalent to stepping
+    // all of them at once.
+    if (frames > pooled) {
+        if (nes.step(controllers, frames - pooled, skipped)) {
+            return true;
+        }
+    }
+
+    if (pooled == 2 && !nes.is_done()) {
+        if (nes.step(controllers, 1, RenderPolicy::ALL)) {
+            return true;
+        }
+
+        convert(nes, previous);
+    }
+
+    if (!nes.is_done() && nes.step(controllers, 1, RenderPolicy::ALL)) {
+        return true;
+    }
+
+    uint8_t* slot = get_slot(index, _next);
+
+    convert(nes, slot);
+
+    if (!_max_pool) {
+        return false;
+    }
+
+    // The previous frame is replaced by the current one once pooled, so that single
+    // frame steps are pooled with the last frame of the previous step.
+    for (size_t k = 0; k < _observation_size; k++) {
+        uint8_t value = slot[k];
+
+        slot[k] = std::max(value, previous[k]);
+        previous[k] = value;
+    }
+
+    return false;
+}
+
+void cynes::FrameStack::advance() {
+    _next = (_next + 1) % _depth;
+}
+
+void cynes::FrameStack::fill(size_t index, const NES& nes) {
+    uint8_t* first = get_slot(index, 0);
+
+    convert(nes, first);
+
+    for (size_t slot = 1; slot < _depth; slot++) {
+        std::memcpy(get_slot(index, slot), first, _observation_size);
+    }
+
+    if (_max_pool) {
+        std::memcpy(_previous.get() + index * _observation_size, first, _observation_size);
+    }
+}
+
+uint8_t* cynes::FrameStack::get_slot(size_t index, size_t slot) {
+    return _data.get() + (index * _depth + slot) * _observation_size;
+}
+
+void cynes::FrameStack::convert(const NES& nes, uint8_t* output) const {
+    palette::convert(nes.get_frame_indices(), nes.get_frame_emphasis(), output, _format, _factor);
+}
@@ -0,0 +1,100 @@
+#ifndef __CYNES_FRAME_STACK__
+#define __CYNES_FRAME_STACK__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "nes.hpp"
+#include "palette.hpp"
+
+namespace cynes {
+/// Ring of the last processed observations of a batch of emulators.
+/// @note Each step of an emulator writes a single observation, converted from its
+/// indexed frame buffer into the given pixel format, and optionally max-pooled over
+/// the last two frames of the step (the usual Atari preprocessing, removing the
+/// flickering of the sprites). Every emulator of the batch writes to the same slot of
+/// the ring, which only rotates once the whole batch has been stepped.
+class FrameStack {
+public:
+    /// Initialize the ring, filled with zeros.
+    /// @param count Number of emulators.
+    /// @param depth Number of observations kept for each emulator.
+    /// @param format Pixel format of the observations.
+    /// @param factor Downsampling factor (1, 2 or 4), only supported by `PixelFormat::LUMA`.
+    /// @param max_pool Whether or not the observations are max-pooled over the last two
+    /// frames of each step.
+    FrameStack(size_t count, size_t depth, palette::PixelFormat format, uint8_t factor, bool max_pool);
+
+    /// Initialize the ring as a copy of another one, including its observations.
+    /// @param other Ring to copy.
+    FrameStack(const FrameStack& other);
+
+    /// Default destructor.
+    ~FrameStack() = default;
+
+public:
+    /// Step an emulator and write its observation to the current slot of the ring.
+    /// @note Only the frames needed by the observation are rendered, unless the policy
+    /// renders all of them. When a done condition stops the step before the last frame,
+    /// the observation is made from the last rendered frame.
+    /// @param index Index of the emulator in the batch.
+    /// @param nes Emulator, its frame buffer format should be `FrameFormat::INDEXED`.
+    /// @param controllers Controllers states.
+    /// @param frames Number of frame of the step.
+    /// @param policy Frames of the step composed into the frame buffer, in addition to
+    /// the observed ones.
+    /// @return True if the CPU is frozen, false otherwise.
+    bool step(size_t index, NES& nes, uint16_t controllers, unsigned int frames, RenderPolicy policy);
+
+    /// Rotate the ring, once every emulator of the batch has been stepped.
+    void advance();
+
+    /// Fill every slot of an emulator with its current frame.
+    /// @note Should be used at the start of an episode, after a reset or a load.
+    /// @param index Index of the emulator in the batch.
+    /// @param nes Emulator, its frame buffer format should be `FrameFormat::INDEXED`.
+    void fill(size_t index, const NES& nes);
+
+    /// Get a pointer to the ring, with a shape of (count, depth, observation).
+    inline const uint8_t* get_data() const { return _data.get(); }
+
+    /// Get the slot holding the oldest observation, the following slots (modulo the
+    /// depth) hold the more recent ones.
+    inline size_t get_start() const { return _next; }
+
+    /// Get the number of emulators.
+    inline size_t get_count() const { return _count; }
+
+    /// Get the number of observations kept for each emulator.
+    inline size_t get_depth() const { return _depth; }
+
+    /// Get the size of a single observation in bytes.
+    inline size_t get_observation_size() const { return _observation_size; }
+
+    /// Get the pixel format of the observations.
+    inline palette::PixelFormat get_format() const { return _format; }
+
+    /// Get the downsampling factor of the observations.
+    inline uint8_t get_factor() const { return _factor; }
+
+private:
+    const size_t _count;
+    const size_t _depth;
+    const palette::PixelFormat _format;
+    const uint8_t _factor;
+    const bool _max_pool;
+
+    size_t _observation_size;
+    size_t _next;
+
+    std::unique_ptr<uint8_t[]> _data;
+    std::unique_ptr<uint8_t[]> _previous;
+
+private:
+    uint8_t* get_slot(size_t index, size_t slot);
+    void convert(const NES& nes, uint8_t* output) const;
+};
+}
+
+#endif
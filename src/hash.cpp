@@ -0,0 +1,150 @@
+#include "hash.hpp"
+
+#include <cstring>
+
+
+// Primes of the XXH64 specification.
+constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+
+namespace {
+inline uint64_t rotate_left(uint64_t value, unsigned int count) {
+    return (value << count) | (value >> (64 - count));
+}
+
+// Input words are read in little-endian, with a plain load on little-endian hosts.
+template<typename T>
+inline T read_word(const uint8_t* pointer) {
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_MSC_VER)
+    T value;
+    std::memcpy(&value, pointer, sizeof(T));
+
+    return value;
+#else
+    return cynes::read_little_endian<T>(pointer);
+#endif
+}
+
+inline uint64_t read_64(const uint8_t* pointer) {
+    return read_word<uint64_t>(pointer);
+}
+
+inline uint32_t read_32(const uint8_t* pointer) {
+    return read_word<uint32_t>(pointer);
+}
+
+inline uint64_t accumulate(uint64_t accumulator, uint64_t input) {
+    accumulator += input * PRIME_2;
+    accumulator = rotate_left(accumulator, 31);
+
+    return accumulator * PRIME_1;
+}
+
+inline uint64_t merge_round(uint64_t accumulator, uint64_t value) {
+    accumulator ^= accumulate(0, value);
+
+    return accumulator * PRIME_1 + PRIME_4;
+}
+
+inline void consume_stripe(uint64_t* accumulators, const uint8_t* stripe) {
+    accumulators[0] = accumulate(accumulators[0], read_64(stripe));
+    accumulators[1] = accumulate(accumulators[1], read_64(stripe + 8));
+    accumulators[2] = accumulate(accumulators[2], read_64(stripe + 16));
+    accumulators[3] = accumulate(accumulators[3], read_64(stripe + 24));
+}
+}
+
+
+cynes::Hasher::Hasher(uint64_t seed)
+    : _accumulators{seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1}
+    , _buffered{0}
+    , _length{0}
+    , _seed{seed} {}
+
+void cynes::Hasher::update(const uint8_t* data, size_t size) {
+    _length += size;
+
+    if (_buffered + size < 32) {
+        std::memcpy(_buffer + _buffered, data, size);
+        _buffered += size;
+
+        return;
+    }
+
+    if (_buffered > 0) {
+        size_t missing = 32 - _buffered;
+
+        std::memcpy(_buffer + _buffered, data, missing);
+        consume_stripe(_accumulators, _buffer);
+
+        data += missing;
+        size -= missing;
+
+        _buffered = 0;
+    }
+
+    while (size >= 32) {
+        consume_stripe(_accumulators, data);
+
+        data += 32;
+        size -= 32;
+    }
+
+    std::memcpy(_buffer, data, size);
+    _buffered = size;
+}
+
+uint64_t cynes::Hasher::digest() const {
+    uint64_t hash;
+
+    if (_length >= 32) {
+        hash = rotate_left(_accumulators[0], 1) + rotate_left(_accumulators[1], 7)
+            + rotate_left(_accumulators[2], 12) + rotate_left(_accumulators[3], 18);
+
+        for (uint64_t accumulator : _accumulators) {
+            hash = merge_round(hash, accumulator);
+        }
+    } else {
+        hash = _seed + PRIME_5;
+    }
+
+    hash += _length;
+
+    const uint8_t* cursor = _buffer;
+    const uint8_t* end = _buffer + _buffered;
+
+    for (; cursor + 8 <= end; cursor += 8) {
+        hash ^= accumulate(0, read_64(cursor));
+        hash = rotate_left(hash, 27) * PRIME_1 + PRIME_4;
+    }
+
+    if (cursor + 4 <= end) {
+        hash ^= static_cast<uint64_t>(read_32(cursor)) * PRIME_1;
+        hash = rotate_left(hash, 23) * PRIME_2 + PRIME_3;
+        cursor += 4;
+    }
+
+    for (; cursor < end; cursor++) {
+        hash ^= *cursor * PRIME_5;
+        hash = rotate_left(hash, 11) * PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+uint64_t cynes::hash(const uint8_t* data, size_t size, uint64_t seed) {
+    Hasher hasher{seed};
+    hasher.update(data, size);
+
+    return hasher.digest();
+}
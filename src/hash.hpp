@@ -0,0 +1,76 @@
+#ifndef __CYNES_HASH__
+#define __CYNES_HASH__
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "utils.hpp"
+
+namespace cynes {
+/// Streaming XXH64 hasher.
+/// @note The digest is the same as the one of the reference XXH64 implementation over
+/// the concatenation of every update, nothing is allocated.
+class Hasher {
+public:
+    /// Initialize the hasher.
+    /// @param seed Hash seed.
+    Hasher(uint64_t seed = 0);
+
+    /// Default destructor.
+    ~Hasher() = default;
+
+public:
+    /// Feed bytes to the hasher.
+    /// @param data Bytes to hash.
+    /// @param size Number of bytes.
+    void update(const uint8_t* data, size_t size);
+
+    /// Get the hash of the bytes fed so far.
+    /// @return The 64-bit hash.
+    uint64_t digest() const;
+
+private:
+    uint64_t _accumulators[4];
+    uint8_t _buffer[32];
+    size_t _buffered;
+    uint64_t _length;
+    uint64_t _seed;
+};
+
+/// Hash the given bytes using XXH64.
+/// @param data Bytes to hash.
+/// @param size Number of bytes.
+/// @param seed Hash seed.
+/// @return The 64-bit hash.
+uint64_t hash(const uint8_t* data, size_t size, uint64_t seed = 0);
+
+// Values are hashed with the same little-endian layout as in the save states, so that
+// hashing a state is the same as hashing its dump.
+template<DumpOperation operation, typename T>
+constexpr void dump(Hasher& hasher, T& value) {
+    if constexpr (std::is_array_v<T>) {
+        for (auto& element : value) {
+            dump<operation>(hasher, element);
+        }
+    } else {
+        uint8_t bytes[sizeof(T)];
+        write_little_endian(bytes, value);
+
+        hasher.update(bytes, sizeof(T));
+    }
+}
+
+template<DumpOperation operation, typename T>
+constexpr void dump(Hasher& hasher, T* values, unsigned int size) {
+    if constexpr (sizeof(T) == 1 && !std::is_same_v<T, bool>) {
+        hasher.update(reinterpret_cast<const uint8_t*>(values), size);
+    } else {
+        for (unsigned int k = 0; k < size; k++) {
+            dump<operation>(hasher, values[k]);
+        }
+    }
+}
+}
+
+#endif
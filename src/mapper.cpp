@@ -4,7 +4,7 @@
 #include "nes.hpp"
 
 #include <algorithm>
-#include <fstream>
+#include <limits>
 #include <random>
 #include <sstream>
 
@@ -21,143 +21,83 @@ cynes::Mapper::MemoryBank::MemoryBank(size_t offset, bool read_only)
 
 cynes::Mapper::Mapper(
     NES& nes,
-    const ParsedMemory& metadata,
+    const std::shared_ptr<const Cartridge>& cartridge,
     MirroringMode mode,
     uint8_t size_cpu_ram,
     uint8_t size_ppu_ram
 ) : _nes{nes}
-  , _banks_prg{metadata.size_prg}
-  , _banks_chr{metadata.size_chr}
+  , _banks_prg{cartridge->get_size_prg()}
+  , _banks_chr{cartridge->get_size_chr()}
   , _banks_cpu_ram{size_cpu_ram}
   , _banks_ppu_ram{size_ppu_ram}
+  , _watch_ppu{false}
   , _size_prg{static_cast<size_t>(_banks_prg) << 10}
   , _size_chr{static_cast<size_t>(_banks_chr) << 10}
   , _size_cpu_ram{static_cast<size_t>(_banks_cpu_ram) << 10}
   , _size_ppu_ram{static_cast<size_t>(_banks_ppu_ram) << 10}
-  , _read_only_chr{metadata.read_only_chr}
-  , _memory{new uint8_t[_size_prg + _size_chr + _size_cpu_ram + _size_ppu_ram]}
+  , _read_only_chr{cartridge->is_read_only_chr()}
+  , _cartridge{cartridge}
+  , _memory_rom{cartridge->get_memory_rom()}
+  , _size_rom{cartridge->get_size_rom()}
+  , _memory{new uint8_t[get_size_chr_ram() + _size_cpu_ram + _size_ppu_ram]()}
+  , _dirty_blocks{(get_size_chr_ram() + _size_cpu_ram + _size_ppu_ram) >> 10}
   , _banks_cpu{}
   , _banks_ppu{}
+  , _pages_cpu{}
+  , _pages_ppu{}
 {
-    if (_size_prg > 0) {
-        std::memcpy(
-            _memory.get(),
-            metadata.memory_prg.get(),
-            _size_prg
-        );
-    }
+    set_mirroring_mode(mode);
+}
 
-    if (_size_chr > 0) {
-        std::memcpy(
-            _memory.get() + _size_prg,
-            metadata.memory_chr.get(),
-            _size_chr
-        );
-    }
+void cynes::Mapper::power() {
+    uint8_t* memory_cpu_ram = _memory.get() + get_size_chr_ram();
 
     random_bytes_engine engine{};
 
-    if (metadata.trainer != nullptr) {
-        std::memcpy(
-            _memory.get() + _size_prg + _size_chr,
-            metadata.trainer.get(),
-            0x200
-        );
+    if (_cartridge->get_trainer() != nullptr) {
+        std::memcpy(memory_cpu_ram, _cartridge->get_trainer(), 0x200);
 
         std::generate(
-            _memory.get() + _size_prg + _size_chr + 0x200,
-            _memory.get() + _size_prg + _size_chr + _size_cpu_ram,
+            memory_cpu_ram + 0x200,
+            memory_cpu_ram + _size_cpu_ram,
             std::ref(engine)
         );
     } else {
         std::generate(
-            _memory.get() + _size_prg + _size_chr,
-            _memory.get() + _size_prg + _size_chr + _size_cpu_ram,
+            memory_cpu_ram,
+            memory_cpu_ram + _size_cpu_ram,
             std::ref(engine)
         );
     }
 
     if (_size_ppu_ram > 0) {
         std::generate(
-            _memory.get() + _size_prg + _size_chr + _size_cpu_ram,
-            _memory.get() + _size_prg + _size_chr + _size_cpu_ram + _size_ppu_ram,
+            memory_cpu_ram + _size_cpu_ram,
+            memory_cpu_ram + _size_cpu_ram + _size_ppu_ram,
             std::ref(engine)
         );
     }
-
-    set_mirroring_mode(mode);
 }
 
 std::unique_ptr<cynes::Mapper> cynes::Mapper::load_mapper(
     NES &nes,
-    const std::filesystem::path& path_rom
+    const std::shared_ptr<const Cartridge>& cartridge
 ) {
-    std::ifstream stream{path_rom, std::ios::binary};
-
-    if (!stream.is_open()) {
-        throw std::runtime_error("The file cannot be read.");
-    }
-
-    uint32_t header;
-    stream.read(reinterpret_cast<char*>(&header), sizeof(uint32_t));
-
-    if (header != 0x1A53454E) {
-        throw std::runtime_error("The specified file is not a NES ROM.");
-    }
-
-    uint8_t program_banks = stream.get();
-    uint8_t character_banks = stream.get();
-    uint8_t flag6 = stream.get();
-    uint8_t flag7 = stream.get();
-
-    stream.seekg(8, std::ios::cur);
-
-    cynes::ParsedMemory metadata{};
-    metadata.size_prg = static_cast<uint16_t>(program_banks) << 4;
-    metadata.size_chr = static_cast<uint16_t>(character_banks) << 3;
-
-    if (flag6 & 0x04) {
-        metadata.trainer.reset(new uint8_t[0x200]);
-        stream.read(reinterpret_cast<char*>(metadata.trainer.get()), 0x200);
-    }
-
-    if (metadata.size_prg > 0) {
-        size_t memory_size = static_cast<size_t>(metadata.size_prg) << 10;
-        metadata.memory_prg.reset(new uint8_t[memory_size]);
-        stream.read(reinterpret_cast<char*>(metadata.memory_prg.get()), memory_size);
-    }
-
-    if (metadata.size_chr > 0) {
-        size_t memory_size = static_cast<size_t>(metadata.size_chr) << 10;
-        metadata.read_only_chr = true;
-        metadata.memory_chr.reset(new uint8_t[memory_size]);
-        stream.read(reinterpret_cast<char*>(metadata.memory_chr.get()), memory_size);
-    } else {
-        metadata.size_chr = 8;
-        metadata.read_only_chr = false;
-        metadata.memory_chr.reset(new uint8_t[0x2000]);
-    }
-
-    stream.close();
-
-    uint8_t mapper_index = (flag7 & 0xF0) | flag6 >> 4;
-
-    cynes::MirroringMode mode = (flag6 & 0x01) == 1
-        ? cynes::MirroringMode::VERTICAL
-        : cynes::MirroringMode::HORIZONTAL;
+    uint16_t mapper_index = cartridge->get_mapper_index();
+    cynes::MirroringMode mode = cartridge->get_mirroring_mode();
 
     switch (mapper_index) {
-    case   0: return std::make_unique<cynes::NROM> (nes, metadata, mode);
-    case   1: return std::make_unique<cynes::MMC1> (nes, metadata, mode);
-    case   2: return std::make_unique<cynes::UxROM>(nes, metadata, mode);
-    case   3: return std::make_unique<cynes::CNROM>(nes, metadata, mode);
-    case   4: return std::make_unique<cynes::MMC3> (nes, metadata, mode);
-    case   7: return std::make_unique<cynes::AxROM>(nes, metadata);
-    case   9: return std::make_unique<cynes::MMC2> (nes, metadata, mode);
-    case  10: return std::make_unique<cynes::MMC4> (nes, metadata, mode);
-    case  30: return std::make_unique<cynes::UNROM512>(nes, metadata, mode);
-    case  66: return std::make_unique<cynes::GxROM>(nes, metadata, mode);
-    case  71: return std::make_unique<cynes::UxROM>(nes, metadata, mode);
+    case   0: return std::make_unique<cynes::NROM> (nes, cartridge, mode);
+    case   1: return std::make_unique<cynes::MMC1> (nes, cartridge, mode);
+    case   2: return std::make_unique<cynes::UxROM>(nes, cartridge, mode);
+    case   3: return std::make_unique<cynes::CNROM>(nes, cartridge, mode);
+    case   4: return std::make_unique<cynes::MMC3> (nes, cartridge, mode);
+    case   7: return std::make_unique<cynes::AxROM>(nes, cartridge);
+    case   9: return std::make_unique<cynes::MMC2> (nes, cartridge, mode);
+    case  10: return std::make_unique<cynes::MMC4> (nes, cartridge, mode);
+    case  30: return std::make_unique<cynes::UNROM512>(nes, cartridge, mode);
+    case  66: return std::make_unique<cynes::GxROM>(nes, cartridge, mode);
+    case  71: return std::make_unique<cynes::UxROM>(nes, cartridge, mode);
     default: break;
     }
 
@@ -172,11 +112,18 @@ std::unique_ptr<cynes::Mapper> cynes::Mapper::load_mapper(
 
 void cynes::Mapper::tick() { }
 
+unsigned int cynes::Mapper::get_interrupt_distance() const {
+    return std::numeric_limits<unsigned int>::max();
+}
+
 void cynes::Mapper::write_cpu(uint16_t address, uint8_t value) {
     const auto& bank = _banks_cpu[address >> 10];
 
     if (!bank.read_only && bank.mapped) {
-        _memory[bank.offset + (address & 0x3FF)] = value;
+        size_t offset = bank.offset - _size_rom + (address & 0x3FF);
+
+        _memory[offset] = value;
+        _dirty_blocks.insert(offset >> 10);
     }
 }
 
@@ -184,28 +131,41 @@ void cynes::Mapper::write_ppu(uint16_t address, uint8_t value) {
     const auto& bank = _banks_ppu[address >> 10];
 
     if (!bank.read_only && bank.mapped) {
-        _memory[bank.offset + (address & 0x3FF)] = value;
+        size_t offset = bank.offset - _size_rom + (address & 0x3FF);
+
+        _memory[offset] = value;
+        _dirty_blocks.insert(offset >> 10);
     }
 }
 
 uint8_t cynes::Mapper::read_cpu(uint16_t address) {
-    const auto& bank = _banks_cpu[address >> 10];
+    const uint8_t* page = _pages_cpu[address >> 10];
 
-    if (!bank.mapped) {
+    if (page == nullptr) {
         return _nes.get_open_bus();
     }
 
-    return _memory[bank.offset + (address & 0x3FF)];
+    return page[address & 0x3FF];
 }
 
 uint8_t cynes::Mapper::read_ppu(uint16_t address) {
-    const auto& bank = _banks_ppu[address >> 10];
+    const uint8_t* page = _pages_ppu[address >> 10];
 
-    if (!bank.mapped) {
+    if (page == nullptr) {
         return 0x00;
     }
 
-    return _memory[bank.offset + (address & 0x3FF)];
+    return page[address & 0x3FF];
+}
+
+void cynes::Mapper::update_pages() {
+    for (uint8_t k = 0x00; k < 0x40; k++) {
+        _pages_cpu[k] = get_page(_banks_cpu[k]);
+    }
+
+    for (uint8_t k = 0x00; k < 0x10; k++) {
+        _pages_ppu[k] = get_page(_banks_ppu[k]);
+    }
 }
 
 void cynes::Mapper::map_bank_prg(uint8_t page, uint16_t address) {
@@ -213,6 +173,8 @@ void cynes::Mapper::map_bank_prg(uint8_t page, uint16_t address) {
         static_cast<size_t>(address << 10),
         true
     };
+
+    _pages_cpu[page] = get_page(_banks_cpu[page]);
 }
 
 void cynes::Mapper::map_bank_prg(uint8_t page, uint8_t size, uint16_t address) {
@@ -226,6 +188,8 @@ void cynes::Mapper::map_bank_cpu_ram(uint8_t page, uint16_t address, bool read_o
         _size_prg + _size_chr + static_cast<size_t>(address << 10),
         read_only
     };
+
+    _pages_cpu[page] = get_page(_banks_cpu[page]);
 }
 
 void cynes::Mapper::map_bank_cpu_ram(uint8_t page, uint8_t size, uint16_t address, bool read_only) {
@@ -239,6 +203,8 @@ void cynes::Mapper::map_bank_chr(uint8_t page, uint16_t address) {
         _size_prg + static_cast<size_t>(address << 10),
         _read_only_chr
     };
+
+    _pages_ppu[page] = get_page(_banks_ppu[page]);
 }
 
 void cynes::Mapper::map_bank_chr(uint8_t page, uint8_t size, uint16_t address) {
@@ -252,6 +218,8 @@ void cynes::Mapper::map_bank_ppu_ram(uint8_t page, uint16_t address, bool read_o
         _size_prg + _size_chr + _size_cpu_ram + static_cast<size_t>(address << 10),
         read_only
     };
+
+    _pages_ppu[page] = get_page(_banks_ppu[page]);
 }
 
 void cynes::Mapper::map_bank_ppu_ram(uint8_t page, uint8_t size, uint16_t address, bool read_only) {
@@ -262,6 +230,7 @@ void cynes::Mapper::map_bank_ppu_ram(uint8_t page, uint8_t size, uint16_t addres
 
 void cynes::Mapper::unmap_bank_cpu(uint8_t page) {
     _banks_cpu[page] = {};
+    _pages_cpu[page] = nullptr;
 }
 
 void cynes::Mapper::unmap_bank_cpu(uint8_t page, uint8_t size) {
@@ -297,18 +266,28 @@ void cynes::Mapper::set_mirroring_mode(MirroringMode mode) {
 void cynes::Mapper::mirror_cpu_banks(uint8_t page, uint8_t size, uint8_t mirror) {
     for (uint8_t index = 0; index < size; index++) {
         _banks_cpu[mirror + index] = _banks_cpu[page + index];
+        _pages_cpu[mirror + index] = _pages_cpu[page + index];
     }
 }
 
 void cynes::Mapper::mirror_ppu_banks(uint8_t page, uint8_t size, uint8_t mirror) {
     for (uint8_t index = 0; index < size; index++) {
         _banks_ppu[mirror + index] = _banks_ppu[page + index];
+        _pages_ppu[mirror + index] = _pages_ppu[page + index];
     }
 }
 
+void cynes::Mapper::size_registers(unsigned int&) { }
+
+void cynes::Mapper::save_registers(uint8_t*&) { }
+
+void cynes::Mapper::load_registers(uint8_t*&) { }
+
+void cynes::Mapper::hash_registers(Hasher&) { }
 
-cynes::NROM::NROM(NES& nes, const ParsedMemory& metadata, MirroringMode mode)
-    : Mapper(nes, metadata, mode)
+
+cynes::NROM::NROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode)
+    : Mapper(nes, cartridge, mode)
 {
     map_bank_chr(0x0, 0x8, 0x0);
 
@@ -325,9 +304,9 @@ cynes::NROM::NROM(NES& nes, const ParsedMemory& metadata, MirroringMode mode)
 
 cynes::MMC1::MMC1(
     NES& nes,
-    const ParsedMemory& metadata,
+    const std::shared_ptr<const Cartridge>& cartridge,
     MirroringMode mode
-) : Mapper(nes, metadata, mode)
+) : Mapper(nes, cartridge, mode)
   , _tick{0x00}
   , _registers{}
   , _register{0x00}
@@ -412,8 +391,8 @@ void cynes::MMC1::update_banks() {
 }
 
 
-cynes::UxROM::UxROM(NES& nes, const ParsedMemory& metadata, MirroringMode mode)
-    : Mapper(nes, metadata, mode, 0x0, 0x10)
+cynes::UxROM::UxROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode)
+    : Mapper(nes, cartridge, mode, 0x0, 0x10)
 {
     map_bank_prg(0x20, 0x10, 0x00);
     map_bank_prg(0x30, 0x10, _banks_prg - 0x10);
@@ -429,12 +408,12 @@ void cynes::UxROM::write_cpu(uint16_t address, uint8_t value) {
     }
 }
 
-cynes::UNROM512::UNROM512(NES& nes, const ParsedMemory& metadata, MirroringMode mode)
-    : Mapper(nes, metadata, mode, 0x0, 32) // Allocate 32KB of CHR-RAM
+cynes::UNROM512::UNROM512(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode)
+    : Mapper(nes, cartridge, mode, 0x0, 32) // Allocate 32KB of CHR-RAM
 {
     // Set up initial banks
     map_bank_prg(0x20, 0x10, 0x00); // Map first 16KB PRG bank to $8000
-    map_bank_prg(0x30, 0x10, metadata.size_prg - 0x10); // Map last 16KB PRG bank to $C000 (fixed)
+    map_bank_prg(0x30, 0x10, _banks_prg - 0x10); // Map last 16KB PRG bank to $C000 (fixed)
 
     // Map first 8KB of CHR-RAM to PPU $0000
     map_bank_ppu_ram(0x0, 0x8, 0x00, false);
@@ -455,8 +434,8 @@ void cynes::UNROM512::write_cpu(uint16_t address, uint8_t value) {
     }
 }
 
-cynes::CNROM::CNROM(NES& nes, const ParsedMemory& metadata, MirroringMode mode)
-    : Mapper(nes, metadata, mode, 0x0)
+cynes::CNROM::CNROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode)
+    : Mapper(nes, cartridge, mode, 0x0)
 {
     map_bank_chr(0x0, 0x8, 0x0);
 
@@ -479,9 +458,9 @@ void cynes::CNROM::write_cpu(uint16_t address, uint8_t value) {
 
 cynes::MMC3::MMC3(
     NES& nes,
-    const ParsedMemory& metadata,
+    const std::shared_ptr<const Cartridge>& cartridge,
     MirroringMode mode
-) : Mapper(nes, metadata, mode)
+) : Mapper(nes, cartridge, mode)
   , _tick{0x0000}
   , _registers{}
   , _counter{0x0000}
@@ -492,6 +471,8 @@ cynes::MMC3::MMC3(
   , _enable_interrupt{false}
   , _should_reload_interrupt{false}
 {
+    _watch_ppu = true;
+
     map_bank_chr(0x0, 0x8, 0x0);
     map_bank_prg(0x20, 0x10, 0x0);
     map_bank_prg(0x30, 0x10, _banks_prg - 0x10);
@@ -506,6 +487,22 @@ void cynes::MMC3::tick() {
     }
 }
 
+unsigned int cynes::MMC3::get_interrupt_distance() const {
+    if (!_enable_interrupt) {
+        return cynes::Mapper::get_interrupt_distance();
+    }
+
+    // Number of A12 rising edges clocking the counter before the interrupt is raised.
+    unsigned int clocks = _counter;
+
+    if (_counter == 0 || _should_reload_interrupt) {
+        clocks = _counter_reset_value + 1;
+    }
+
+    // The A12 filter ignores the rising edges happening less than 10 dots apart.
+    return 1 + (clocks - 1) * 10;
+}
+
 void cynes::MMC3::write_cpu(uint16_t address, uint8_t value) {
     if (address < 0x8000) {
         cynes::Mapper::write_cpu(address, value);
@@ -607,8 +604,8 @@ void cynes::MMC3::update_state(bool state) {
 }
 
 
-cynes::AxROM::AxROM(NES& nes, const ParsedMemory& metadata)
-    : Mapper(nes, metadata, MirroringMode::ONE_SCREEN_LOW, 0x8, 0x10)
+cynes::AxROM::AxROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge)
+    : Mapper(nes, cartridge, MirroringMode::ONE_SCREEN_LOW, 0x8, 0x10)
 {
     map_bank_ppu_ram(0x0, 0x8, 0x2, false);
     map_bank_prg(0x20, 0x20, 0x0);
@@ -629,8 +626,8 @@ void cynes::AxROM::write_cpu(uint16_t address, uint8_t value) {
 }
 
 
-cynes::GxROM::GxROM(NES& nes, const ParsedMemory& metadata, MirroringMode mode)
-    : Mapper(nes, metadata, mode, 0x0)
+cynes::GxROM::GxROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode)
+    : Mapper(nes, cartridge, mode, 0x0)
 {
     map_bank_prg(0x20, 0x20, 0x0);
     map_bank_chr(0x00, 0x08, 0x0);
@@ -4,43 +4,28 @@
 #include <array>
 #include <cstdint>
 #include <cstring>
-#include <filesystem>
 #include <memory>
 
+#include "cartridge.hpp"
+#include "hash.hpp"
 #include "utils.hpp"
 
 namespace cynes {
 // Forward declaration.
 class NES;
 
-enum class MirroringMode : uint8_t {
-    NONE, ONE_SCREEN_LOW, ONE_SCREEN_HIGH, HORIZONTAL, VERTICAL
-};
-
-/// Simple wrapper storing memory parsed from a ROM file.
-struct ParsedMemory {
-public:
-    bool read_only_chr = true;
-    uint16_t size_prg = 0x00;
-    uint16_t size_chr = 0x00;
-
-    std::unique_ptr<uint8_t[]> trainer;
-    std::unique_ptr<uint8_t[]> memory_prg;
-    std::unique_ptr<uint8_t[]> memory_chr;
-};
-
 /// Generic NES Mapper (see https://www.nesdev.org/wiki/Mapper).
 class Mapper {
 public:
     /// Initialize the mapper.
     /// @param nes Emulator.
-    /// @param metadata ROM metadata.
+    /// @param cartridge Shared ROM image.
     /// @param mode Mapper mirroring mode.
     /// @param size_cpu_ram Size of the CPU RAM.
     /// @param size_ppu_ram Size of the PPU RAM.
     Mapper(
         NES& nes,
-        const ParsedMemory& metadata,
+        const std::shared_ptr<const Cartridge>& cartridge,
         MirroringMode mode,
         uint8_t size_cpu_ram = 0x8,
         uint8_t size_ppu_ram = 0x2
@@ -49,19 +34,28 @@ public:
     /// Default destructor.
     virtual ~Mapper() = default;
 
-    /// Load and deserialize a ROM into a mapper.
+    /// Instantiate the mapper used by a ROM.
     /// @param nes Emulator.
-    /// @param path_rom Path to the NES ROM file.
+    /// @param cartridge Shared ROM image.
     /// @return A pointer to the instantiated mapper.
     static std::unique_ptr<Mapper> load_mapper(
         NES& nes,
-        const std::filesystem::path& path_rom
+        const std::shared_ptr<const Cartridge>& cartridge
     );
 
 public:
+    /// Fill the mapper RAM with its power-up content (trainer and pseudo-random bytes).
+    void power();
+
     /// Tick the mapper.
     virtual void tick();
 
+    /// Get the minimum number of PPU dots before the mapper can raise its interrupt.
+    /// @note The PPU is only caught up with the CPU when its state can be observed, this
+    /// bound is one of the deadlines of the catch-up scheduling.
+    /// @return A lower bound of the number of PPU dots before the next interrupt.
+    virtual unsigned int get_interrupt_distance() const;
+
     /// Write to a CPU mapped memory bank.
     /// @note This function has other side effects than simply writing to the memory, it
     /// should not be used as a memory set function.
@@ -90,6 +84,53 @@ public:
     /// @return The value stored at the given address.
     virtual uint8_t read_ppu(uint16_t address);
 
+    /// Get a pointer to the CPU memory mapped bank containing the address.
+    /// @note The page table is rebuilt whenever the mapper remaps a bank, reading through
+    /// it bypasses `Mapper::read_cpu`.
+    /// @param address Memory address within the console memory address space.
+    /// @return A pointer to the start of the 1 KiB bank, `nullptr` if it is unmapped.
+    inline const uint8_t* get_page_cpu(uint16_t address) const {
+        return _pages_cpu[address >> 10];
+    }
+
+    /// Get a pointer to the PPU memory mapped bank containing the address.
+    /// @note The page table is rebuilt whenever the mapper remaps a bank, reading through
+    /// it bypasses `Mapper::read_ppu`.
+    /// @param address Memory address within the PPU memory address space.
+    /// @return A pointer to the start of the 1 KiB bank, `nullptr` if it is unmapped.
+    inline const uint8_t* get_page_ppu(uint16_t address) const {
+        return _pages_ppu[address >> 10];
+    }
+
+    /// Check whether or not the mapper watches the PPU reads (MMC2 / MMC4 latches, MMC3
+    /// scanline counter).
+    /// @note The PPU reads of these mappers must go through `Mapper::read_ppu`.
+    inline bool is_watching_ppu() const { return _watch_ppu; }
+
+    /// Get the ROM image used by the mapper.
+    inline const Cartridge& get_cartridge() const { return *_cartridge; }
+
+    /// Get the shared ROM image used by the mapper.
+    inline const std::shared_ptr<const Cartridge>& get_shared_cartridge() const { return _cartridge; }
+
+    /// Get a pointer to the mapper memory (CHR-RAM, CPU RAM and PPU RAM).
+    inline uint8_t* get_memory() { return _memory.get(); }
+
+    /// Get the size of the mapper memory in bytes.
+    inline size_t get_size_memory() const { return get_size_chr_ram() + _size_cpu_ram + _size_ppu_ram; }
+
+    /// Get a pointer to the CPU RAM of the mapper (PRG-RAM).
+    inline const uint8_t* get_cpu_ram() const { return _memory.get() + get_size_chr_ram(); }
+
+    /// Get the size of the CPU RAM of the mapper in bytes.
+    inline size_t get_size_cpu_ram() const { return _size_cpu_ram; }
+
+    /// Get the number of 1 KiB blocks of the mapper memory.
+    inline size_t get_memory_blocks() const { return _dirty_blocks.capacity(); }
+
+    /// Get the blocks of the mapper memory written since the last snapshot base.
+    inline BlockSet& get_dirty_blocks() { return _dirty_blocks; }
+
 protected:
     /// A memory bank provides a view within the mapper memory.
     // Each bank is exactly 0x400 bytes large.
@@ -111,11 +152,21 @@ protected:
         bool read_only;
         bool mapped;
 
+        // Banks are stored as a page index within the mapper memory followed by their
+        // flags, which keeps the save states independent of the host `size_t`.
         template<DumpOperation operation, typename T>
         constexpr void dump(T& buffer) {
-            cynes::dump<operation>(buffer, offset);
-            cynes::dump<operation>(buffer, read_only);
-            cynes::dump<operation>(buffer, mapped);
+            uint16_t page = static_cast<uint16_t>(offset >> 10);
+            uint8_t flags = (read_only ? 0x01 : 0x00) | (mapped ? 0x02 : 0x00);
+
+            cynes::dump<operation>(buffer, page);
+            cynes::dump<operation>(buffer, flags);
+
+            if constexpr (operation == DumpOperation::LOAD) {
+                offset = static_cast<size_t>(page) << 10;
+                read_only = flags & 0x01;
+                mapped = flags & 0x02;
+            }
         }
     };
 
@@ -128,6 +179,8 @@ protected:
     const uint8_t _banks_cpu_ram;
     const uint8_t _banks_ppu_ram;
 
+    bool _watch_ppu;
+
 private:
     const size_t _size_prg;
     const size_t _size_chr;
@@ -135,11 +188,22 @@ private:
     const size_t _size_ppu_ram;
     const bool _read_only_chr;
 
+    // Read only memory shared with the other instances, the banks offsets beyond
+    // `_size_rom` point into the instance memory (CHR-RAM, CPU RAM, PPU RAM).
+    const std::shared_ptr<const Cartridge> _cartridge;
+    const uint8_t* const _memory_rom;
+    const size_t _size_rom;
+
     std::unique_ptr<uint8_t[]> _memory;
+    BlockSet _dirty_blocks;
 
     std::array<MemoryBank, 0x40> _banks_cpu;
     std::array<MemoryBank, 0x10> _banks_ppu;
 
+    // Flat page tables mirroring the banks, used by the memory bus fast paths.
+    std::array<const uint8_t*, 0x40> _pages_cpu;
+    std::array<const uint8_t*, 0x10> _pages_ppu;
+
 protected:
     void map_bank_prg(uint8_t page, uint16_t address);
     void map_bank_prg(uint8_t page, uint8_t size, uint16_t address);
@@ -161,9 +225,52 @@ protected:
     void mirror_cpu_banks(uint8_t page, uint8_t size, uint8_t mirror);
     void mirror_ppu_banks(uint8_t page, uint8_t size, uint8_t mirror);
 
+    /// Dump the registers specific to the mapper implementation.
+    /// @note `Mapper::dump` is not virtual, the mapper implementations hook their own
+    /// registers into the save states through these functions.
+    virtual void size_registers(unsigned int& buffer_size);
+    virtual void save_registers(uint8_t*& buffer);
+    virtual void load_registers(uint8_t*& buffer);
+    virtual void hash_registers(Hasher& hasher);
+
+private:
+    inline const uint8_t* get_page(const MemoryBank& bank) const {
+        if (!bank.mapped) {
+            return nullptr;
+        }
+
+        return bank.offset < _size_rom
+            ? _memory_rom + bank.offset
+            : _memory.get() + bank.offset - _size_rom;
+    }
+
+    void update_pages();
+
+    inline size_t get_size_chr_ram() const {
+        return _read_only_chr ? 0x00 : _size_chr;
+    }
+
 public:
     template<DumpOperation operation, typename T>
     constexpr void dump(T& buffer) {
+        dump_registers<operation>(buffer);
+
+        if (!_read_only_chr) {
+            cynes::dump<operation>(buffer, _memory.get(), _size_chr);
+        }
+
+        if (_size_cpu_ram) {
+            cynes::dump<operation>(buffer, _memory.get() + get_size_chr_ram(), _size_cpu_ram);
+        }
+
+        if (_size_ppu_ram) {
+            cynes::dump<operation>(buffer, _memory.get() + get_size_chr_ram() + _size_cpu_ram, _size_ppu_ram);
+        }
+    }
+
+    /// Dump the bank mapping and the mapper registers, without the memory content.
+    template<DumpOperation operation, typename T>
+    constexpr void dump_registers(T& buffer) {
         for (uint8_t k = 0x00; k < 0x40; k++) {
             _banks_cpu[k].dump<operation>(buffer);
         }
@@ -172,16 +279,18 @@ public:
             _banks_ppu[k].dump<operation>(buffer);
         }
 
-        if (!_read_only_chr) {
-            cynes::dump<operation>(buffer, _memory.get() + _size_prg, _size_chr);
-        }
-
-        if (_size_cpu_ram) {
-            cynes::dump<operation>(buffer, _memory.get() + _size_prg + _size_chr, _size_cpu_ram);
+        if constexpr (operation == DumpOperation::LOAD) {
+            update_pages();
         }
 
-        if (_size_ppu_ram) {
-            cynes::dump<operation>(buffer, _memory.get() + _size_prg + _size_chr + _size_cpu_ram, _size_ppu_ram);
+        if constexpr (operation == DumpOperation::SIZE) {
+            size_registers(buffer);
+        } else if constexpr (operation == DumpOperation::DUMP) {
+            save_registers(buffer);
+        } else if constexpr (operation == DumpOperation::LOAD) {
+            load_registers(buffer);
+        } else if constexpr (operation == DumpOperation::HASH) {
+            hash_registers(buffer);
         }
     }
 };
@@ -190,7 +299,7 @@ public:
 /// NROM mapper (see https://www.nesdev.org/wiki/NROM).
 class NROM : public Mapper {
 public:
-    NROM(NES& nes, const ParsedMemory& metadata, MirroringMode mode);
+    NROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode);
     ~NROM() = default;
 };
 
@@ -198,7 +307,7 @@ public:
 /// MMC1 mapper (see https://www.nesdev.org/wiki/MMC1).
 class MMC1 : public Mapper {
 public:
-    MMC1(NES& nes, const ParsedMemory& metadata, MirroringMode mode);
+    MMC1(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode);
     ~MMC1() = default;
 
 public:
@@ -222,11 +331,26 @@ private:
     uint8_t _register;
     uint8_t _counter;
 
-public:
-    template<DumpOperation operation, typename T>
-    constexpr void dump(T& buffer) {
-        Mapper::dump<operation>(buffer);
+protected:
+    virtual void size_registers(unsigned int& buffer_size) override {
+        dump_fields<DumpOperation::SIZE>(buffer_size);
+    }
+
+    virtual void save_registers(uint8_t*& buffer) override {
+        dump_fields<DumpOperation::DUMP>(buffer);
+    }
+
+    virtual void load_registers(uint8_t*& buffer) override {
+        dump_fields<DumpOperation::LOAD>(buffer);
+    }
 
+    virtual void hash_registers(Hasher& hasher) override {
+        dump_fields<DumpOperation::HASH>(hasher);
+    }
+
+private:
+    template<DumpOperation operation, typename T>
+    constexpr void dump_fields(T& buffer) {
         cynes::dump<operation>(buffer, _tick);
         cynes::dump<operation>(buffer, _registers);
         cynes::dump<operation>(buffer, _register);
@@ -238,7 +362,7 @@ public:
 /// UxROM mapper (see https://www.nesdev.org/wiki/UxROM).
 class UxROM : public Mapper {
 public:
-    UxROM(NES& nes, const ParsedMemory& metadata, MirroringMode mode);
+    UxROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode);
     ~UxROM() = default;
 
 public:
@@ -254,7 +378,7 @@ public:
 /// CNROM mapper (see https://www.nesdev.org/wiki/CNROM).
 class CNROM : public Mapper {
 public:
-    CNROM(NES& nes, const ParsedMemory& metadata, MirroringMode mode);
+    CNROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode);
     ~CNROM() = default;
 
 public:
@@ -269,7 +393,7 @@ public:
 /// UNROM 512 mapper (see https://www.nesdev.org/wiki/UNROM_512).
 class UNROM512 : public Mapper {
 public:
-    UNROM512(NES& nes, const ParsedMemory& metadata, MirroringMode mode);
+    UNROM512(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode);
     ~UNROM512() = default;
 
 public:
@@ -282,13 +406,17 @@ public:
 /// MMC3 mapper (see https://www.nesdev.org/wiki/MMC3).
 class MMC3 : public Mapper {
 public:
-    MMC3(NES& nes, const ParsedMemory& metadata, MirroringMode mode);
+    MMC3(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode);
     ~MMC3() = default;
 
 public:
     /// Tick the mapper.
     virtual void tick();
 
+    /// Get the minimum number of PPU dots before the mapper can raise its interrupt.
+    /// @return A lower bound of the number of PPU dots before the next interrupt.
+    virtual unsigned int get_interrupt_distance() const;
+
     /// Write to a CPU mapped memory bank.
     /// @note This function has other side effects than simply writing to the memory, it
     /// should not be used as a memory set function.
@@ -326,11 +454,26 @@ private:
     bool _enable_interrupt;
     bool _should_reload_interrupt;
 
-public:
-    template<DumpOperation operation, typename T>
-    constexpr void dump(T& buffer) {
-        Mapper::dump<operation>(buffer);
+protected:
+    virtual void size_registers(unsigned int& buffer_size) override {
+        dump_fields<DumpOperation::SIZE>(buffer_size);
+    }
+
+    virtual void save_registers(uint8_t*& buffer) override {
+        dump_fields<DumpOperation::DUMP>(buffer);
+    }
+
+    virtual void load_registers(uint8_t*& buffer) override {
+        dump_fields<DumpOperation::LOAD>(buffer);
+    }
+
+    virtual void hash_registers(Hasher& hasher) override {
+        dump_fields<DumpOperation::HASH>(hasher);
+    }
 
+private:
+    template<DumpOperation operation, typename T>
+    constexpr void dump_fields(T& buffer) {
         cynes::dump<operation>(buffer, _tick);
         cynes::dump<operation>(buffer, _registers);
         cynes::dump<operation>(buffer, _counter);
@@ -347,7 +490,7 @@ public:
 /// AxROM mapper (see https://www.nesdev.org/wiki/AxROM).
 class AxROM : public Mapper {
 public:
-    AxROM(NES& nes, const ParsedMemory& metadata);
+    AxROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge);
     ~AxROM() = default;
 
 public:
@@ -363,8 +506,10 @@ public:
 template<uint8_t BANK_SIZE>
 class MMC : public Mapper {
 public:
-    MMC(NES& nes, const ParsedMemory& metadata, MirroringMode mode) :
-        Mapper(nes, metadata, mode) {
+    MMC(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode) :
+        Mapper(nes, cartridge, mode) {
+        _watch_ppu = true;
+
         map_bank_chr(0x0, 0x8, 0x0);
 
         map_bank_prg(0x20, BANK_SIZE, 0x0);
@@ -447,11 +592,26 @@ private:
 
     uint8_t _selected_banks[0x4];
 
-public:
-    template<DumpOperation operation, typename T>
-    constexpr void dump(T& buffer) {
-        Mapper::dump<operation>(buffer);
+protected:
+    virtual void size_registers(unsigned int& buffer_size) override {
+        dump_fields<DumpOperation::SIZE>(buffer_size);
+    }
 
+    virtual void save_registers(uint8_t*& buffer) override {
+        dump_fields<DumpOperation::DUMP>(buffer);
+    }
+
+    virtual void load_registers(uint8_t*& buffer) override {
+        dump_fields<DumpOperation::LOAD>(buffer);
+    }
+
+    virtual void hash_registers(Hasher& hasher) override {
+        dump_fields<DumpOperation::HASH>(hasher);
+    }
+
+private:
+    template<DumpOperation operation, typename T>
+    constexpr void dump_fields(T& buffer) {
         cynes::dump<operation>(buffer, _latches);
         cynes::dump<operation>(buffer, _selected_banks);
     }
@@ -464,7 +624,7 @@ using MMC4 = MMC<0x10>;
 /// GxROM mapper (see https://www.nesdev.org/wiki/GxROM).
 class GxROM : public Mapper {
 public:
-    GxROM(NES& nes, const ParsedMemory& metadata, MirroringMode mode);
+    GxROM(NES& nes, const std::shared_ptr<const Cartridge>& cartridge, MirroringMode mode);
     ~GxROM() = default;
 
 public:
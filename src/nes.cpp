@@ -1,10 +1,20 @@
 #include "nes.hpp"
 
 #include "apu.hpp"
+#include "cartridge.hpp"
 #include "cpu.hpp"
 #include "ppu.hpp"
 #include "mapper.hpp"
 
+#include "compression.hpp"
+#include "hash.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
 
 constexpr uint8_t PALETTE_RAM_BOOT_VALUES[0x20] = {
     0x09, 0x01, 0x00, 0x01, 0x00, 0x02, 0x02, 0x0D,
@@ -13,32 +23,164 @@ constexpr uint8_t PALETTE_RAM_BOOT_VALUES[0x20] = {
     0x08, 0x3A, 0x00, 0x02, 0x00, 0x20, 0x2C, 0x08
 };
 
+// The console RAM is tracked as the first two snapshot blocks, followed by the blocks
+// of the mapper memory.
+constexpr size_t CPU_RAM_BLOCKS = 0x2;
+
+// "CYNS" once stored in little-endian.
+constexpr uint32_t STATE_MAGIC = 0x534E5943;
+
+// Bumped whenever the dumped layout changes, in the same change:
+// - 0x0001: initial header and little-endian layout;
+// - 0x0002: the APU registers and the DMC sample address, seeding the audio
+//   synthesizer (the synthesizer itself is never dumped).
+constexpr uint16_t STATE_VERSION = 0x0002;
+constexpr uint16_t STATE_FLAG_COMPRESSED = 0x0001;
+
+// "CYNP" once stored in little-endian.
+constexpr uint32_t SNAPSHOT_MAGIC = 0x504E5943;
+
+
+namespace {
+/// Fixed header placed at the start of every save state.
+struct StateHeader {
+public:
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint16_t mapper_index;
+    uint16_t reserved;
+    uint32_t payload_size;
+    uint64_t rom_hash;
+
+    template<cynes::DumpOperation operation, typename T>
+    constexpr void dump(T& buffer) {
+        cynes::dump<operation>(buffer, magic);
+        cynes::dump<operation>(buffer, version);
+        cynes::dump<operation>(buffer, flags);
+        cynes::dump<operation>(buffer, mapper_index);
+        cynes::dump<operation>(buffer, reserved);
+        cynes::dump<operation>(buffer, payload_size);
+        cynes::dump<operation>(buffer, rom_hash);
+    }
+};
+
+unsigned int get_header_size() {
+    unsigned int buffer_size = 0;
+    StateHeader{}.dump<cynes::DumpOperation::SIZE>(buffer_size);
+
+    return buffer_size;
+}
+
+const unsigned int STATE_HEADER_SIZE = get_header_size();
+
+/// Fixed header placed at the start of every incremental snapshot.
+struct SnapshotHeader {
+public:
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t block_count;
+    uint64_t base_id;
+    uint64_t rom_hash;
+
+    template<cynes::DumpOperation operation, typename T>
+    constexpr void dump(T& buffer) {
+        cynes::dump<operation>(buffer, magic);
+        cynes::dump<operation>(buffer, version);
+        cynes::dump<operation>(buffer, reserved);
+        cynes::dump<operation>(buffer, block_count);
+        cynes::dump<operation>(buffer, base_id);
+        cynes::dump<operation>(buffer, rom_hash);
+    }
+};
+
+unsigned int get_snapshot_header_size() {
+    unsigned int buffer_size = 0;
+    SnapshotHeader{}.dump<cynes::DumpOperation::SIZE>(buffer_size);
+
+    return buffer_size;
+}
+
+const unsigned int SNAPSHOT_HEADER_SIZE = get_snapshot_header_size();
+
+// Snapshot bases are numbered across every emulator of the process, so that a snapshot
+// is only accepted by the emulator holding its base.
+std::atomic<uint64_t> next_snapshot_base_id{1};
+
+bool is_condition_met(const cynes::DoneCondition& condition, uint8_t value) {
+    value &= condition.mask;
+
+    switch (condition.comparison) {
+    case cynes::Comparison::EQUAL: return value == condition.value;
+    case cynes::Comparison::NOT_EQUAL: return value != condition.value;
+    case cynes::Comparison::LESS: return value < condition.value;
+    case cynes::Comparison::GREATER: return value > condition.value;
+    }
+
+    return false;
+}
+}
+
 
 cynes::NES::NES(const char* path)
+    : NES{Cartridge::load(path)} {}
+
+cynes::NES::NES(const std::shared_ptr<const Cartridge>& cartridge)
+    : NES{cartridge, true} {}
+
+cynes::NES::NES(NES& source)
+    : NES{source._mapper->get_shared_cartridge(), false}
+{
+    copy_state(source);
+}
+
+// The mapper RAM is not filled by copies, its content is overwritten right away.
+cynes::NES::NES(const std::shared_ptr<const Cartridge>& cartridge, bool fill_memory)
     : cpu{*this}
     , ppu{*this}
     , apu{*this}
-    , _mapper{Mapper::load_mapper(static_cast<NES&>(*this), path)}
-    , _memory_cpu{new uint8_t[0x800]}
-    , _memory_oam{new uint8_t[0x100]}
-    , _memory_palette{new uint8_t[0x20]}
+    , counters{}
+    , _mapper{Mapper::load_mapper(static_cast<NES&>(*this), cartridge)}
+    , _open_bus{0x00}
+    , _ppu_pending_dots{0}
+    , _ppu_deadline{0}
+    , _ppu_synced_dots{0}
+    , _idle_cycle_budget{std::numeric_limits<unsigned int>::max()}
+    , _idle_instruction_budget{std::numeric_limits<unsigned int>::max()}
+    , _idle_instructions{0}
+    , _watch_pages{0}
+    , _watch_changed{false}
+    , _done_condition_pages{0}
+    , _done{false}
+    , _dirty_blocks{CPU_RAM_BLOCKS}
+    , _snapshot_base{nullptr}
+    , _snapshot_base_id{0}
 {
+    if (fill_memory) {
+        _mapper->power();
+    }
+
     cpu.power();
     ppu.power();
     apu.power();
 
-    std::memcpy(_memory_palette.get(), PALETTE_RAM_BOOT_VALUES, 0x20);
-    std::memset(_memory_cpu.get(), 0x00, 0x800);
-    std::memset(_memory_oam.get(), 0x00, 0x100);
+    std::memcpy(_memory_palette, PALETTE_RAM_BOOT_VALUES, 0x20);
+    std::memset(_memory_cpu, 0x00, 0x800);
+    std::memset(_memory_oam, 0x00, 0x100);
     std::memset(_controller_status, 0x00, 0x2);
     std::memset(_controller_shifters, 0x00, 0x2);
 
     for (int i = 0; i < 8; i++) {
         dummy_read();
     }
+
+    sync_ppu();
 }
 
 void cynes::NES::reset() {
+    _ppu_deadline = 0;
+
     cpu.reset();
     ppu.reset();
     apu.reset();
@@ -46,24 +188,40 @@ void cynes::NES::reset() {
     for (int i = 0; i < 8; i++) {
         dummy_read();
     }
+
+    sync_ppu();
+
+    apu.synchronize_audio();
 }
 
 void cynes::NES::dummy_read() {
+    CYNES_PROFILE_COUNT(counters.cpu_cycles, 1);
+
     apu.tick(true);
-    ppu.tick();
-    ppu.tick();
-    ppu.tick();
+    clock_ppu(3);
     cpu.poll();
 }
 
+void cynes::NES::sync_ppu() {
+    CYNES_PROFILE_TIME(counters.ppu_time);
+    CYNES_PROFILE_COUNT(counters.ppu_dots, _ppu_pending_dots);
+
+    ppu.run(_ppu_pending_dots);
+
+    _ppu_synced_dots += _ppu_pending_dots;
+    _ppu_pending_dots = 0;
+    _ppu_deadline = ppu.get_event_distance();
+}
+
 void cynes::NES::write(uint16_t address, uint8_t value) {
+    CYNES_PROFILE_COUNT(counters.cpu_cycles, 1);
+
     apu.tick(false);
-    ppu.tick();
-    ppu.tick();
+    clock_ppu(2);
 
     write_cpu(address, value);
 
-    ppu.tick();
+    clock_ppu(1);
     cpu.poll();
 }
 
@@ -71,15 +229,45 @@ void cynes::NES::write_cpu(uint16_t address, uint8_t value) {
     _open_bus = value;
 
     if (address < 0x2000) {
+        if (_watch_pages & (1ULL << ((address & 0x7FF) >> 10))) {
+            check_watch_change(address & 0x7FF, _memory_cpu[address & 0x7FF], value);
+        }
+
         _memory_cpu[address & 0x7FF] = value;
+        _dirty_blocks.insert((address & 0x7FF) >> 10);
+
+        if (_done_condition_pages & (1ULL << ((address & 0x7FF) >> 10))) {
+            check_done_conditions(address & 0x7FF, value);
+        }
     } else if (address < 0x4000) {
+        sync_ppu();
         ppu.write(address & 0x7, value);
+
+        // The register write may move the next PPU event.
+        _ppu_deadline = ppu.get_event_distance();
     } else if (address == 0x4016) {
         load_controller_shifter(~value & 0x01);
     } else if (address < 0x4018) {
         apu.write(address & 0xFF, value);
     } else {
+        CYNES_PROFILE_COUNT(counters.mapper_writes, 1);
+
+        const bool watched = _watch_pages & (1ULL << (address >> 10));
+        const uint8_t previous = watched ? peek_cpu(address) : 0x00;
+
+        sync_ppu();
         _mapper->write_cpu(address, value);
+
+        // The mapper write may move the next PPU event.
+        _ppu_deadline = ppu.get_event_distance();
+
+        if (watched) {
+            check_watch_change(address, previous, peek_cpu(address));
+        }
+
+        if (_done_condition_pages & (1ULL << (address >> 10))) {
+            check_done_conditions(address, peek_cpu(address));
+        }
     }
 }
 
@@ -109,44 +297,111 @@ void cynes::NES::write_oam(uint8_t address, uint8_t value) {
     _memory_oam[address] = value;
 }
 
+unsigned int cynes::NES::get_idle_distance(bool status) const {
+    unsigned int dots = _ppu_deadline;
+
+    if (status) {
+        dots = std::min(dots, ppu.get_status_distance());
+    }
+
+    dots = dots > _ppu_pending_dots ? dots - _ppu_pending_dots - 1 : 0;
+
+    return std::min({dots / 3, apu.get_event_distance(), _idle_cycle_budget});
+}
+
+void cynes::NES::skip_idle_cycles(unsigned int cycles, unsigned int instructions) {
+    CYNES_PROFILE_COUNT(counters.cpu_cycles, cycles);
+    CYNES_PROFILE_COUNT(counters.idle_cycles, cycles);
+    CYNES_PROFILE_COUNT(counters.cpu_instructions, instructions);
+
+    apu.skip(cycles);
+
+    _ppu_pending_dots += cycles * 3;
+    _idle_instructions += instructions;
+}
+
+bool cynes::NES::transfer_oam(uint8_t page, unsigned int cycles) {
+    sync_ppu();
+
+    if (cycles * 3 >= _ppu_deadline || !ppu.can_transfer_oam(cycles * 3)) {
+        return false;
+    }
+
+    const uint8_t* source = _memory_cpu + ((page << 8) & 0x7FF);
+
+    ppu.transfer_oam(source);
+
+    CYNES_PROFILE_COUNT(counters.cpu_cycles, cycles);
+
+    _open_bus = source[0xFF];
+    _ppu_pending_dots = cycles * 3;
+
+    // The interrupt lines do not change during the transfer, polling them twice has the
+    // same effect as polling them on every cycle.
+    cpu.poll();
+    cpu.poll();
+
+    return true;
+}
+
 uint8_t cynes::NES::read(uint16_t address) {
+    CYNES_PROFILE_COUNT(counters.cpu_cycles, 1);
+
     apu.tick(true);
-    ppu.tick();
-    ppu.tick();
+    clock_ppu(2);
 
     _open_bus = read_cpu(address);
 
-    ppu.tick();
+    clock_ppu(1);
     cpu.poll();
 
     return _open_bus;
 }
 
 const uint8_t* cynes::NES::get_ram_pointer() const {
-    return reinterpret_cast<const uint8_t*>(_memory_cpu.get());
+    return _memory_cpu;
 }
 
 uint8_t cynes::NES::read_cpu(uint16_t address) {
     if (address < 0x2000) {
         return _memory_cpu[address & 0x7FF];
     } else if (address < 0x4000) {
-        return ppu.read(address & 0x7);
+        sync_ppu();
+
+        uint8_t value = ppu.read(address & 0x7);
+
+        // The register read may move the next PPU event.
+        _ppu_deadline = ppu.get_event_distance();
+
+        return value;
     } else if (address == 0x4016) {
         return poll_controller(0x0);
     } else if (address == 0x4017) {
         return poll_controller(0x1);
     } else if (address < 0x4018) {
         return apu.read(address & 0xFF);
-    } else {
-        return _mapper->read_cpu(address);
     }
+
+    const uint8_t* page = _mapper->get_page_cpu(address);
+
+    if (page == nullptr) {
+        return _open_bus;
+    }
+
+    return page[address & 0x3FF];
 }
 
 uint8_t cynes::NES::read_ppu(uint16_t address) {
     address &= 0x3FFF;
 
     if (address < 0x3F00) {
-        return _mapper->read_ppu(address);
+        if (_mapper->is_watching_ppu()) {
+            return _mapper->read_ppu(address);
+        }
+
+        const uint8_t* page = _mapper->get_page_ppu(address);
+
+        return page == nullptr ? 0x00 : page[address & 0x3FF];
     } else {
         address &= 0x1F;
 
@@ -172,36 +427,526 @@ uint8_t cynes::NES::get_open_bus() const {
     return _open_bus;
 }
 
-bool cynes::NES::step(uint16_t controllers, unsigned int frames) {
+bool cynes::NES::step(uint16_t controllers, unsigned int frames, RenderPolicy policy) {
+    CYNES_PROFILE_TIME(counters.step_time);
+
     _controller_status[0x0] = controllers & 0xFF;
     _controller_status[0x1] = controllers >> 8;
 
+    _done = false;
+
     for (unsigned int k = 0; k < frames; k++) {
+        ppu.set_frame_skip(
+            policy == RenderPolicy::NONE || (policy == RenderPolicy::LAST && k + 1 < frames)
+        );
+
         while (!ppu.is_frame_ready()) {
             cpu.tick();
 
             if (cpu.is_frozen()) {
+                sync_ppu();
+                ppu.set_frame_skip(false);
                 return true;
             }
         }
+
+        end_frame();
+
+        if (_done) {
+            break;
+        }
     }
 
+    sync_ppu();
+    ppu.set_frame_skip(false);
+
     return false;
 }
 
+cynes::StepResult cynes::NES::step_until(
+    uint16_t controllers,
+    unsigned int frames,
+    const StepOptions& options,
+    RenderPolicy policy
+) {
+    CYNES_PROFILE_TIME(counters.step_time);
+
+    using Clock = std::chrono::steady_clock;
+
+    _controller_status[0x0] = controllers & 0xFF;
+    _controller_status[0x1] = controllers >> 8;
+
+    _done = false;
+    _watch_changed = false;
+
+    StepResult result{StopReason::FRAMES, 0, 0, 0};
+
+    const uint64_t first_dot = _ppu_synced_dots + _ppu_pending_dots;
+    const uint64_t last_dot = first_dot + options.max_cycles * 3;
+
+    const Clock::time_point deadline = Clock::now()
+        + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.max_seconds));
+
+    // The instructions skipped by the idle loops are counted apart from the ones run.
+    uint64_t ticks = 0;
+    _idle_instructions = 0;
+
+    for (unsigned int k = 0; k < frames && result.reason == StopReason::FRAMES; k++) {
+        ppu.set_frame_skip(
+            policy == RenderPolicy::NONE || (policy == RenderPolicy::LAST && k + 1 < frames)
+        );
+
+        bool frame_ready = false;
+
+        while (!frame_ready && result.reason == StopReason::FRAMES) {
+            // An idle loop cannot skip past the cycle or instruction limits.
+            if (options.max_cycles > 0) {
+                const uint64_t dot = _ppu_synced_dots + _ppu_pending_dots;
+
+                _idle_cycle_budget = static_cast<unsigned int>(std::min<uint64_t>(
+                    dot < last_dot ? (last_dot - dot) / 3 : 0,
+                    std::numeric_limits<unsigned int>::max()
+                ));
+            }
+
+            if (options.max_instructions > 0) {
+                _idle_instruction_budget = static_cast<unsigned int>(std::min<uint64_t>(
+                    options.max_instructions - result.instructions - 1,
+                    std::numeric_limits<unsigned int>::max()
+                ));
+            }
+
+            cpu.tick();
+            ticks++;
+
+            result.instructions = ticks + _idle_instructions;
+
+            if (cpu.is_frozen()) {
+                result.reason = StopReason::CRASHED;
+                break;
+            }
+
+            frame_ready = ppu.is_frame_ready();
+
+            if (options.max_instructions > 0 && result.instructions >= options.max_instructions) {
+                result.reason = StopReason::INSTRUCTIONS;
+            } else if (options.max_cycles > 0 && _ppu_synced_dots + _ppu_pending_dots >= last_dot) {
+                result.reason = StopReason::CYCLES;
+            } else if (
+                !options.breakpoints.empty()
+                && std::find(
+                    options.breakpoints.begin(),
+                    options.breakpoints.end(),
+                    cpu.get_program_counter()
+                ) != options.breakpoints.end()
+            ) {
+                result.reason = StopReason::BREAKPOINT;
+            } else if (options.stop_on_watch_change && _watch_changed) {
+                result.reason = StopReason::WATCH;
+            } else if (options.max_seconds > 0.0 && (ticks & 0xFF) == 0 && Clock::now() >= deadline) {
+                // The clock is only read every 256 instructions.
+                result.reason = StopReason::TIME;
+            }
+        }
+
+        if (frame_ready) {
+            result.frames++;
+            end_frame();
+
+            if (_done && result.reason == StopReason::FRAMES) {
+                result.reason = StopReason::DONE;
+            }
+        }
+    }
+
+    sync_ppu();
+    ppu.set_frame_skip(false);
+
+    _idle_cycle_budget = std::numeric_limits<unsigned int>::max();
+    _idle_instruction_budget = std::numeric_limits<unsigned int>::max();
+
+    result.cycles = (_ppu_synced_dots - first_dot) / 3;
+
+    return result;
+}
+
+void cynes::NES::end_frame() {
+    CYNES_PROFILE_COUNT(counters.frames, 1);
+
+    apu.end_frame();
+
+    update_watch_values();
+    check_done_conditions();
+}
+
+void cynes::NES::set_watch_list(const std::vector<uint16_t>& addresses) {
+    for (uint16_t address : addresses) {
+        if (address >= 0x2000 && address < 0x4020) {
+            throw std::invalid_argument("The I/O registers cannot be watched.");
+        }
+    }
+
+    _watch_addresses = addresses;
+    _watch_values.resize(addresses.size());
+    _watch_pages = 0;
+
+    for (uint16_t address : addresses) {
+        _watch_pages |= 1ULL << ((address < 0x2000 ? address & 0x7FF : address) >> 10);
+    }
+
+    update_watch_values();
+}
+
+void cynes::NES::add_done_condition(const DoneCondition& condition) {
+    if (condition.address >= 0x2000 && condition.address < 0x4020) {
+        throw std::invalid_argument("The I/O registers cannot be watched.");
+    }
+
+    DoneCondition mirrored = condition;
+
+    if (mirrored.address < 0x2000) {
+        mirrored.address &= 0x7FF;
+    }
+
+    _done_conditions.push_back(mirrored);
+    _done_condition_pages |= 1ULL << (mirrored.address >> 10);
+}
+
+void cynes::NES::clear_done_conditions() {
+    _done_conditions.clear();
+    _done_condition_pages = 0;
+}
+
 unsigned int cynes::NES::size() {
-    unsigned int buffer_size = 0;
+    unsigned int buffer_size = STATE_HEADER_SIZE;
     dump<DumpOperation::SIZE>(buffer_size);
 
     return buffer_size;
 }
 
+unsigned int cynes::NES::compressed_size_bound() {
+    return STATE_HEADER_SIZE + static_cast<unsigned int>(
+        compression::compress_bound(size() - STATE_HEADER_SIZE)
+    );
+}
+
 void cynes::NES::save(uint8_t* buffer) {
+    StateHeader header{
+        STATE_MAGIC,
+        STATE_VERSION,
+        0x0000,
+        _mapper->get_cartridge().get_mapper_index(),
+        0x0000,
+        size() - STATE_HEADER_SIZE,
+        _mapper->get_cartridge().get_hash()
+    };
+
+    header.dump<DumpOperation::DUMP>(buffer);
     dump<DumpOperation::DUMP>(buffer);
 }
 
-void cynes::NES::load(uint8_t* buffer) {
+unsigned int cynes::NES::save_compressed(uint8_t* buffer) {
+    const unsigned int payload_size = size() - STATE_HEADER_SIZE;
+
+    if (!_state_buffer) {
+        _state_buffer.reset(new uint8_t[payload_size]);
+    }
+
+    uint8_t* payload = _state_buffer.get();
+    dump<DumpOperation::DUMP>(payload);
+
+    StateHeader header{
+        STATE_MAGIC,
+        STATE_VERSION,
+        STATE_FLAG_COMPRESSED,
+        _mapper->get_cartridge().get_mapper_index(),
+        0x0000,
+        payload_size,
+        _mapper->get_cartridge().get_hash()
+    };
+
+    header.dump<DumpOperation::DUMP>(buffer);
+
+    return STATE_HEADER_SIZE + static_cast<unsigned int>(
+        compression::compress(_state_buffer.get(), payload_size, buffer)
+    );
+}
+
+std::unique_ptr<cynes::NES> cynes::NES::clone() {
+    return std::unique_ptr<NES>{new NES{*this}};
+}
+
+void cynes::NES::copy_state(NES& source, bool frame) {
+    if (
+        source._mapper->get_cartridge().get_mapper_index() != _mapper->get_cartridge().get_mapper_index()
+        || source._mapper->get_cartridge().get_hash() != _mapper->get_cartridge().get_hash()
+    ) {
+        throw std::invalid_argument("The emulators should be created from the same ROM.");
+    }
+
+    if (&source == this) {
+        return;
+    }
+
+    std::memcpy(_memory_cpu, source._memory_cpu, 0x800);
+    std::memcpy(_mapper->get_memory(), source._mapper->get_memory(), _mapper->get_size_memory());
+
+    // The registers are small and spread over the components, they go through the
+    // dump functions rather than duplicating their lists.
+    if (!_state_buffer) {
+        _state_buffer.reset(new uint8_t[size() - STATE_HEADER_SIZE]);
+    }
+
+    uint8_t* registers = _state_buffer.get();
+    source.dump_registers<DumpOperation::DUMP>(registers);
+
+    registers = _state_buffer.get();
+    dump_registers<DumpOperation::LOAD>(registers);
+
+    if (frame) {
+        ppu.copy_frame(source.ppu);
+    }
+
+    _open_bus = source._open_bus;
+    _ppu_pending_dots = source._ppu_pending_dots;
+    _ppu_deadline = 0;
+
+    _watch_addresses = source._watch_addresses;
+    _watch_values = source._watch_values;
+    _watch_pages = source._watch_pages;
+    _done_conditions = source._done_conditions;
+    _done_condition_pages = source._done_condition_pages;
+    _done = source._done;
+
+    cpu.set_idle_loop_skip(source.cpu.get_idle_loop_skip());
+
+    apu.synchronize_audio();
+
+    // The whole memory may differ from the snapshot base.
+    _dirty_blocks.fill();
+    _mapper->get_dirty_blocks().fill();
+}
+
+const char* cynes::NES::check_state(uint8_t* buffer, unsigned int size) {
+    if (size < STATE_HEADER_SIZE) {
+        return "The save state buffer is too small.";
+    }
+
+    StateHeader header{};
+    header.dump<DumpOperation::LOAD>(buffer);
+
+    if (header.magic != STATE_MAGIC) {
+        return "The buffer is not a save state.";
+    }
+
+    if (header.version != STATE_VERSION) {
+        return "The save state version is not supported.";
+    }
+
+    if (
+        header.mapper_index != _mapper->get_cartridge().get_mapper_index()
+        || header.rom_hash != _mapper->get_cartridge().get_hash()
+    ) {
+        return "The save state was created from another ROM.";
+    }
+
+    const unsigned int payload_size = this->size() - STATE_HEADER_SIZE;
+
+    if (header.payload_size != payload_size) {
+        return "The save state size does not match the emulator.";
+    }
+
+    if (!(header.flags & STATE_FLAG_COMPRESSED) && size != STATE_HEADER_SIZE + payload_size) {
+        return "The save state size does not match the emulator.";
+    }
+
+    return nullptr;
+}
+
+void cynes::NES::load(uint8_t* buffer, unsigned int size) {
+    if (const char* error = check_state(buffer, size)) {
+        throw std::invalid_argument(error);
+    }
+
+    StateHeader header{};
+    header.dump<DumpOperation::LOAD>(buffer);
+
+    const unsigned int payload_size = this->size() - STATE_HEADER_SIZE;
+
+    if (header.flags & STATE_FLAG_COMPRESSED) {
+        if (!_state_buffer) {
+            _state_buffer.reset(new uint8_t[payload_size]);
+        }
+
+        size_t written = compression::decompress(
+            buffer,
+            size - STATE_HEADER_SIZE,
+            _state_buffer.get(),
+            payload_size
+        );
+
+        if (written != payload_size) {
+            throw std::invalid_argument("The save state size does not match the emulator.");
+        }
+
+        buffer = _state_buffer.get();
+    }
+
     dump<DumpOperation::LOAD>(buffer);
+
+    _ppu_deadline = 0;
+
+    apu.synchronize_audio();
+
+    // The whole memory may differ from the snapshot base.
+    _dirty_blocks.fill();
+    _mapper->get_dirty_blocks().fill();
+}
+
+uint64_t cynes::NES::state_hash() {
+    Hasher hasher{};
+    dump<DumpOperation::HASH>(hasher);
+
+    return hasher.digest();
+}
+
+uint64_t cynes::NES::ram_hash() const {
+    Hasher hasher{};
+    hasher.update(_memory_cpu, 0x800);
+    hasher.update(_mapper->get_cpu_ram(), _mapper->get_size_cpu_ram());
+
+    return hasher.digest();
+}
+
+void cynes::NES::set_snapshot_base() {
+    const size_t blocks = get_memory_blocks();
+
+    if (!_snapshot_base) {
+        _snapshot_base.reset(new uint8_t[blocks << 10]);
+    }
+
+    for (size_t index = 0; index < blocks; index++) {
+        std::memcpy(_snapshot_base.get() + (index << 10), get_memory_block(index), 0x400);
+    }
+
+    _snapshot_base_id = next_snapshot_base_id.fetch_add(1, std::memory_order_relaxed);
+
+    _dirty_blocks.clear();
+    _mapper->get_dirty_blocks().clear();
+}
+
+unsigned int cynes::NES::snapshot_size() {
+    unsigned int buffer_size = SNAPSHOT_HEADER_SIZE;
+    dump_registers<DumpOperation::SIZE>(buffer_size);
+
+    size_t blocks = _dirty_blocks.count() + _mapper->get_dirty_blocks().count();
+
+    return buffer_size + blocks * (sizeof(uint32_t) + 0x400);
+}
+
+unsigned int cynes::NES::save_snapshot(uint8_t* buffer) {
+    if (!_snapshot_base) {
+        throw std::runtime_error("The snapshot base has not been set.");
+    }
+
+    uint8_t* start = buffer;
+
+    SnapshotHeader header{
+        SNAPSHOT_MAGIC,
+        STATE_VERSION,
+        0x0000,
+        static_cast<uint32_t>(_dirty_blocks.count() + _mapper->get_dirty_blocks().count()),
+        _snapshot_base_id,
+        _mapper->get_cartridge().get_hash()
+    };
+
+    header.dump<DumpOperation::DUMP>(buffer);
+    dump_registers<DumpOperation::DUMP>(buffer);
+
+    auto save_block = [&](size_t index) {
+        uint32_t block = static_cast<uint32_t>(index);
+
+        cynes::dump<DumpOperation::DUMP>(buffer, block);
+        cynes::dump<DumpOperation::DUMP>(buffer, get_memory_block(index), 0x400);
+    };
+
+    _dirty_blocks.for_each(save_block);
+    _mapper->get_dirty_blocks().for_each([&](size_t index) {
+        save_block(CPU_RAM_BLOCKS + index);
+    });
+
+    return static_cast<unsigned int>(buffer - start);
+}
+
+void cynes::NES::load_snapshot(uint8_t* buffer, unsigned int size) {
+    if (!_snapshot_base) {
+        throw std::runtime_error("The snapshot base has not been set.");
+    }
+
+    unsigned int registers_size = 0;
+    dump_registers<DumpOperation::SIZE>(registers_size);
+
+    if (size < SNAPSHOT_HEADER_SIZE + registers_size) {
+        throw std::invalid_argument("The snapshot buffer is too small.");
+    }
+
+    SnapshotHeader header{};
+    header.dump<DumpOperation::LOAD>(buffer);
+
+    if (header.magic != SNAPSHOT_MAGIC) {
+        throw std::invalid_argument("The buffer is not a snapshot.");
+    }
+
+    if (header.version != STATE_VERSION) {
+        throw std::invalid_argument("The snapshot version is not supported.");
+    }
+
+    if (header.rom_hash != _mapper->get_cartridge().get_hash()) {
+        throw std::invalid_argument("The snapshot was created from another ROM.");
+    }
+
+    if (header.base_id != _snapshot_base_id) {
+        throw std::invalid_argument("The snapshot was taken from another snapshot base.");
+    }
+
+    const uint32_t count = header.block_count;
+    const size_t blocks = get_memory_blocks();
+    const uint8_t* blocks_pointer = buffer + registers_size;
+
+    if (count > blocks || size != SNAPSHOT_HEADER_SIZE + registers_size + count * (sizeof(uint32_t) + 0x400)) {
+        throw std::invalid_argument("The snapshot buffer size does not match its content.");
+    }
+
+    for (uint32_t k = 0; k < count; k++) {
+        uint32_t index = read_little_endian<uint32_t>(blocks_pointer + k * (sizeof(uint32_t) + 0x400));
+
+        if (index >= blocks) {
+            throw std::invalid_argument("The snapshot buffer references an invalid memory block.");
+        }
+    }
+
+    dump_registers<DumpOperation::LOAD>(buffer);
+
+    _ppu_deadline = 0;
+
+    // Blocks written since the base are first reverted, then the snapshot blocks are
+    // applied on top of the base.
+    restore_dirty_blocks();
+
+    for (uint32_t k = 0; k < count; k++) {
+        uint32_t index;
+
+        cynes::dump<DumpOperation::LOAD>(buffer, index);
+        cynes::dump<DumpOperation::LOAD>(buffer, get_memory_block(index), 0x400);
+
+        if (index < CPU_RAM_BLOCKS) {
+            _dirty_blocks.insert(index);
+        } else {
+            _mapper->get_dirty_blocks().insert(index - CPU_RAM_BLOCKS);
+        }
+    }
+
+    apu.synchronize_audio();
 }
 
 cynes::Mapper& cynes::NES::get_mapper() {
@@ -222,6 +967,80 @@ uint8_t cynes::NES::poll_controller(uint8_t player) {
     return (_open_bus & 0xE0) | value;
 }
 
+uint8_t cynes::NES::peek_cpu(uint16_t address) const {
+    if (address < 0x2000) {
+        return _memory_cpu[address & 0x7FF];
+    }
+
+    const uint8_t* page = _mapper->get_page_cpu(address);
+
+    if (page == nullptr) {
+        return _open_bus;
+    }
+
+    return page[address & 0x3FF];
+}
+
+void cynes::NES::update_watch_values() {
+    for (size_t k = 0; k < _watch_addresses.size(); k++) {
+        _watch_values[k] = peek_cpu(_watch_addresses[k]);
+    }
+}
+
+void cynes::NES::check_watch_change(uint16_t address, uint8_t previous, uint8_t value) {
+    if (previous == value) {
+        return;
+    }
+
+    for (uint16_t watched : _watch_addresses) {
+        if ((watched < 0x2000 ? watched & 0x7FF : watched) == address) {
+            _watch_changed = true;
+        }
+    }
+}
+
+void cynes::NES::check_done_conditions(uint16_t address, uint8_t value) {
+    for (const DoneCondition& condition : _done_conditions) {
+        if (condition.address == address && is_condition_met(condition, value)) {
+            _done = true;
+        }
+    }
+}
+
+void cynes::NES::check_done_conditions() {
+    for (const DoneCondition& condition : _done_conditions) {
+        if (is_condition_met(condition, peek_cpu(condition.address))) {
+            _done = true;
+        }
+    }
+}
+
+size_t cynes::NES::get_memory_blocks() const {
+    return CPU_RAM_BLOCKS + _mapper->get_memory_blocks();
+}
+
+uint8_t* cynes::NES::get_memory_block(size_t index) {
+    if (index < CPU_RAM_BLOCKS) {
+        return _memory_cpu + (index << 10);
+    }
+
+    return _mapper->get_memory() + ((index - CPU_RAM_BLOCKS) << 10);
+}
+
+void cynes::NES::restore_dirty_blocks() {
+    _dirty_blocks.for_each([this](size_t index) {
+        std::memcpy(get_memory_block(index), _snapshot_base.get() + (index << 10), 0x400);
+    });
+
+    _mapper->get_dirty_blocks().for_each([this](size_t index) {
+        index += CPU_RAM_BLOCKS;
+        std::memcpy(get_memory_block(index), _snapshot_base.get() + (index << 10), 0x400);
+    });
+
+    _dirty_blocks.clear();
+    _mapper->get_dirty_blocks().clear();
+}
+
 template<cynes::DumpOperation operation, typename T>
 void cynes::NES::dump(T& buffer) {
     cpu.dump<operation>(buffer);
@@ -230,9 +1049,24 @@ void cynes::NES::dump(T& buffer) {
 
     _mapper->dump<operation>(buffer);
 
-    cynes::dump<operation>(buffer, _memory_cpu.get(), 0x800);
-    cynes::dump<operation>(buffer, _memory_oam.get(), 0x100);
-    cynes::dump<operation>(buffer, _memory_palette.get(), 0x20);
+    cynes::dump<operation>(buffer, _memory_cpu, 0x800);
+    cynes::dump<operation>(buffer, _memory_oam, 0x100);
+    cynes::dump<operation>(buffer, _memory_palette, 0x20);
+
+    cynes::dump<operation>(buffer, _controller_status);
+    cynes::dump<operation>(buffer, _controller_shifters);
+}
+
+template<cynes::DumpOperation operation, typename T>
+void cynes::NES::dump_registers(T& buffer) {
+    cpu.dump<operation>(buffer);
+    ppu.dump<operation>(buffer);
+    apu.dump<operation>(buffer);
+
+    _mapper->dump_registers<operation>(buffer);
+
+    cynes::dump<operation>(buffer, _memory_oam, 0x100);
+    cynes::dump<operation>(buffer, _memory_palette, 0x20);
 
     cynes::dump<operation>(buffer, _controller_status);
     cynes::dump<operation>(buffer, _controller_shifters);
@@ -241,3 +1075,7 @@ void cynes::NES::dump(T& buffer) {
 template void cynes::NES::dump<cynes::DumpOperation::SIZE>(unsigned int&);
 template void cynes::NES::dump<cynes::DumpOperation::DUMP>(uint8_t*&);
 template void cynes::NES::dump<cynes::DumpOperation::LOAD>(uint8_t*&);
+
+template void cynes::NES::dump_registers<cynes::DumpOperation::SIZE>(unsigned int&);
+template void cynes::NES::dump_registers<cynes::DumpOperation::DUMP>(uint8_t*&);
+template void cynes::NES::dump_registers<cynes::DumpOperation::LOAD>(uint8_t*&);
@@ -3,8 +3,11 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "apu.hpp"
+#include "cartridge.hpp"
+#include "counters.hpp"
 #include "cpu.hpp"
 #include "ppu.hpp"
 #include "mapper.hpp"
@@ -12,14 +15,89 @@
 #include "utils.hpp"
 
 namespace cynes {
+/// Frame buffer composition policy used when stepping the emulation.
+/// @note Skipped frames are still fully emulated, only the pixels are not written.
+enum class RenderPolicy : uint8_t {
+    ALL, LAST, NONE
+};
+
+/// Comparison between a watched byte and the value of a done condition.
+enum class Comparison : uint8_t {
+    EQUAL, NOT_EQUAL, LESS, GREATER
+};
+
+/// Condition on a byte of the console memory ending a step early.
+struct DoneCondition {
+    /// Address of the byte, in the console RAM or in the mapper address space.
+    uint16_t address;
+
+    /// Comparison between the masked byte and the value.
+    Comparison comparison;
+
+    /// Value compared against.
+    uint8_t value;
+
+    /// Mask applied to the byte before the comparison.
+    uint8_t mask;
+};
+
+/// Reason for which a step ended.
+enum class StopReason : uint8_t {
+    FRAMES, CRASHED, DONE, INSTRUCTIONS, CYCLES, BREAKPOINT, WATCH, TIME
+};
+
+/// Conditions ending a step before the end of its frames, see `NES::step_until`.
+/// @note Zero limits and empty breakpoint lists are disabled.
+struct StepOptions {
+    /// Maximum number of CPU instructions, interrupt sequences included.
+    uint64_t max_instructions = 0;
+
+    /// Maximum number of CPU cycles, DMA stalls included.
+    uint64_t max_cycles = 0;
+
+    /// Maximum wall-clock duration of the step in seconds.
+    double max_seconds = 0.0;
+
+    /// Program counter values stopping the step once reached.
+    std::vector<uint16_t> breakpoints;
+
+    /// Whether or not a CPU write changing a watched address stops the step.
+    bool stop_on_watch_change = false;
+};
+
+/// Outcome of a step, see `NES::step_until`.
+struct StepResult {
+    /// Reason for which the step ended.
+    StopReason reason;
+
+    /// Number of frames completed.
+    unsigned int frames;
+
+    /// Number of CPU instructions executed, interrupt sequences included.
+    uint64_t instructions;
+
+    /// Number of CPU cycles executed, DMA stalls included.
+    uint64_t cycles;
+};
+
 /// Main NES class, contains the RAM, CPU, PPU, APU, Mapper, etc...
 class NES {
 public:
-    // TODO maybe allow to use a constructor with a raw byte ptr.
     /// Initialize the NES.
     /// @param path Path to the ROM.
     NES(const char* path);
 
+    /// Initialize the NES from an already loaded ROM.
+    /// @note The ROM image is shared, only the console and mapper RAM are allocated.
+    /// @param cartridge Shared ROM image.
+    NES(const std::shared_ptr<const Cartridge>& cartridge);
+
+    /// Initialize the NES as a copy of another emulator.
+    /// @note The copy shares the ROM image and skips the power-up, see
+    /// `NES::copy_state`.
+    /// @param source Emulator to copy.
+    NES(NES& source);
+
     /// Default destructor.
     ~NES() = default;
 
@@ -30,6 +108,48 @@ public:
     /// Perform a dummy read cycle.
     void dummy_read();
 
+    /// Advance the PPU clock by the given number of dots.
+    /// @note The dots are only run once the PPU state can be observed: a CPU access to
+    /// the PPU registers or to the mapper, an edge of the non-maskable interrupt, a
+    /// possible mapper interrupt, or the end of the frame.
+    /// @param dots Number of dots elapsed.
+    inline void clock_ppu(unsigned int dots) {
+        _ppu_pending_dots += dots;
+
+        if (_ppu_pending_dots >= _ppu_deadline) {
+            sync_ppu();
+        }
+    }
+
+    /// Run the pending PPU dots, catching the PPU up with the CPU.
+    /// @note The deadline is recomputed, as the next PPU event is only known once the
+    /// PPU is up to date.
+    void sync_ppu();
+
+    /// Get the number of CPU cycles that can be skipped by an idle loop.
+    /// @note No interrupt is raised and nothing changes in the console during these
+    /// cycles, as long as the CPU only reads from the console RAM (and from $2002 when
+    /// `status` is set). The distance is also bounded by the cycles left to
+    /// `NES::step_until`, if limited.
+    /// @param status Whether or not the loop reads the PPU status register.
+    /// @return The number of CPU cycles.
+    unsigned int get_idle_distance(bool status) const;
+
+    /// Get the number of CPU instructions that can be skipped by an idle loop, bounded
+    /// by the instructions left to `NES::step_until`, if limited.
+    inline unsigned int get_idle_instruction_budget() const { return _idle_instruction_budget; }
+
+    /// Move the console forward without running the CPU, for an idle loop.
+    /// @note The number of cycles should not exceed `NES::get_idle_distance`.
+    /// @param cycles Number of CPU cycles skipped.
+    /// @param instructions Number of CPU instructions skipped.
+    void skip_idle_cycles(unsigned int cycles, unsigned int instructions);
+
+    /// Get the PPU dot reached by the console, including the pending dots.
+    /// @note The dot may exceed the length of the frame, as long as the PPU has not
+    /// been caught up.
+    inline unsigned int get_dot() const { return ppu.get_dot() + _ppu_pending_dots; }
+
     /// Write to the console memory while ticking its components.
     /// @note This function has other side effects than simply writing to the memory, it
     /// should not be used as a memory set function.
@@ -58,6 +178,16 @@ public:
     /// @param value Value to write.
     void write_oam(uint8_t address, uint8_t value);
 
+    /// Perform an OAM DMA from the console RAM at once.
+    /// @note The transfer is only done when the PPU can neither render nor raise any
+    /// interrupt during the whole transfer, the PPU and the CPU interrupt lines then
+    /// being moved forward by the given number of cycles. The APU is not moved forward.
+    /// @param page Source page, within the console RAM (lower than $20).
+    /// @param cycles Length of the transfer in CPU cycles.
+    /// @return True if the transfer has been done, false if it should be run cycle by
+    /// cycle instead.
+    bool transfer_oam(uint8_t page, unsigned int cycles);
+
     /// Read from the console memory while ticking its components.
     /// @note This function has other side effects than simply reading from  memory, it
     /// should not be used as a memory watch function.
@@ -75,6 +205,13 @@ public:
     /// Returns the pointer to the console's memory.
     const uint8_t* get_ram_pointer() const;
 
+    /// Read from the console memory without any side effect.
+    /// @note Only the console RAM and the mapper address space ($4020-$FFFF) can be
+    /// read, other addresses return the open bus.
+    /// @param address Memory address within the console memory address space.
+    /// @return The value stored at the given address.
+    uint8_t peek_cpu(uint16_t address) const;
+
     /// Read from the PPU memory.
     /// @note This function has other side effects than simply reading from memory, it
     /// should not be used as a memory watch function.
@@ -97,53 +234,239 @@ public:
     /// @param controllers Controllers states (first 8-bits for controller 1, the
     /// remaining 8-bits fro controller 2).
     /// @param frames Number of frame of the step.
+    /// @param policy Frames to render: all of them, only the last one of the step, or
+    /// none (the frame buffer then keeps its previous content).
     /// @return True if the CPU is frozen, false otherwise.
-    bool step(uint16_t controllers, unsigned int frames);
+    bool step(uint16_t controllers, unsigned int frames, RenderPolicy policy = RenderPolicy::ALL);
+
+    /// Step the emulation by the given amount of frame, or until a stop condition is met.
+    /// @note Stop conditions are checked after every CPU instruction, the step then ends
+    /// in the middle of the frame, and the next step resumes from there. Done conditions
+    /// still end the step at the end of the frame. Skipped idle loops count every
+    /// instruction they skip, and never go past the instruction and cycle limits.
+    /// @param controllers Controllers states (first 8-bits for controller 1, the
+    /// remaining 8-bits fro controller 2).
+    /// @param frames Maximum number of frames of the step.
+    /// @param options Stop conditions.
+    /// @param policy Frames to render, see `NES::step`.
+    /// @return The reason for which the step ended, and what has been executed.
+    StepResult step_until(
+        uint16_t controllers,
+        unsigned int frames,
+        const StepOptions& options,
+        RenderPolicy policy = RenderPolicy::ALL
+    );
+
+    /// Set the addresses whose values are gathered at the end of every frame.
+    /// @note The values are gathered without any side effect, hence only the console RAM
+    /// and the mapper address space ($4020-$FFFF) can be watched.
+    /// @param addresses Watched addresses.
+    void set_watch_list(const std::vector<uint16_t>& addresses);
+
+    /// Get the values of the watched addresses, as of the end of the last frame.
+    inline const uint8_t* get_watch_values() const { return _watch_values.data(); }
+
+    /// Get the number of watched addresses.
+    inline size_t get_watch_size() const { return _watch_values.size(); }
+
+    /// Add a condition ending the steps early.
+    /// @note Conditions are checked each time their address is written by the CPU, and
+    /// at the end of every frame. Once one of them is met, the step stops at the end of
+    /// the current frame.
+    /// @param condition Done condition, its address follows the rules of the watch list.
+    void add_done_condition(const DoneCondition& condition);
+
+    /// Remove every done condition.
+    void clear_done_conditions();
+
+    /// Check whether or not any done condition is registered.
+    inline bool has_done_conditions() const { return !_done_conditions.empty(); }
+
+    /// Check whether or not a done condition ended the last step.
+    inline bool is_done() const { return _done; }
 
     /// Get the size of the save state.
+    /// @note Save states start with a fixed header (magic, version, mapper id and ROM
+    /// hash), followed by the state of the components stored in little-endian.
     /// @return The size of the save state buffer.
     unsigned int size();
 
+    /// Get the maximum size of a compressed save state.
+    /// @return The worst case size of the compressed save state buffer.
+    unsigned int compressed_size_bound();
+
     /// Save the state of the emulator to the buffer.
-    /// @param buffer Save state buffer.
+    /// @param buffer Save state buffer, `NES::size` bytes large.
     void save(uint8_t* buffer);
 
+    /// Save the state of the emulator to the buffer, compressed using LZ4.
+    /// @param buffer Save state buffer, at least `NES::compressed_size_bound` bytes large.
+    /// @return The number of bytes written.
+    unsigned int save_compressed(uint8_t* buffer);
+
+    /// Create an independent copy of the emulator.
+    /// @note The copy shares the ROM image and skips the power-up, see
+    /// `NES::copy_state`.
+    /// @return The new emulator.
+    std::unique_ptr<NES> clone();
+
+    /// Copy the state of another emulator of the same ROM, without going through a save
+    /// state.
+    /// @note The memory is copied directly, and the registers of the components through
+    /// a small scratch buffer. The frame buffer (unless disabled), the watch list and
+    /// the done conditions are copied as well, while the profiling counters and the
+    /// snapshot base are not.
+    /// @param source Emulator to copy the state from.
+    /// @param frame Whether or not the frame buffer is copied.
+    void copy_state(NES& source, bool frame = true);
+
+    /// Check whether or not the buffer holds a save state this emulator can load.
+    /// @note Only the header and the buffer size are checked, a compressed payload may
+    /// still turn out to be corrupted once decompressed. Nothing is thrown, so that
+    /// batches can be checked before being loaded from worker threads.
+    /// @param buffer Save state buffer.
+    /// @param size Size of the save state buffer.
+    /// @return The reason why the state cannot be loaded, or `nullptr` if it can.
+    const char* check_state(uint8_t* buffer, unsigned int size);
+
     /// Load a previous emulator state from the buffer.
+    /// @note Both compressed and uncompressed save states are accepted, the header is
+    /// validated before anything is loaded.
     /// @param buffer Save state buffer.
-    void load(uint8_t* buffer);
+    /// @param size Size of the save state buffer.
+    void load(uint8_t* buffer, unsigned int size);
+
+    /// Compute a fingerprint of the emulator state.
+    /// @note The state is fed incrementally to XXH64, without any allocation nor copy,
+    /// the hash is the same as the one of the save state without its header.
+    /// @return The 64-bit hash of the state.
+    uint64_t state_hash();
+
+    /// Compute a fingerprint of the console RAM and of the mapper CPU RAM (PRG-RAM).
+    /// @return The 64-bit hash of the RAM.
+    uint64_t ram_hash() const;
+
+    /// Use the current state as the base of the incremental snapshots.
+    /// @note Previous snapshots are relative to the previous base, and cannot be loaded
+    /// anymore once the base has changed.
+    void set_snapshot_base();
+
+    /// Check whether or not a snapshot base has been set.
+    inline bool has_snapshot_base() const { return _snapshot_base != nullptr; }
+
+    /// Get the size of an incremental snapshot of the current state.
+    /// @return The size of the snapshot buffer.
+    unsigned int snapshot_size();
+
+    /// Save an incremental snapshot of the emulator to the buffer.
+    /// @note Only the 1 KiB memory blocks (console RAM, mapper RAM and CHR-RAM) written
+    /// since the snapshot base are saved, along with the registers of the components.
+    /// @param buffer Snapshot buffer, at least `NES::snapshot_size` bytes large.
+    /// @return The number of bytes written.
+    unsigned int save_snapshot(uint8_t* buffer);
+
+    /// Load an incremental snapshot from the buffer.
+    /// @note Snapshots start with a small header (block count, ROM hash and an id of
+    /// their base, unique within the process), only the ones taken since the current
+    /// base of this emulator are accepted. Only the blocks written since the base,
+    /// either by the snapshot or by the current state, are copied.
+    /// @param buffer Snapshot buffer.
+    /// @param size Size of the snapshot buffer.
+    void load_snapshot(uint8_t* buffer, unsigned int size);
 
     /// Get a pointer to the internal frame buffer.
     inline const uint8_t* get_frame_buffer() const {
         return ppu.get_frame_buffer();
     }
 
+    /// Get a pointer to the internal indexed frame buffer.
+    inline const uint8_t* get_frame_indices() const {
+        return ppu.get_frame_indices();
+    }
+
+    /// Get a pointer to the color emphasis of each scanline of the indexed frame buffer.
+    inline const uint8_t* get_frame_emphasis() const {
+        return ppu.get_frame_emphasis();
+    }
+
+    /// Reset the profiling counters to zero.
+    inline void reset_counters() {
+        counters = Counters{};
+    }
+
 public:
     CPU cpu;
     PPU ppu;
     APU apu;
 
+    /// Profiling counters, only updated when built with `CYNES_PROFILE`.
+    /// @note The counters measure the host, they are not part of the save states.
+    Counters counters;
+
     Mapper& get_mapper();
 
 private:
     std::unique_ptr<Mapper> _mapper;
 
 private:
-    std::unique_ptr<uint8_t[]> _memory_cpu;
-    std::unique_ptr<uint8_t[]> _memory_oam;
-    std::unique_ptr<uint8_t[]> _memory_palette;
+    // The memories are stored inline, next to the registers of the components, so
+    // that the whole hot state of the emulator is a single cache-line aligned block.
+    // The frame buffers of the PPU are kept apart.
+    alignas(64) uint8_t _memory_cpu[0x800];
+    uint8_t _memory_oam[0x100];
+    uint8_t _memory_palette[0x20];
 
     uint8_t _open_bus;
 
+    unsigned int _ppu_pending_dots;
+    unsigned int _ppu_deadline;
+    uint64_t _ppu_synced_dots;
+
+    // Bounds of the idle loop skipping, and instructions skipped, for `step_until`.
+    unsigned int _idle_cycle_budget;
+    unsigned int _idle_instruction_budget;
+    uint64_t _idle_instructions;
+
+    std::vector<uint16_t> _watch_addresses;
+    std::vector<uint8_t> _watch_values;
+    uint64_t _watch_pages;
+    bool _watch_changed;
+    std::vector<DoneCondition> _done_conditions;
+    uint64_t _done_condition_pages;
+    bool _done;
+
     uint8_t _controller_status[0x2];
     uint8_t _controller_shifters[0x2];
 
+    BlockSet _dirty_blocks;
+    std::unique_ptr<uint8_t[]> _snapshot_base;
+    uint64_t _snapshot_base_id;
+
+    std::unique_ptr<uint8_t[]> _state_buffer;
+
 private:
     void load_controller_shifter(bool polling);
 
     uint8_t poll_controller(uint8_t player);
 
+    void end_frame();
+
+    void update_watch_values();
+    void check_watch_change(uint16_t address, uint8_t previous, uint8_t value);
+    void check_done_conditions(uint16_t address, uint8_t value);
+    void check_done_conditions();
+
+    size_t get_memory_blocks() const;
+    uint8_t* get_memory_block(size_t index);
+
+    void restore_dirty_blocks();
+
 private:
     template<DumpOperation operation, class T> void dump(T& buffer);
+    template<DumpOperation operation, class T> void dump_registers(T& buffer);
+
+private:
+    NES(const std::shared_ptr<const Cartridge>& cartridge, bool fill_memory);
 };
 }
 
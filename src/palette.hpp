@@ -0,0 +1,48 @@
+#ifndef __CYNES_PALETTE__
+#define __CYNES_PALETTE__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cynes {
+/// RGB colors of the NES palette, indexed by the color emphasis and the palette index.
+extern const uint8_t PALETTE_COLORS[0x8][0x40][0x3];
+
+namespace palette {
+/// Pixel formats an indexed frame can be converted to.
+enum class PixelFormat : uint8_t {
+    RGB24, RGBA32, LUMA
+};
+
+/// Convert an indexed frame into RGB24 (240x256x3).
+/// @param indices Palette indices of the frame (240x256).
+/// @param emphasis Color emphasis of each scanline (240).
+/// @param output Output buffer.
+void convert_rgb24(const uint8_t* indices, const uint8_t* emphasis, uint8_t* output);
+
+/// Convert an indexed frame into RGBA32 (240x256x4), with an opaque alpha channel.
+/// @param indices Palette indices of the frame (240x256).
+/// @param emphasis Color emphasis of each scanline (240).
+/// @param output Output buffer.
+void convert_rgba32(const uint8_t* indices, const uint8_t* emphasis, uint8_t* output);
+
+/// Convert an indexed frame into luma (BT.601), optionally downsampled.
+/// @note When downsampled, each output pixel is the rounded mean of a square block of
+/// pixels, the output has a shape of (240 / factor)x(256 / factor).
+/// @param indices Palette indices of the frame (240x256).
+/// @param emphasis Color emphasis of each scanline (240).
+/// @param output Output buffer.
+/// @param factor Downsampling factor (1, 2 or 4).
+void convert_luma(const uint8_t* indices, const uint8_t* emphasis, uint8_t* output, uint8_t factor = 1);
+
+/// Convert an indexed frame into the given pixel format.
+/// @param indices Palette indices of the frame (240x256).
+/// @param emphasis Color emphasis of each scanline (240).
+/// @param output Output buffer.
+/// @param format Output pixel format.
+/// @param factor Downsampling factor (1, 2 or 4), only supported by `PixelFormat::LUMA`.
+void convert(const uint8_t* indices, const uint8_t* emphasis, uint8_t* output, PixelFormat format, uint8_t factor = 1);
+}
+}
+
+#endif
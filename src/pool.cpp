@@ -0,0 +1,254 @@
+#include "pool.hpp"
+
+#include "nes.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+
+// Number of unsuccessful polls before a thread goes to sleep.
+constexpr unsigned int SPIN_COUNT = 0x100;
+
+
+namespace {
+void pin_current_thread(size_t core) {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        return;
+    }
+
+    // Only the cores the process is allowed to run on are used.
+    size_t target = core % static_cast<size_t>(CPU_COUNT(&allowed));
+
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+
+        if (target-- == 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+
+            return;
+        }
+    }
+#elif defined(_WIN32)
+    SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << (core % (sizeof(DWORD_PTR) * 8)));
+#else
+    (void) core;
+#endif
+}
+}
+
+
+cynes::Pool::Pool(const std::vector<NES*>& emulators, size_t threads, bool pin_threads)
+    : _emulators{emulators}
+    , _pending{new std::atomic<bool>[emulators.size()]}
+    , _pending_count{0}
+    , _jobs{emulators.size()}
+    , _completions{emulators.size()}
+    , _stop{false}
+    , _sleeping_workers{0}
+    , _sleeping_callers{0}
+{
+    if (_emulators.empty()) {
+        throw std::invalid_argument("The pool should step at least one emulator.");
+    }
+
+    for (size_t k = 0; k < _emulators.size(); k++) {
+        _pending[k].store(false, std::memory_order_relaxed);
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    threads = std::min(threads, _emulators.size());
+
+    for (size_t k = 0; k < threads; k++) {
+        _workers.emplace_back(&Pool::run_worker, this, k, pin_threads);
+    }
+}
+
+cynes::Pool::~Pool() {
+    _stop.store(true);
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+    }
+
+    _condition_jobs.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+bool cynes::Pool::submit(const StepJob& job) {
+    if (job.emulator >= _emulators.size()) {
+        throw std::out_of_range("The emulator index is out of range.");
+    }
+
+    if (_pending[job.emulator].exchange(true, std::memory_order_acq_rel)) {
+        return false;
+    }
+
+    _pending_count.fetch_add(1);
+
+    // The queue holds one job per emulator, it is never full.
+    _jobs.try_push(job);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (_sleeping_workers.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+        }
+
+        _condition_jobs.notify_one();
+    }
+
+    return true;
+}
+
+bool cynes::Pool::poll(StepCompletion& completion) {
+    return _completions.try_pop(completion);
+}
+
+cynes::StepCompletion cynes::Pool::wait() {
+    StepCompletion completion{};
+
+    for (unsigned int k = 0; k < SPIN_COUNT; k++) {
+        if (_completions.try_pop(completion)) {
+            return completion;
+        }
+
+        std::this_thread::yield();
+    }
+
+    _sleeping_callers.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _condition_completions.wait(lock, [&] { return _completions.try_pop(completion); });
+    }
+
+    _sleeping_callers.fetch_sub(1);
+
+    return completion;
+}
+
+void cynes::Pool::wait_all() {
+    for (unsigned int k = 0; k < SPIN_COUNT; k++) {
+        if (_pending_count.load() == 0) {
+            return;
+        }
+
+        std::this_thread::yield();
+    }
+
+    _sleeping_callers.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _condition_completions.wait(lock, [&] { return _pending_count.load() == 0; });
+    }
+
+    _sleeping_callers.fetch_sub(1);
+}
+
+void cynes::Pool::run_worker(size_t core, bool pin_thread) {
+    if (pin_thread) {
+        pin_current_thread(core);
+    }
+
+    StepJob job;
+
+    while (pop_job(job)) {
+        NES& emulator = *_emulators[job.emulator];
+
+        bool crashed = emulator.step(job.controllers, job.frames, job.policy);
+        bool done = emulator.is_done();
+
+        // Once released, the emulator may already be stepped by another job.
+        _pending[job.emulator].store(false, std::memory_order_release);
+
+        push_completion({job.emulator, crashed, done});
+    }
+}
+
+bool cynes::Pool::pop_job(StepJob& job) {
+    while (true) {
+        for (unsigned int k = 0; k < SPIN_COUNT; k++) {
+            if (_stop.load(std::memory_order_relaxed)) {
+                return false;
+            }
+
+            if (_jobs.try_pop(job)) {
+                return true;
+            }
+
+            std::this_thread::yield();
+        }
+
+        bool popped = false;
+
+        _sleeping_workers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _condition_jobs.wait(lock, [&] {
+                popped = _jobs.try_pop(job);
+                return popped || _stop.load();
+            });
+        }
+
+        _sleeping_workers.fetch_sub(1);
+
+        if (popped) {
+            return true;
+        }
+    }
+}
+
+void cynes::Pool::push_completion(const StepCompletion& completion) {
+    // The ring holds one completion per emulator, it can only be full if the caller
+    // submitted new jobs without consuming the previous completions.
+    while (!_completions.try_push(completion)) {
+        if (_stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        std::this_thread::yield();
+    }
+
+    _pending_count.fetch_sub(1);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (_sleeping_callers.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+        }
+
+        _condition_completions.notify_all();
+    }
+}
@@ -0,0 +1,204 @@
+#ifndef __CYNES_POOL__
+#define __CYNES_POOL__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "nes.hpp"
+
+namespace cynes {
+/// Bounded lock-free multi-producer multi-consumer queue.
+/// @note Each cell carries a sequence number telling producers and consumers whether
+/// it is free or filled (see D. Vyukov's bounded MPMC queue), pushing and popping only
+/// cost a single compare-and-swap when uncontended.
+template<typename T>
+class WorkQueue {
+public:
+    /// Initialize the queue.
+    /// @param capacity Minimum number of elements the queue can hold, rounded up to the
+    /// next power of two.
+    WorkQueue(size_t capacity) : _mask{0}, _head{0}, _tail{0} {
+        size_t size = 2;
+
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        _mask = size - 1;
+        _cells.reset(new Cell[size]);
+
+        for (size_t k = 0; k < size; k++) {
+            _cells[k].sequence.store(k, std::memory_order_relaxed);
+        }
+    }
+
+    /// Default destructor.
+    ~WorkQueue() = default;
+
+public:
+    /// Push an element at the back of the queue.
+    /// @param value Element to push.
+    /// @return False if the queue is full, true otherwise.
+    bool try_push(const T& value) {
+        size_t position = _tail.load(std::memory_order_relaxed);
+
+        while (true) {
+            Cell& cell = _cells[position & _mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (difference == 0) {
+                if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = _tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Pop the element at the front of the queue.
+    /// @param value Popped element.
+    /// @return False if the queue is empty, true otherwise.
+    bool try_pop(T& value) {
+        size_t position = _head.load(std::memory_order_relaxed);
+
+        while (true) {
+            Cell& cell = _cells[position & _mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+            if (difference == 0) {
+                if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(position + _mask + 1, std::memory_order_release);
+
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = _head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+private:
+    std::unique_ptr<Cell[]> _cells;
+    size_t _mask;
+
+    // Producers and consumers update distinct cache lines.
+    alignas(64) std::atomic<size_t> _head;
+    alignas(64) std::atomic<size_t> _tail;
+};
+
+/// Step request sent to a `Pool`.
+struct StepJob {
+    size_t emulator;
+    uint16_t controllers;
+    unsigned int frames;
+    RenderPolicy policy;
+};
+
+/// Step completion reported by a `Pool`.
+struct StepCompletion {
+    size_t emulator;
+    bool crashed;
+    bool done;
+};
+
+/// Fixed set of worker threads stepping a batch of emulators.
+/// @note Jobs are submitted and completions reported through lock-free queues. Idle
+/// workers take the next job from the shared queue, so that expensive frames on a
+/// single emulator do not hold back the rest of the batch. An emulator only has a
+/// single job in flight at once, hence each `NES` is only ever stepped by one thread.
+class Pool {
+public:
+    /// Initialize the pool and start the worker threads.
+    /// @param emulators Emulators stepped by the pool, owned by the caller.
+    /// @param threads Number of worker threads, 0 to use the hardware concurrency.
+    /// @param pin_threads Whether or not each worker should be pinned to its own core.
+    Pool(const std::vector<NES*>& emulators, size_t threads = 0, bool pin_threads = true);
+
+    /// Stop and join the worker threads.
+    /// @note Jobs still in the queue are dropped.
+    ~Pool();
+
+public:
+    /// Submit a step job.
+    /// @param job Step job.
+    /// @return False if the emulator already has a job in flight, true otherwise.
+    bool submit(const StepJob& job);
+
+    /// Pop a completion, if any.
+    /// @note Completions have to be consumed, the ring only holds one completion per
+    /// emulator.
+    /// @param completion Popped completion.
+    /// @return False if no job has completed, true otherwise.
+    bool poll(StepCompletion& completion);
+
+    /// Wait for a job to complete.
+    /// @note At least one job should be in flight or not consumed yet.
+    /// @return The popped completion.
+    StepCompletion wait();
+
+    /// Wait for every job in flight to complete.
+    /// @note The completions are not consumed.
+    void wait_all();
+
+    /// Check whether or not an emulator has a job in flight.
+    /// @param emulator Emulator index.
+    inline bool is_pending(size_t emulator) const {
+        return _pending[emulator].load(std::memory_order_acquire);
+    }
+
+    /// Get the number of emulators.
+    inline size_t size() const { return _emulators.size(); }
+
+    /// Get the number of worker threads.
+    inline size_t get_thread_count() const { return _workers.size(); }
+
+private:
+    std::vector<NES*> _emulators;
+    std::unique_ptr<std::atomic<bool>[]> _pending;
+    std::atomic<size_t> _pending_count;
+
+    WorkQueue<StepJob> _jobs;
+    WorkQueue<StepCompletion> _completions;
+
+    std::vector<std::thread> _workers;
+    std::atomic<bool> _stop;
+
+    // Idle workers and waiting callers sleep on these conditions, the counters let the
+    // other side skip the notification when nobody sleeps.
+    std::mutex _mutex;
+    std::condition_variable _condition_jobs;
+    std::condition_variable _condition_completions;
+    std::atomic<size_t> _sleeping_workers;
+    std::atomic<size_t> _sleeping_callers;
+
+private:
+    void run_worker(size_t core, bool pin_thread);
+    bool pop_job(StepJob& job);
+    void push_completion(const StepCompletion& completion);
+};
+}
+
+#endif
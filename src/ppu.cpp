@@ -2,115 +2,51 @@
 #include "cpu.hpp"
 #include "nes.hpp"
 #include "mapper.hpp"
+#include "palette.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <stdexcept>
 
 
-constexpr uint8_t PALETTE_COLORS[0x8][0x40][0x3] = {
-    0x54, 0x54, 0x54, 0x00, 0x1E, 0x74, 0x08, 0x10, 0x90, 0x30, 0x00, 0x88, 0x44, 0x00, 0x64, 0x5C,
-    0x00, 0x30, 0x54, 0x04, 0x00, 0x3C, 0x18, 0x00, 0x20, 0x2A, 0x00, 0x08, 0x3A, 0x00, 0x00, 0x40,
-    0x00, 0x00, 0x3C, 0x00, 0x00, 0x32, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x98, 0x96, 0x98, 0x08, 0x4C, 0xC4, 0x30, 0x32, 0xEC, 0x5C, 0x1E, 0xE4, 0x88, 0x14, 0xB0, 0xA0,
-    0x14, 0x64, 0x98, 0x22, 0x20, 0x78, 0x3C, 0x00, 0x54, 0x5A, 0x00, 0x28, 0x72, 0x00, 0x08, 0x7C,
-    0x00, 0x00, 0x76, 0x28, 0x00, 0x66, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xEC, 0xEE, 0xEC, 0x4C, 0x9A, 0xEC, 0x78, 0x7C, 0xEC, 0xB0, 0x62, 0xEC, 0xE4, 0x54, 0xEC, 0xEC,
-    0x58, 0xB4, 0xEC, 0x6A, 0x64, 0xD4, 0x88, 0x20, 0xA0, 0xAA, 0x00, 0x74, 0xC4, 0x00, 0x4C, 0xD0,
-    0x20, 0x38, 0xCC, 0x6C, 0x38, 0xB4, 0xCC, 0x3C, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xEC, 0xEE, 0xEC, 0xA8, 0xCC, 0xEC, 0xBC, 0xBC, 0xEC, 0xD4, 0xB2, 0xEC, 0xEC, 0xAE, 0xEC, 0xEC,
-    0xAE, 0xD4, 0xEC, 0xB4, 0xB0, 0xE4, 0xC4, 0x90, 0xCC, 0xD2, 0x78, 0xB4, 0xDE, 0x78, 0xA8, 0xE2,
-    0x90, 0x98, 0xE2, 0xB4, 0xA0, 0xD6, 0xE4, 0xA0, 0xA2, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x5C, 0x4B, 0x4B, 0x00, 0x1B, 0x68, 0x08, 0x0E, 0x81, 0x34, 0x00, 0x7A, 0x4A, 0x00, 0x5A, 0x65,
-    0x00, 0x2B, 0x5C, 0x03, 0x00, 0x42, 0x15, 0x00, 0x23, 0x25, 0x00, 0x08, 0x34, 0x00, 0x00, 0x39,
-    0x00, 0x00, 0x36, 0x00, 0x00, 0x2D, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xA7, 0x87, 0x88, 0x08, 0x44, 0xB0, 0x34, 0x2D, 0xD4, 0x65, 0x1B, 0xCD, 0x95, 0x12, 0x9E, 0xB0,
-    0x12, 0x5A, 0xA7, 0x1E, 0x1C, 0x84, 0x36, 0x00, 0x5C, 0x51, 0x00, 0x2C, 0x66, 0x00, 0x08, 0x6F,
-    0x00, 0x00, 0x6A, 0x24, 0x00, 0x5B, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xFF, 0xD6, 0xD4, 0x53, 0x8A, 0xD4, 0x84, 0x6F, 0xD4, 0xC1, 0x58, 0xD4, 0xFA, 0x4B, 0xD4, 0xFF,
-    0x4F, 0xA2, 0xFF, 0x5F, 0x5A, 0xE9, 0x7A, 0x1C, 0xB0, 0x99, 0x00, 0x7F, 0xB0, 0x00, 0x53, 0xBB,
-    0x1C, 0x3D, 0xB7, 0x61, 0x3D, 0xA2, 0xB7, 0x42, 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xFF, 0xD6, 0xD4, 0xB8, 0xB7, 0xD4, 0xCE, 0xA9, 0xD4, 0xE9, 0xA0, 0xD4, 0xFF, 0x9C, 0xD4, 0xFF,
-    0x9C, 0xBE, 0xFF, 0xA2, 0x9E, 0xFA, 0xB0, 0x81, 0xE0, 0xBD, 0x6C, 0xC6, 0xC7, 0x6C, 0xB8, 0xCB,
-    0x81, 0xA7, 0xCB, 0xA2, 0xB0, 0xC0, 0xCD, 0xB0, 0x91, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x4B, 0x5C, 0x4B, 0x00, 0x21, 0x68, 0x07, 0x11, 0x81, 0x2B, 0x00, 0x7A, 0x3D, 0x00, 0x5A, 0x52,
-    0x00, 0x2B, 0x4B, 0x04, 0x00, 0x36, 0x1A, 0x00, 0x1C, 0x2E, 0x00, 0x07, 0x3F, 0x00, 0x00, 0x46,
-    0x00, 0x00, 0x42, 0x00, 0x00, 0x37, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x88, 0xA5, 0x88, 0x07, 0x53, 0xB0, 0x2B, 0x37, 0xD4, 0x52, 0x21, 0xCD, 0x7A, 0x16, 0x9E, 0x90,
-    0x16, 0x5A, 0x88, 0x25, 0x1C, 0x6C, 0x42, 0x00, 0x4B, 0x63, 0x00, 0x24, 0x7D, 0x00, 0x07, 0x88,
-    0x00, 0x00, 0x81, 0x24, 0x00, 0x70, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xD4, 0xFF, 0xD4, 0x44, 0xA9, 0xD4, 0x6C, 0x88, 0xD4, 0x9E, 0x6B, 0xD4, 0xCD, 0x5C, 0xD4, 0xD4,
-    0x60, 0xA2, 0xD4, 0x74, 0x5A, 0xBE, 0x95, 0x1C, 0x90, 0xBB, 0x00, 0x68, 0xD7, 0x00, 0x44, 0xE4,
-    0x1C, 0x32, 0xE0, 0x61, 0x32, 0xC6, 0xB7, 0x36, 0x42, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xD4, 0xFF, 0xD4, 0x97, 0xE0, 0xD4, 0xA9, 0xCE, 0xD4, 0xBE, 0xC3, 0xD4, 0xD4, 0xBF, 0xD4, 0xD4,
-    0xBF, 0xBE, 0xD4, 0xC6, 0x9E, 0xCD, 0xD7, 0x81, 0xB7, 0xE7, 0x6C, 0xA2, 0xF4, 0x6C, 0x97, 0xF8,
-    0x81, 0x88, 0xF8, 0xA2, 0x90, 0xEB, 0xCD, 0x90, 0xB2, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x53, 0x53, 0x44, 0x00, 0x1D, 0x5D, 0x07, 0x0F, 0x74, 0x2F, 0x00, 0x6E, 0x43, 0x00, 0x51, 0x5B,
-    0x00, 0x26, 0x53, 0x03, 0x00, 0x3B, 0x17, 0x00, 0x1F, 0x29, 0x00, 0x07, 0x39, 0x00, 0x00, 0x3F,
-    0x00, 0x00, 0x3B, 0x00, 0x00, 0x31, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x96, 0x94, 0x7B, 0x07, 0x4B, 0x9E, 0x2F, 0x31, 0xBF, 0x5B, 0x1D, 0xB8, 0x86, 0x13, 0x8E, 0x9E,
-    0x13, 0x51, 0x96, 0x21, 0x19, 0x76, 0x3B, 0x00, 0x53, 0x59, 0x00, 0x27, 0x70, 0x00, 0x07, 0x7A,
-    0x00, 0x00, 0x74, 0x20, 0x00, 0x64, 0x61, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xE9, 0xEB, 0xBF, 0x4B, 0x98, 0xBF, 0x76, 0x7A, 0xBF, 0xAE, 0x61, 0xBF, 0xE1, 0x53, 0xBF, 0xE9,
-    0x57, 0x91, 0xE9, 0x68, 0x51, 0xD1, 0x86, 0x19, 0x9E, 0xA8, 0x00, 0x72, 0xC2, 0x00, 0x4B, 0xCD,
-    0x19, 0x37, 0xC9, 0x57, 0x37, 0xB2, 0xA5, 0x3B, 0x3B, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xE9, 0xEB, 0xBF, 0xA6, 0xC9, 0xBF, 0xBA, 0xBA, 0xBF, 0xD1, 0xB0, 0xBF, 0xE9, 0xAC, 0xBF, 0xE9,
-    0xAC, 0xAB, 0xE9, 0xB2, 0x8E, 0xE1, 0xC2, 0x74, 0xC9, 0xCF, 0x61, 0xB2, 0xDB, 0x61, 0xA6, 0xDF,
-    0x74, 0x96, 0xDF, 0x91, 0x9E, 0xD3, 0xB8, 0x9E, 0xA0, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x4B, 0x4B, 0x5C, 0x00, 0x1B, 0x7F, 0x07, 0x0E, 0x9E, 0x2B, 0x00, 0x95, 0x3D, 0x00, 0x6E, 0x52,
-    0x00, 0x34, 0x4B, 0x03, 0x00, 0x36, 0x15, 0x00, 0x1C, 0x25, 0x00, 0x07, 0x34, 0x00, 0x00, 0x39,
-    0x00, 0x00, 0x36, 0x00, 0x00, 0x2D, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x88, 0x87, 0xA7, 0x07, 0x44, 0xD7, 0x2B, 0x2D, 0xFF, 0x52, 0x1B, 0xFA, 0x7A, 0x12, 0xC1, 0x90,
-    0x12, 0x6E, 0x88, 0x1E, 0x23, 0x6C, 0x36, 0x00, 0x4B, 0x51, 0x00, 0x24, 0x66, 0x00, 0x07, 0x6F,
-    0x00, 0x00, 0x6A, 0x2C, 0x00, 0x5B, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xD4, 0xD6, 0xFF, 0x44, 0x8A, 0xFF, 0x6C, 0x6F, 0xFF, 0x9E, 0x58, 0xFF, 0xCD, 0x4B, 0xFF, 0xD4,
-    0x4F, 0xC6, 0xD4, 0x5F, 0x6E, 0xBE, 0x7A, 0x23, 0x90, 0x99, 0x00, 0x68, 0xB0, 0x00, 0x44, 0xBB,
-    0x23, 0x32, 0xB7, 0x76, 0x32, 0xA2, 0xE0, 0x36, 0x36, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xD4, 0xD6, 0xFF, 0x97, 0xB7, 0xFF, 0xA9, 0xA9, 0xFF, 0xBE, 0xA0, 0xFF, 0xD4, 0x9C, 0xFF, 0xD4,
-    0x9C, 0xE9, 0xD4, 0xA2, 0xC1, 0xCD, 0xB0, 0x9E, 0xB7, 0xBD, 0x84, 0xA2, 0xC7, 0x84, 0x97, 0xCB,
-    0x9E, 0x88, 0xCB, 0xC6, 0x90, 0xC0, 0xFA, 0x90, 0x91, 0xB0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x53, 0x44, 0x53, 0x00, 0x18, 0x72, 0x07, 0x0C, 0x8E, 0x2F, 0x00, 0x86, 0x43, 0x00, 0x63, 0x5B,
-    0x00, 0x2F, 0x53, 0x03, 0x00, 0x3B, 0x13, 0x00, 0x1F, 0x22, 0x00, 0x07, 0x2E, 0x00, 0x00, 0x33,
-    0x00, 0x00, 0x30, 0x00, 0x00, 0x28, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x96, 0x79, 0x96, 0x07, 0x3D, 0xC2, 0x2F, 0x28, 0xE9, 0x5B, 0x18, 0xE1, 0x86, 0x10, 0xAE, 0x9E,
-    0x10, 0x63, 0x96, 0x1B, 0x1F, 0x76, 0x30, 0x00, 0x53, 0x48, 0x00, 0x27, 0x5C, 0x00, 0x07, 0x64,
-    0x00, 0x00, 0x5F, 0x27, 0x00, 0x52, 0x76, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xE9, 0xC0, 0xE9, 0x4B, 0x7C, 0xE9, 0x76, 0x64, 0xE9, 0xAE, 0x4F, 0xE9, 0xE1, 0x44, 0xE9, 0xE9,
-    0x47, 0xB2, 0xE9, 0x55, 0x63, 0xD1, 0x6E, 0x1F, 0x9E, 0x89, 0x00, 0x72, 0x9E, 0x00, 0x4B, 0xA8,
-    0x1F, 0x37, 0xA5, 0x6A, 0x37, 0x91, 0xC9, 0x3B, 0x30, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xE9, 0xC0, 0xE9, 0xA6, 0xA5, 0xE9, 0xBA, 0x98, 0xE9, 0xD1, 0x90, 0xE9, 0xE9, 0x8C, 0xE9, 0xE9,
-    0x8C, 0xD1, 0xE9, 0x91, 0xAE, 0xE1, 0x9E, 0x8E, 0xC9, 0xAA, 0x76, 0xB2, 0xB3, 0x76, 0xA6, 0xB7,
-    0x8E, 0x96, 0xB7, 0xB2, 0x9E, 0xAD, 0xE1, 0x9E, 0x83, 0x9E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x44, 0x53, 0x53, 0x00, 0x1D, 0x72, 0x06, 0x0F, 0x8E, 0x26, 0x00, 0x86, 0x37, 0x00, 0x63, 0x4A,
-    0x00, 0x2F, 0x44, 0x03, 0x00, 0x30, 0x17, 0x00, 0x19, 0x29, 0x00, 0x06, 0x39, 0x00, 0x00, 0x3F,
-    0x00, 0x00, 0x3B, 0x00, 0x00, 0x31, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x7B, 0x94, 0x96, 0x06, 0x4B, 0xC2, 0x26, 0x31, 0xE9, 0x4A, 0x1D, 0xE1, 0x6E, 0x13, 0xAE, 0x81,
-    0x13, 0x63, 0x7B, 0x21, 0x1F, 0x61, 0x3B, 0x00, 0x44, 0x59, 0x00, 0x20, 0x70, 0x00, 0x06, 0x7A,
-    0x00, 0x00, 0x74, 0x27, 0x00, 0x64, 0x76, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xBF, 0xEB, 0xE9, 0x3D, 0x98, 0xE9, 0x61, 0x7A, 0xE9, 0x8E, 0x61, 0xE9, 0xB8, 0x53, 0xE9, 0xBF,
-    0x57, 0xB2, 0xBF, 0x68, 0x63, 0xAB, 0x86, 0x1F, 0x81, 0xA8, 0x00, 0x5D, 0xC2, 0x00, 0x3D, 0xCD,
-    0x1F, 0x2D, 0xC9, 0x6A, 0x2D, 0xB2, 0xC9, 0x30, 0x3B, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xBF, 0xEB, 0xE9, 0x88, 0xC9, 0xE9, 0x98, 0xBA, 0xE9, 0xAB, 0xB0, 0xE9, 0xBF, 0xAC, 0xE9, 0xBF,
-    0xAC, 0xD1, 0xBF, 0xB2, 0xAE, 0xB8, 0xC2, 0x8E, 0xA5, 0xCF, 0x76, 0x91, 0xDB, 0x76, 0x88, 0xDF,
-    0x8E, 0x7B, 0xDF, 0xB2, 0x81, 0xD3, 0xE1, 0x81, 0xA0, 0x9E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x4A, 0x4A, 0x4A, 0x00, 0x1A, 0x67, 0x07, 0x0E, 0x80, 0x2A, 0x00, 0x79, 0x3C, 0x00, 0x59, 0x51,
-    0x00, 0x2A, 0x4A, 0x03, 0x00, 0x35, 0x15, 0x00, 0x1C, 0x25, 0x00, 0x07, 0x33, 0x00, 0x00, 0x39,
-    0x00, 0x00, 0x35, 0x00, 0x00, 0x2C, 0x35, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x87, 0x85, 0x87, 0x07, 0x43, 0xAE, 0x2A, 0x2C, 0xD2, 0x51, 0x1A, 0xCB, 0x79, 0x11, 0x9C, 0x8E,
-    0x11, 0x59, 0x87, 0x1E, 0x1C, 0x6A, 0x35, 0x00, 0x4A, 0x50, 0x00, 0x23, 0x65, 0x00, 0x07, 0x6E,
-    0x00, 0x00, 0x69, 0x23, 0x00, 0x5A, 0x6A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xD2, 0xD4, 0xD2, 0x43, 0x89, 0xD2, 0x6A, 0x6E, 0xD2, 0x9C, 0x57, 0xD2, 0xCB, 0x4A, 0xD2, 0xD2,
-    0x4E, 0xA0, 0xD2, 0x5E, 0x59, 0xBC, 0x79, 0x1C, 0x8E, 0x97, 0x00, 0x67, 0xAE, 0x00, 0x43, 0xB9,
-    0x1C, 0x31, 0xB5, 0x60, 0x31, 0xA0, 0xB5, 0x35, 0x35, 0x35, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xD2, 0xD4, 0xD2, 0x95, 0xB5, 0xD2, 0xA7, 0xA7, 0xD2, 0xBC, 0x9E, 0xD2, 0xD2, 0x9B, 0xD2, 0xD2,
-    0x9B, 0xBC, 0xD2, 0xA0, 0x9C, 0xCB, 0xAE, 0x80, 0xB5, 0xBB, 0x6A, 0xA0, 0xC5, 0x6A, 0x95, 0xC9,
-    0x80, 0x87, 0xC9, 0xA0, 0x8E, 0xBE, 0xCB, 0x8E, 0x90, 0x8E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+namespace {
+/// Pattern rows decoded once for every possible bitplane byte.
+struct PatternTables {
+    /// Pixels of a bitplane spread over the bytes of a word, the leftmost pixel in the
+    /// lowest byte. Both planes of a row combine as `spread[lsb] | spread[msb] << 1`.
+    uint64_t spread[0x100];
+
+    /// Bitplane mirrored horizontally, for the flipped sprites.
+    uint8_t reversed[0x100];
+
+    constexpr PatternTables() : spread{}, reversed{} {
+        for (unsigned int plane = 0; plane < 0x100; plane++) {
+            for (unsigned int column = 0; column < 8; column++) {
+                if (plane & (0x80 >> column)) {
+                    spread[plane] |= uint64_t{1} << (column * 8);
+                    reversed[plane] |= 0x01 << column;
+                }
+            }
+        }
+    }
 };
 
+constexpr PatternTables PATTERN_TABLES{};
+}
+
 
 cynes::PPU::PPU(NES& nes)
     : _nes{nes}
-    , _frame_buffer{new uint8_t[0x2D000]}
+    , _frame_count{0}
+    , _frame_slot{0}
+    , _frame_buffer{nullptr}
+    , _frame_indices{nullptr}
+    , _frame_emphasis{nullptr}
+    , _frame_format{FrameFormat::RGB}
     , _current_x{0x0000}
     , _current_y{0x0000}
+    , _frame_ready{false}
+    , _frame_skip{false}
     , _rendering_enabled{false}
     , _rendering_enabled_delayed{false}
     , _prevent_vertical_blank{false}
@@ -163,6 +99,8 @@ cynes::PPU::PPU(NES& nes)
     std::memset(_foreground_shifter, 0x00, 0x10);
     std::memset(_foreground_attributes, 0x00, 0x8);
     std::memset(_foreground_positions, 0x00, 0x8);
+
+    set_frame_count(1);
 }
 
 void cynes::PPU::power() {
@@ -295,7 +233,17 @@ void cynes::PPU::tick() {
             }
 
             if (_current_x > 0 && _current_x < 257 && _current_y < 240) {
-                memcpy(_frame_buffer.get() + ((_current_y << 8) + _current_x - 1) * 3, PALETTE_COLORS[_mask_color_emphasize][_nes.read_ppu(0x3F00 | blend_colors())], 3);
+                if (_frame_skip) {
+                    update_sprite_zero_hit();
+                } else if (_frame_format == FrameFormat::INDEXED) {
+                    if (_current_x == 1) {
+                        _frame_emphasis[_current_y] = _mask_color_emphasize;
+                    }
+
+                    _frame_indices[(_current_y << 8) + _current_x - 1] = _nes.read_ppu(0x3F00 | blend_colors());
+                } else {
+                    memcpy(_frame_buffer + ((_current_y << 8) + _current_x - 1) * 3, PALETTE_COLORS[_mask_color_emphasize][_nes.read_ppu(0x3F00 | blend_colors())], 3);
+                }
             }
         } else if (_current_y == 240 && _current_x == 1) {
             _nes.read_ppu(_register_v);
@@ -382,6 +330,46 @@ void cynes::PPU::tick() {
     _nes.get_mapper().tick();
 }
 
+void cynes::PPU::run(unsigned int dots) {
+    while (dots > 0) {
+        if (dots >= 256 && is_scanline_quiet()) {
+            render_scanline();
+            dots -= 256;
+        } else {
+            tick();
+            dots--;
+        }
+    }
+}
+
+unsigned int cynes::PPU::get_dot() const {
+    return _current_y * 341 + _current_x;
+}
+
+unsigned int cynes::PPU::get_event_distance() const {
+    const unsigned int DOTS_PER_FRAME = 262 * 341;
+    const unsigned int VERTICAL_BLANK_DOT = 241 * 341 + 1;
+    const unsigned int PRE_RENDER_DOT = 261 * 341 + 1;
+
+    unsigned int dot = _current_y * 341 + _current_x;
+    unsigned int distance;
+
+    if (dot < VERTICAL_BLANK_DOT) {
+        distance = VERTICAL_BLANK_DOT - dot;
+    } else if (dot < PRE_RENDER_DOT) {
+        distance = PRE_RENDER_DOT - dot;
+    } else {
+        distance = DOTS_PER_FRAME - dot + VERTICAL_BLANK_DOT;
+    }
+
+    // The pre-render scanline of odd frames is one dot shorter.
+    if (distance > 1) {
+        distance--;
+    }
+
+    return std::min(distance, _nes.get_mapper().get_interrupt_distance());
+}
+
 void cynes::PPU::write(uint8_t address, uint8_t value) {
     memset(_clock_decays, DECAY_PERIOD, 3);
 
@@ -572,7 +560,164 @@ uint8_t cynes::PPU::read(uint8_t address) {
 }
 
 const uint8_t* cynes::PPU::get_frame_buffer() const {
-    return _frame_buffer.get();
+    return _frame_buffer;
+}
+
+const uint8_t* cynes::PPU::get_frame_indices() const {
+    return _frame_indices;
+}
+
+const uint8_t* cynes::PPU::get_frame_emphasis() const {
+    return _frame_emphasis;
+}
+
+const uint8_t* cynes::PPU::get_frame_buffer(size_t slot) const {
+    return _frame_slots[slot].buffer.get();
+}
+
+const uint8_t* cynes::PPU::get_frame_indices(size_t slot) const {
+    return _frame_slots[slot].indices.get();
+}
+
+void cynes::PPU::set_frame_count(size_t count) {
+    if (count == 0) {
+        throw std::invalid_argument("The PPU should have at least one frame buffer.");
+    }
+
+    while (_frame_slots.size() < count) {
+        _frame_slots.push_back({
+            std::unique_ptr<uint8_t[]>{new uint8_t[0x2D000]()},
+            std::unique_ptr<uint8_t[]>{new uint8_t[0xF000]()},
+            std::unique_ptr<uint8_t[]>{new uint8_t[0xF0]()}
+        });
+    }
+
+    _frame_count = count;
+
+    select_frame_slot(_frame_slot < count ? _frame_slot : 0);
+}
+
+size_t cynes::PPU::get_frame_count() const {
+    return _frame_count;
+}
+
+void cynes::PPU::rotate_frame() {
+    select_frame_slot((_frame_slot + 1) % _frame_count);
+}
+
+size_t cynes::PPU::get_frame_slot() const {
+    return _frame_slot;
+}
+
+void cynes::PPU::select_frame_slot(size_t slot) {
+    _frame_slot = slot;
+    _frame_buffer = _frame_slots[slot].buffer.get();
+    _frame_indices = _frame_slots[slot].indices.get();
+    _frame_emphasis = _frame_slots[slot].emphasis.get();
+}
+
+void cynes::PPU::set_frame_format(FrameFormat format) {
+    _frame_format = format;
+}
+
+cynes::FrameFormat cynes::PPU::get_frame_format() const {
+    return _frame_format;
+}
+
+unsigned int cynes::PPU::get_status_distance() const {
+    const unsigned int DOTS_PER_FRAME = 262 * 341;
+
+    if (_rendering_enabled != _rendering_enabled_delayed
+        || _rendering_enabled != (_mask_render_background || _mask_render_foreground)) {
+        return 0;
+    }
+
+    // The flags may have changed since the last read, which the loop has not seen yet.
+    const uint8_t flags = _status_sprite_overflow | _status_sprite_zero_hit << 1 | _status_vertical_blank << 2;
+
+    if ((_register_decay >> 5) != flags) {
+        return 0;
+    }
+
+    // The lower bits decay at the end of the frame, the pre-render scanline of odd
+    // frames being one dot shorter.
+    const unsigned int distance = DOTS_PER_FRAME - get_dot() - 1;
+
+    if (!_rendering_enabled || (_current_y >= 240 && _current_y < 261)) {
+        return distance;
+    }
+
+    // Sprites are evaluated on the scanline before the one they are drawn on.
+    const int first = _current_y == 261 ? 0 : std::max(int(_current_y) - 1, 0);
+    const int sprite_size = _control_foreground_large ? 16 : 8;
+
+    if (!_status_sprite_zero_hit) {
+        const int y = _nes.read_oam(0x00);
+
+        if (y < 240 && y + sprite_size > first) {
+            return 0;
+        }
+    }
+
+    // The overflow flag can only be set once eight sprites have been found.
+    if (!_status_sprite_overflow) {
+        uint8_t counts[240] = {};
+
+        for (unsigned int sprite = 0; sprite < 0x100; sprite += 4) {
+            const int y = _nes.read_oam(sprite);
+            const int last = std::min(y + sprite_size, 240);
+
+            for (int line = std::max(y, first); line < last; line++) {
+                if (++counts[line] == 8) {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    return distance;
+}
+
+bool cynes::PPU::can_transfer_oam(unsigned int dots) const {
+    const unsigned int PRE_RENDER_DOT = 261 * 341;
+
+    if (_rendering_enabled != _rendering_enabled_delayed
+        || _rendering_enabled != (_mask_render_background || _mask_render_foreground)) {
+        return false;
+    }
+
+    return (_current_y >= 240 || !_rendering_enabled) && get_dot() + dots < PRE_RENDER_DOT;
+}
+
+void cynes::PPU::transfer_oam(const uint8_t* data) {
+    memset(_clock_decays, DECAY_PERIOD, 3);
+
+    _register_decay = data[0xFF];
+
+    for (size_t k = 0; k < 0x100; k++) {
+        uint8_t value = data[k];
+
+        if ((_foreground_sprite_pointer & 0x03) == 0x02) {
+            value &= 0xE3;
+        }
+
+        _nes.write_oam(_foreground_sprite_pointer++, value);
+    }
+}
+
+void cynes::PPU::copy_frame(const PPU& other) {
+    _frame_format = other._frame_format;
+
+    if (_frame_format == FrameFormat::INDEXED) {
+        std::memcpy(_frame_indices, other._frame_indices, 0xF000);
+        std::memcpy(_frame_emphasis, other._frame_emphasis, 0xF0);
+    } else {
+        std::memcpy(_frame_buffer, other._frame_buffer, 0x2D000);
+    }
+}
+
+void cynes::PPU::set_frame_skip(bool skip) {
+    _frame_skip = skip;
 }
 
 bool cynes::PPU::is_frame_ready() {
@@ -878,11 +1023,8 @@ void cynes::PPU::load_foreground_shifter() {
 
             uint8_t sprite_pattern_lsb_plane = _nes.read_ppu(_foreground_sprite_address);
 
-
             if (sprite_attribute & 0x40) {
-                sprite_pattern_lsb_plane = (sprite_pattern_lsb_plane & 0xF0) >> 4 | (sprite_pattern_lsb_plane & 0x0F) << 4;
-                sprite_pattern_lsb_plane = (sprite_pattern_lsb_plane & 0xCC) >> 2 | (sprite_pattern_lsb_plane & 0x33) << 2;
-                sprite_pattern_lsb_plane = (sprite_pattern_lsb_plane & 0xAA) >> 1 | (sprite_pattern_lsb_plane & 0x55) << 1;
+                sprite_pattern_lsb_plane = PATTERN_TABLES.reversed[sprite_pattern_lsb_plane];
             }
 
             _foreground_shifter[_foreground_data_pointer * 2] = sprite_pattern_lsb_plane;
@@ -894,9 +1036,7 @@ void cynes::PPU::load_foreground_shifter() {
             uint8_t sprite_pattern_msb_plane = _nes.read_ppu(_foreground_sprite_address + 8);
 
             if (_foreground_data[_foreground_data_pointer * 4 + 2] & 0x40) {
-                sprite_pattern_msb_plane = (sprite_pattern_msb_plane & 0xF0) >> 4 | (sprite_pattern_msb_plane & 0x0F) << 4;
-                sprite_pattern_msb_plane = (sprite_pattern_msb_plane & 0xCC) >> 2 | (sprite_pattern_msb_plane & 0x33) << 2;
-                sprite_pattern_msb_plane = (sprite_pattern_msb_plane & 0xAA) >> 1 | (sprite_pattern_msb_plane & 0x55) << 1;
+                sprite_pattern_msb_plane = PATTERN_TABLES.reversed[sprite_pattern_msb_plane];
             }
 
             _foreground_shifter[_foreground_data_pointer * 2 + 1] = sprite_pattern_msb_plane;
@@ -924,6 +1064,166 @@ void cynes::PPU::update_foreground_shifter() {
     }
 }
 
+bool cynes::PPU::is_scanline_quiet() const {
+    // The pending dots are never interleaved with CPU accesses, the scanline can be
+    // rendered at once as long as the rendering state is settled on its first dot.
+    return _current_x == 0
+        && _current_y < 240
+        && _rendering_enabled
+        && _rendering_enabled_delayed
+        && (_mask_render_background || _mask_render_foreground)
+        && _delay_data_write_counter == 0
+        && !_nes.get_mapper().is_watching_ppu();
+}
+
+void cynes::PPU::render_scanline() {
+    // Same effects as the dots 1 to 256 of a visible scanline. The background and the
+    // sprite evaluation keep their dot-level state machines, the sprites of the line are
+    // decoded once into a line buffer instead of being shifted and scanned every dot.
+    uint8_t foreground_colors[0x100];
+    uint8_t foreground_flags[0x100];
+
+    const uint8_t FLAG_PRIORITY = 0x01;
+    const uint8_t FLAG_SPRITE_ZERO = 0x02;
+
+    std::memset(foreground_colors, 0x00, 0x100);
+
+    if (_mask_render_foreground) {
+        for (uint8_t sprite = 0; sprite < _foreground_sprite_count_next; sprite++) {
+            uint8_t flags = (_foreground_attributes[sprite] & 0x20) == 0x00 ? FLAG_PRIORITY : 0x00;
+
+            if (sprite == 0) {
+                flags |= FLAG_SPRITE_ZERO;
+            }
+
+            uint8_t palette = ((_foreground_attributes[sprite] & 0x03) + 0x04) << 2;
+            uint64_t row = PATTERN_TABLES.spread[_foreground_shifter[sprite * 2]]
+                | PATTERN_TABLES.spread[_foreground_shifter[sprite * 2 + 1]] << 1;
+
+            for (uint16_t column = 0; column < 8 && row != 0; column++, row >>= 8) {
+                uint16_t x = _foreground_positions[sprite] + column;
+
+                if (x > 0xFF) {
+                    break;
+                }
+
+                uint8_t pixel = row & 0x03;
+
+                // Lower sprite slots take precedence, even behind the background.
+                if (pixel != 0 && foreground_colors[x] == 0) {
+                    foreground_colors[x] = palette | pixel;
+                    foreground_flags[x] = flags;
+                }
+            }
+        }
+    }
+
+    uint8_t palette[0x20];
+
+    for (uint8_t k = 0; k < 0x20; k++) {
+        palette[k] = _nes.read_ppu(0x3F00 | k);
+    }
+
+    if (!_frame_skip && _frame_format == FrameFormat::INDEXED) {
+        _frame_emphasis[_current_y] = _mask_color_emphasize;
+    }
+
+    uint8_t* frame_indices = _frame_indices + (_current_y << 8);
+    uint8_t* frame_buffer = _frame_buffer + (_current_y << 8) * 3;
+
+    const uint16_t bit_mask = 0x8000 >> _scroll_x;
+    const uint8_t grayscale_mask = _mask_grayscale_mode ? 0x30 : 0x3F;
+
+    for (uint16_t x = 1; x < 257; x++) {
+        _current_x = x;
+
+        load_background_shifters();
+
+        if (x == 256) {
+            increment_scroll_y();
+        }
+
+        if (x < 65) {
+            clear_foreground_data();
+        } else {
+            fetch_foreground_data();
+        }
+
+        uint8_t background_pixel = 0x00;
+        uint8_t background_palette = 0x00;
+
+        if (_mask_render_background && (x > 8 || _mask_render_background_left)) {
+            background_pixel = ((_background_shifter[0] & bit_mask) > 0) | (((_background_shifter[1] & bit_mask) > 0) << 1);
+            background_palette = ((_background_shifter[2] & bit_mask) > 0) | (((_background_shifter[3] & bit_mask) > 0) << 1);
+        }
+
+        uint8_t foreground_color = 0x00;
+        uint8_t foreground_flag = 0x00;
+
+        if (_mask_render_foreground && (x > 8 || _mask_render_foreground_left)) {
+            foreground_color = foreground_colors[x - 1];
+            foreground_flag = foreground_flags[x - 1];
+        }
+
+        uint8_t final_pixel = background_pixel ? background_pixel | background_palette << 2 : 0x00;
+
+        if (foreground_color != 0x00) {
+            if (background_pixel == 0x00 || (foreground_flag & FLAG_PRIORITY)) {
+                final_pixel = foreground_color;
+            }
+
+            if (
+                background_pixel != 0x00
+                && (foreground_flag & FLAG_SPRITE_ZERO)
+                && x != 256
+                && _foreground_sprite_zero_line
+                && (x > 8 || _mask_render_background_left || _mask_render_foreground_left)
+            ) {
+                _status_sprite_zero_hit = true;
+            }
+        }
+
+        if (!_frame_skip) {
+            uint8_t color = palette[final_pixel & grayscale_mask];
+
+            if (_frame_format == FrameFormat::INDEXED) {
+                frame_indices[x - 1] = color;
+            } else {
+                memcpy(frame_buffer + (x - 1) * 3, PALETTE_COLORS[_mask_color_emphasize][color], 3);
+            }
+        }
+
+        if (_delay_data_read_counter > 0) {
+            _delay_data_read_counter--;
+        }
+
+        _nes.get_mapper().tick();
+    }
+
+    if (_mask_render_foreground) {
+        // Sprite shifters state after the 255 updates of the dots 2 to 256.
+        for (uint8_t sprite = 0; sprite < _foreground_sprite_count_next; sprite++) {
+            if (_foreground_positions[sprite] >= 255) {
+                _foreground_positions[sprite] -= 255;
+            } else {
+                uint8_t shifts = 255 - _foreground_positions[sprite];
+
+                if (shifts < 8) {
+                    _foreground_shifter[sprite * 2] <<= shifts;
+                    _foreground_shifter[sprite * 2 + 1] <<= shifts;
+                } else {
+                    _foreground_shifter[sprite * 2] = 0x00;
+                    _foreground_shifter[sprite * 2 + 1] = 0x00;
+                }
+
+                _foreground_positions[sprite] = 0;
+            }
+        }
+
+        _foreground_sprite_zero_hit = false;
+    }
+}
+
 uint8_t cynes::PPU::blend_colors() {
     if (!_rendering_enabled && (_register_v & 0x3FFF) >= 0x3F00) {
         return _register_v & 0x1F;
@@ -994,3 +1294,34 @@ uint8_t cynes::PPU::blend_colors() {
 
     return final_pixel;
 }
+
+void cynes::PPU::update_sprite_zero_hit() {
+    // Same side effects as `blend_colors`, without composing the pixel.
+    if (!_rendering_enabled && (_register_v & 0x3FFF) >= 0x3F00) {
+        return;
+    }
+
+    if (!_mask_render_foreground || (_current_x <= 8 && !_mask_render_foreground_left)) {
+        return;
+    }
+
+    // Slot 0 is always the first sprite evaluated, it wins as soon as it is opaque.
+    _foreground_sprite_zero_hit = _current_x != 256
+        && _foreground_sprite_count_next > 0
+        && _foreground_positions[0] == 0
+        && ((_foreground_shifter[0] | _foreground_shifter[1]) & 0x80);
+
+    if (!_foreground_sprite_zero_hit || !_foreground_sprite_zero_line) {
+        return;
+    }
+
+    if (!_mask_render_background || (_current_x <= 8 && !_mask_render_background_left)) {
+        return;
+    }
+
+    uint16_t bit_mask = 0x8000 >> _scroll_x;
+
+    if ((_background_shifter[0] | _background_shifter[1]) & bit_mask) {
+        _status_sprite_zero_hit = true;
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "utils.hpp"
 
@@ -10,6 +11,14 @@ namespace cynes {
 // Forward declaration.
 class NES;
 
+/// Frame buffer written by the PPU.
+/// @note The indexed frame buffer holds one palette index per pixel, along with the
+/// color emphasis of each scanline (sampled on its first pixel), and can be converted
+/// using the functions of `palette.hpp`.
+enum class FrameFormat : uint8_t {
+    RGB, INDEXED
+};
+
 /// Picture Processing Unit (see https://www.nesdev.org/wiki/PPU).
 class PPU {
 public:
@@ -29,6 +38,17 @@ public:
     /// Tick the PPU.
     void tick();
 
+    /// Tick the PPU for the given number of dots.
+    /// @param dots Number of dots to run.
+    void run(unsigned int dots);
+
+    /// Get the number of dots before the next event observable by the CPU.
+    /// @note Events are the edges of the non-maskable interrupt, the end of the frame and
+    /// the mapper interrupts. The distance is a lower bound, the PPU can be caught up
+    /// before the event actually happens.
+    /// @return The number of dots before the next event, at least 1.
+    unsigned int get_event_distance() const;
+
     /// Write to the PPU memory.
     /// @note This function has other side effects than simply writing to the memory, it
     /// should not be used as a memory set function.
@@ -46,21 +66,110 @@ public:
     /// Get a pointer to the internal frame buffer.
     const uint8_t* get_frame_buffer() const;
 
+    /// Get a pointer to the internal indexed frame buffer (240x256 palette indices).
+    const uint8_t* get_frame_indices() const;
+
+    /// Get a pointer to the color emphasis of each scanline of the indexed frame buffer.
+    const uint8_t* get_frame_emphasis() const;
+
+    /// Get a pointer to the internal frame buffer of the given slot.
+    /// @param slot Slot of the frame buffer, lower than `PPU::get_frame_count`.
+    const uint8_t* get_frame_buffer(size_t slot) const;
+
+    /// Get a pointer to the internal indexed frame buffer of the given slot.
+    /// @param slot Slot of the frame buffer, lower than `PPU::get_frame_count`.
+    const uint8_t* get_frame_indices(size_t slot) const;
+
+    /// Set the number of frame buffers the PPU rotates through, see `PPU::rotate_frame`.
+    /// @note The frame buffers are allocated on demand, but only released with the PPU,
+    /// so that pointers to them stay valid. The PPU keeps writing to the current slot,
+    /// or to the first one if the current slot is dropped.
+    /// @param count Number of frame buffers, at least 1.
+    void set_frame_count(size_t count);
+
+    /// Get the number of frame buffers the PPU rotates through.
+    size_t get_frame_count() const;
+
+    /// Move the composition to the next frame buffer.
+    /// @note The current frame buffer is left untouched until the composition comes back
+    /// to it, `PPU::get_frame_count` rotations later. The next frame buffer keeps its
+    /// previous content until it is composed into.
+    void rotate_frame();
+
+    /// Get the slot of the frame buffer currently composed into.
+    size_t get_frame_slot() const;
+
+    /// Select the frame buffer written by the PPU.
+    /// @note Only the selected frame buffer is updated, the other one keeps its previous
+    /// content.
+    /// @param format Frame buffer format.
+    void set_frame_format(FrameFormat format);
+
+    /// Get the frame buffer written by the PPU.
+    FrameFormat get_frame_format() const;
+
+    /// Get the current dot of the PPU within the frame (scanline * 341 + cycle).
+    unsigned int get_dot() const;
+
+    /// Get the number of dots during which reading $2002 gives the same value, besides
+    /// the events reported by `PPU::get_event_distance`.
+    /// @note The sprite flags are predicted from the OAM, without rendering anything.
+    /// @return The number of dots, 0 if the sprite flags may change.
+    unsigned int get_status_distance() const;
+
+    /// Check whether or not the OAM can be written through $2004 for the given number of
+    /// dots, without any rendering nor any new frame meanwhile.
+    /// @param dots Number of dots, starting from the current one.
+    /// @return True if every write of the window reaches the OAM, false otherwise.
+    bool can_transfer_oam(unsigned int dots) const;
+
+    /// Write a whole page to the OAM, as 256 successive writes to $2004 would.
+    /// @note The OAM should be writable, see `PPU::can_transfer_oam`.
+    /// @param data Page of 256 bytes.
+    void transfer_oam(const uint8_t* data);
+
+    /// Copy the frame buffer format and the content of the selected frame buffer of
+    /// another PPU.
+    /// @param other PPU to copy the frame from.
+    void copy_frame(const PPU& other);
+
     /// Check whether or not the frame is ready.
     /// @note Calling this function will reset the flag.
     /// @return True if the frame is ready, false otherwise.
     bool is_frame_ready();
 
+    /// Enable or disable the composition of the frame buffer.
+    /// @note While skipping, the PPU keeps every side effect of the rendering (sprite
+    /// zero hit, sprite overflow, mapper clocks, open bus, ...) but never writes pixels,
+    /// the frame buffer keeps its previous content.
+    /// @param skip True to skip the composition, false otherwise.
+    void set_frame_skip(bool skip);
+
 private:
     NES& _nes;
 
 private:
-    std::unique_ptr<uint8_t[]> _frame_buffer;
+    struct FrameSlot {
+        std::unique_ptr<uint8_t[]> buffer;
+        std::unique_ptr<uint8_t[]> indices;
+        std::unique_ptr<uint8_t[]> emphasis;
+    };
+
+    std::vector<FrameSlot> _frame_slots;
+    size_t _frame_count;
+    size_t _frame_slot;
+
+    uint8_t* _frame_buffer;
+    uint8_t* _frame_indices;
+    uint8_t* _frame_emphasis;
+
+    FrameFormat _frame_format;
 
     uint16_t _current_x;
     uint16_t _current_y;
 
     bool _frame_ready;
+    bool _frame_skip;
 
     bool _rendering_enabled;
     bool _rendering_enabled_delayed;
@@ -147,6 +256,12 @@ private:
     void update_foreground_shifter();
 
     uint8_t blend_colors();
+    void update_sprite_zero_hit();
+
+    bool is_scanline_quiet() const;
+    void render_scanline();
+
+    void select_frame_slot(size_t slot);
 
 private:
     enum class Register : uint8_t {
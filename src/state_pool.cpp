@@ -0,0 +1,200 @@
+#include "state_pool.hpp"
+
+#include "nes.hpp"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+// Slots are aligned on cache lines, so that two threads never write to the same line.
+constexpr size_t SLOT_ALIGNMENT = 0x40;
+
+
+cynes::StatePool::StatePool(size_t slot_size, size_t capacity, const std::string& path)
+    : _slot_size{slot_size}
+    , _slot_stride{(slot_size + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1)}
+    , _capacity{capacity}
+    , _arena{nullptr}
+    , _mapping_size{0}
+#if defined(_WIN32)
+    , _file{INVALID_HANDLE_VALUE}
+    , _mapping{nullptr}
+#else
+    , _file{-1}
+#endif
+    , _states(capacity, SlotState::FREE)
+{
+    if (slot_size == 0 || capacity == 0) {
+        throw std::invalid_argument("The slot size and the capacity should be positive.");
+    }
+
+    const size_t arena_size = _slot_stride * capacity;
+
+    if (path.empty()) {
+        _arena = static_cast<uint8_t*>(::operator new[](arena_size, std::align_val_t{SLOT_ALIGNMENT}));
+    } else {
+#if defined(_WIN32)
+        _file = CreateFileA(
+            path.c_str(),
+            GENERIC_READ | GENERIC_WRITE,
+            0,
+            nullptr,
+            CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr
+        );
+
+        if (_file != INVALID_HANDLE_VALUE) {
+            _mapping = CreateFileMappingA(
+                _file,
+                nullptr,
+                PAGE_READWRITE,
+                static_cast<DWORD>(uint64_t{arena_size} >> 32),
+                static_cast<DWORD>(arena_size & 0xFFFFFFFF),
+                nullptr
+            );
+        }
+
+        if (_mapping != nullptr) {
+            _arena = static_cast<uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, arena_size));
+        }
+#else
+        _file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+
+        if (_file >= 0 && ftruncate(_file, static_cast<off_t>(arena_size)) == 0) {
+            void* arena = mmap(nullptr, arena_size, PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+
+            if (arena != MAP_FAILED) {
+                _arena = static_cast<uint8_t*>(arena);
+            }
+        }
+#endif
+
+        if (_arena == nullptr) {
+#if defined(_WIN32)
+            if (_mapping != nullptr) {
+                CloseHandle(_mapping);
+            }
+
+            if (_file != INVALID_HANDLE_VALUE) {
+                CloseHandle(_file);
+            }
+#else
+            if (_file >= 0) {
+                close(_file);
+            }
+#endif
+
+            throw std::runtime_error("Failed to map the state pool file.");
+        }
+
+        _mapping_size = arena_size;
+    }
+
+    // Slots are handed out in increasing order.
+    _free_slots.reserve(capacity);
+
+    for (size_t slot = capacity; slot-- > 0;) {
+        _free_slots.push_back(slot);
+    }
+}
+
+cynes::StatePool::~StatePool() {
+    if (!is_mapped()) {
+        ::operator delete[](_arena, std::align_val_t{SLOT_ALIGNMENT});
+
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(_arena);
+    CloseHandle(_mapping);
+    CloseHandle(_file);
+#else
+    munmap(_arena, _mapping_size);
+    close(_file);
+#endif
+}
+
+size_t cynes::StatePool::allocate() {
+    if (_free_slots.empty()) {
+        throw std::runtime_error("The state pool is full.");
+    }
+
+    size_t slot = _free_slots.back();
+
+    _free_slots.pop_back();
+    _states[slot] = SlotState::ALLOCATED;
+
+    return slot;
+}
+
+void cynes::StatePool::release(size_t slot) {
+    check_slot(slot);
+
+    _states[slot] = SlotState::FREE;
+    _free_slots.push_back(slot);
+}
+
+void cynes::StatePool::save(NES& nes, size_t slot) {
+    check_emulator(nes);
+
+    nes.save(get_slot(slot));
+    _states[slot] = SlotState::SAVED;
+}
+
+void cynes::StatePool::load(NES& nes, size_t slot) {
+    check_emulator(nes);
+
+    if (!is_saved(slot)) {
+        throw std::invalid_argument("The slot does not hold a state.");
+    }
+
+    nes.load(get_slot(slot), static_cast<unsigned int>(_slot_size));
+}
+
+void cynes::StatePool::copy(size_t source, size_t destination) {
+    if (source == destination) {
+        check_slot(source);
+
+        return;
+    }
+
+    std::memcpy(get_slot(destination), get_slot(source), _slot_size);
+    _states[destination] = _states[source];
+}
+
+uint8_t* cynes::StatePool::get_slot(size_t slot) {
+    check_slot(slot);
+
+    return _arena + slot * _slot_stride;
+}
+
+bool cynes::StatePool::is_saved(size_t slot) const {
+    check_slot(slot);
+
+    return _states[slot] == SlotState::SAVED;
+}
+
+void cynes::StatePool::check_slot(size_t slot) const {
+    if (slot >= _capacity || _states[slot] == SlotState::FREE) {
+        throw std::out_of_range("The slot is not allocated.");
+    }
+}
+
+void cynes::StatePool::check_emulator(NES& nes) const {
+    if (nes.size() != _slot_size) {
+        throw std::invalid_argument("The save state size of the emulator does not match the slot size.");
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef __CYNES_STATE_POOL__
+#define __CYNES_STATE_POOL__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cynes {
+// Forward declaration.
+class NES;
+
+/// Fixed-size save state slots allocated from a single arena.
+/// @note The arena is either allocated at once on the heap, or mapped from a file when
+/// it should outgrow the physical memory. Slots are aligned on cache lines, allocating
+/// and releasing them only pushes and pops a free list. Saving and loading distinct
+/// slots from several threads is safe, allocating and releasing them is not.
+class StatePool {
+public:
+    /// Initialize the pool, every slot being free.
+    /// @param slot_size Size of a slot in bytes, usually `NES::size`.
+    /// @param capacity Number of slots.
+    /// @param path Path of the file backing the arena, empty to allocate it on the heap.
+    /// The file is created or truncated, and only used as a swap for the slots.
+    StatePool(size_t slot_size, size_t capacity, const std::string& path = "");
+
+    /// Release the arena.
+    ~StatePool();
+
+    StatePool(const StatePool&) = delete;
+    StatePool& operator=(const StatePool&) = delete;
+
+public:
+    /// Allocate a free slot.
+    /// @return The slot index.
+    size_t allocate();
+
+    /// Release an allocated slot.
+    /// @param slot Slot index.
+    void release(size_t slot);
+
+    /// Save the state of the emulator to a slot.
+    /// @param nes Emulator, whose `NES::size` should match the slot size.
+    /// @param slot Allocated slot index.
+    void save(NES& nes, size_t slot);
+
+    /// Load the state of the emulator from a slot.
+    /// @param nes Emulator, whose `NES::size` should match the slot size.
+    /// @param slot Allocated slot index, previously saved.
+    void load(NES& nes, size_t slot);
+
+    /// Copy the content of a slot to another one.
+    /// @param source Allocated source slot index.
+    /// @param destination Allocated destination slot index.
+    void copy(size_t source, size_t destination);
+
+    /// Get a pointer to the content of a slot.
+    /// @param slot Allocated slot index.
+    uint8_t* get_slot(size_t slot);
+
+    /// Check whether or not a slot holds a state, saved or copied since its allocation.
+    /// @param slot Allocated slot index.
+    bool is_saved(size_t slot) const;
+
+    /// Get the size of a slot in bytes.
+    inline size_t get_slot_size() const { return _slot_size; }
+
+    /// Get the number of slots.
+    inline size_t get_capacity() const { return _capacity; }
+
+    /// Get the number of free slots.
+    inline size_t get_free_count() const { return _free_slots.size(); }
+
+    /// Check whether or not the arena is mapped from a file.
+    inline bool is_mapped() const { return _mapping_size > 0; }
+
+private:
+    const size_t _slot_size;
+    const size_t _slot_stride;
+    const size_t _capacity;
+
+    uint8_t* _arena;
+    size_t _mapping_size;
+
+#if defined(_WIN32)
+    void* _file;
+    void* _mapping;
+#else
+    int _file;
+#endif
+
+    enum class SlotState : uint8_t {
+        FREE, ALLOCATED, SAVED
+    };
+
+    std::vector<size_t> _free_slots;
+
+    // Kept as bytes rather than bits, distinct slots are saved concurrently.
+    std::vector<SlotState> _states;
+
+private:
+    void check_slot(size_t slot) const;
+    void check_emulator(NES& nes) const;
+};
+}
+
+#endif
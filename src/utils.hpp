@@ -1,23 +1,79 @@
 #ifndef __CYNES_UTILS__
 #define __CYNES_UTILS__
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <type_traits>
+#include <vector>
 
 namespace cynes {
 enum class DumpOperation {
-    SIZE, DUMP, LOAD
+    SIZE, DUMP, LOAD, HASH
 };
 
+// Save states are stored in little-endian, whatever the endianness of the host.
+template<typename T>
+inline void write_little_endian(uint8_t* buffer, T value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        buffer[0] = value ? 0x01 : 0x00;
+    } else if constexpr (std::is_enum_v<T>) {
+        write_little_endian(buffer, static_cast<std::underlying_type_t<T>>(value));
+    } else {
+        static_assert(std::is_integral_v<T>, "Only integral types can be dumped.");
+
+        std::make_unsigned_t<T> bits = static_cast<std::make_unsigned_t<T>>(value);
+
+        for (size_t k = 0; k < sizeof(T); k++) {
+            buffer[k] = static_cast<uint8_t>(bits >> (k << 3));
+        }
+    }
+}
+
+template<typename T>
+inline T read_little_endian(const uint8_t* buffer) {
+    if constexpr (std::is_same_v<T, bool>) {
+        return buffer[0] != 0x00;
+    } else if constexpr (std::is_enum_v<T>) {
+        return static_cast<T>(read_little_endian<std::underlying_type_t<T>>(buffer));
+    } else {
+        static_assert(std::is_integral_v<T>, "Only integral types can be dumped.");
+
+        std::make_unsigned_t<T> bits = 0;
+
+        for (size_t k = 0; k < sizeof(T); k++) {
+            bits |= static_cast<std::make_unsigned_t<T>>(buffer[k]) << (k << 3);
+        }
+
+        return static_cast<T>(bits);
+    }
+}
+
+// Streaming hasher fed by `DumpOperation::HASH` (see hash.hpp).
+class Hasher;
+
+template<DumpOperation operation, typename T>
+constexpr void dump(Hasher& hasher, T& value);
+
+template<DumpOperation operation, typename T>
+constexpr void dump(Hasher& hasher, T* values, unsigned int size);
+
 template<DumpOperation operation, typename T>
 constexpr void dump(uint8_t*& buffer, T& value) {
-    if constexpr (operation == DumpOperation::DUMP) {
-        memcpy(buffer, &value, sizeof(T));
-    } else if constexpr (operation == DumpOperation::LOAD) {
-        memcpy(&value, buffer, sizeof(T));
-    }
+    if constexpr (std::is_array_v<T>) {
+        for (auto& element : value) {
+            dump<operation>(buffer, element);
+        }
+    } else {
+        if constexpr (operation == DumpOperation::DUMP) {
+            write_little_endian(buffer, value);
+        } else if constexpr (operation == DumpOperation::LOAD) {
+            value = read_little_endian<T>(buffer);
+        }
 
-    buffer += sizeof(T);
+        buffer += sizeof(T);
+    }
 }
 
 template<DumpOperation operation, typename T>
@@ -29,13 +85,19 @@ constexpr void dump(unsigned int& buffer_size, T&) {
 
 template<DumpOperation operation, typename T>
 constexpr void dump(uint8_t*& buffer, T* values, unsigned int size) {
-    if constexpr (operation == DumpOperation::DUMP) {
-        memcpy(buffer, values, sizeof(T) * size);
-    } else if constexpr (operation == DumpOperation::LOAD) {
-        memcpy(values, buffer, sizeof(T) * size);
-    }
+    if constexpr (sizeof(T) == 1 && !std::is_same_v<T, bool>) {
+        if constexpr (operation == DumpOperation::DUMP) {
+            memcpy(buffer, values, size);
+        } else if constexpr (operation == DumpOperation::LOAD) {
+            memcpy(values, buffer, size);
+        }
 
-    buffer += sizeof(T) * size;
+        buffer += size;
+    } else {
+        for (unsigned int k = 0; k < size; k++) {
+            dump<operation>(buffer, values[k]);
+        }
+    }
 }
 
 template<DumpOperation operation, typename T>
@@ -44,6 +106,77 @@ constexpr void dump(unsigned int& buffer_size, T*, unsigned int size) {
         buffer_size += sizeof(T) * size;
     }
 }
+
+/// Set of 1 KiB memory blocks, used to track the blocks written since a snapshot base.
+class BlockSet {
+public:
+    /// Initialize an empty set.
+    /// @param count Number of blocks that can be stored in the set.
+    BlockSet(size_t count) : _count{count}, _words((count + 0x3F) >> 6, 0) {}
+
+    /// Default destructor.
+    ~BlockSet() = default;
+
+public:
+    /// Add a block to the set.
+    /// @param index Block index.
+    inline void insert(size_t index) {
+        _words[index >> 6] |= uint64_t{1} << (index & 0x3F);
+    }
+
+    /// Add every block to the set.
+    void fill() {
+        for (size_t index = 0; index < _count; index++) {
+            insert(index);
+        }
+    }
+
+    /// Remove every block from the set.
+    void clear() {
+        std::fill(_words.begin(), _words.end(), 0);
+    }
+
+    /// Get the number of blocks that can be stored in the set.
+    inline size_t capacity() const { return _count; }
+
+    /// Count the blocks stored in the set.
+    size_t count() const {
+        size_t count = 0;
+
+        for_each([&count](size_t) { count++; });
+
+        return count;
+    }
+
+    /// Run the given function on every block of the set, in increasing order.
+    /// @note Empty words are skipped, the cost is proportional to the number of blocks
+    /// stored rather than to the capacity of the set.
+    /// @param function Function called with the index of each block.
+    template<typename F>
+    void for_each(F function) const {
+        for (size_t word = 0; word < _words.size(); word++) {
+            uint64_t bits = _words[word];
+
+            while (bits) {
+                uint64_t lowest = bits & (~bits + 1);
+                size_t index = word << 6;
+
+                while (!(lowest & 0x1)) {
+                    lowest >>= 1;
+                    index++;
+                }
+
+                function(index);
+
+                bits &= bits - 1;
+            }
+        }
+    }
+
+private:
+    size_t _count;
+    std::vector<uint64_t> _words;
+};
 }
 
 #endif
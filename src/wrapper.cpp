@@ -1,58 +1,1516 @@
 #include "wrapper.hpp"
 #include "nes.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <pybind11/cast.h>
 #include <pybind11/detail/common.h>
 #include <pybind11/pybind11.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CYNES_STREAM_STORES
+#endif
+
+
+namespace {
+/// Size of the frame buffers of a batch from which they are written with non-temporal
+/// stores, past the size of the usual last level caches.
+constexpr size_t STREAM_BATCH_SIZE = size_t(32) << 20;
+
+/// Copy a frame buffer into the frame buffers of a batch.
+/// @note The frame buffers of a large batch would not stay in the caches until they
+/// are read back, once every emulator has been stepped, so they are written around the
+/// caches with non-temporal stores when possible.
+/// @param destination Frame buffer of the batch.
+/// @param source Frame buffer of the emulator.
+/// @param size Size of the frame buffer in bytes.
+/// @param batch_size Size of the frame buffers of the whole batch in bytes.
+void copy_frame(uint8_t* destination, const uint8_t* source, size_t size, size_t batch_size) {
+#ifdef CYNES_STREAM_STORES
+    if (
+        batch_size >= STREAM_BATCH_SIZE
+        && reinterpret_cast<uintptr_t>(destination) % 16 == 0
+        && size % 16 == 0
+    ) {
+        for (size_t offset = 0; offset < size; offset += 16) {
+            _mm_stream_si128(
+                reinterpret_cast<__m128i*>(destination + offset),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + offset))
+            );
+        }
+
+        _mm_sfence();
+
+        return;
+    }
+#endif
+
+    std::memcpy(destination, source, size);
+}
+
+std::vector<size_t> get_converted_shape(cynes::palette::PixelFormat format, uint8_t downsample) {
+    if (downsample != 1 && (format != cynes::palette::PixelFormat::LUMA || (downsample != 2 && downsample != 4))) {
+        throw std::invalid_argument("Only luma frames can be downsampled, by a factor of 2 or 4.");
+    }
+
+    switch (format) {
+    case cynes::palette::PixelFormat::RGB24: return {240, 256, 3};
+    case cynes::palette::PixelFormat::RGBA32: return {240, 256, 4};
+    default: return {size_t(240 / downsample), size_t(256 / downsample)};
+    }
+}
+
+size_t get_converted_size(const std::vector<size_t>& shape) {
+    size_t size = 1;
+
+    for (size_t dimension : shape) {
+        size *= dimension;
+    }
+
+    return size;
+}
+
+uint8_t* get_state_buffer(
+    const pybind11::buffer_info& info,
+    const std::vector<size_t>& shape
+) {
+    bool valid = info.itemsize == 1 && static_cast<size_t>(info.ndim) == shape.size();
+    size_t stride = 1;
+
+    for (size_t k = shape.size(); valid && k-- > 0;) {
+        valid = static_cast<size_t>(info.shape[k]) == shape[k]
+            && (shape[k] < 2 || static_cast<size_t>(info.strides[k]) == stride);
+
+        stride *= shape[k];
+    }
+
+    if (!valid) {
+        std::string expected{};
+
+        for (size_t dimension : shape) {
+            expected += (expected.empty() ? "" : ", ") + std::to_string(dimension);
+        }
+
+        throw std::invalid_argument(
+            "The save state buffer should be a contiguous buffer of bytes with a shape of ("
+            + expected + ")."
+        );
+    }
+
+    return static_cast<uint8_t*>(info.ptr);
+}
+
+void check_state(cynes::NES& nes, uint8_t* buffer, size_t size) {
+    if (const char* error = nes.check_state(buffer, static_cast<unsigned int>(size))) {
+        throw std::invalid_argument(error);
+    }
+}
+
+std::vector<size_t> get_pool_slots(
+    cynes::StatePool& pool,
+    const pybind11::array_t<uint64_t, pybind11::array::c_style | pybind11::array::forcecast>& slots,
+    size_t count,
+    size_t state_size
+) {
+    if (pool.get_slot_size() != state_size) {
+        throw std::invalid_argument("The save state size of the emulators does not match the slot size.");
+    }
+
+    if (slots.ndim() != 1 || static_cast<size_t>(slots.shape(0)) != count) {
+        throw std::invalid_argument("The slots should have a shape of (N,).");
+    }
+
+    std::vector<size_t> indices(count);
+
+    // Every slot is checked before the GIL is released, the worker threads cannot
+    // report errors.
+    for (size_t index = 0; index < count; index++) {
+        indices[index] = static_cast<size_t>(slots.data()[index]);
+        pool.get_slot(indices[index]);
+    }
+
+    return indices;
+}
+
+pybind11::array_t<uint64_t> allocate_slots(cynes::StatePool& pool, size_t count) {
+    if (count > pool.get_free_count()) {
+        throw std::runtime_error("The state pool is full.");
+    }
+
+    pybind11::array_t<uint64_t> slots{static_cast<int>(count)};
+    uint64_t* data = slots.mutable_data();
+
+    for (size_t index = 0; index < count; index++) {
+        data[index] = pool.allocate();
+    }
+
+    return slots;
+}
+
+void check_indexed(cynes::FrameFormat format) {
+    if (format != cynes::FrameFormat::INDEXED) {
+        throw std::runtime_error("The frame buffer format should be INDEXED to be converted.");
+    }
+}
+
+pybind11::array_t<uint8_t> get_frame_stack_view(
+    const cynes::FrameStack& frame_stack,
+    std::vector<size_t> shape
+) {
+    std::vector<size_t> observation = get_converted_shape(
+        frame_stack.get_format(),
+        frame_stack.get_factor()
+    );
+
+    shape.insert(shape.end(), observation.begin(), observation.end());
+
+    std::vector<size_t> strides(shape.size(), 1);
+
+    for (size_t k = shape.size() - 1; k-- > 0;) {
+        strides[k] = strides[k + 1] * shape[k + 1];
+    }
+
+    pybind11::array_t<uint8_t> view{
+        shape,
+        strides,
+        frame_stack.get_data(),
+        pybind11::capsule(frame_stack.get_data(), [](void *) {})
+    };
+
+    pybind11::detail::array_proxy(view.ptr())->flags &= ~pybind11::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+
+    return view;
+}
+
+void check_frame_stack(const std::unique_ptr<cynes::FrameStack>& frame_stack) {
+    if (!frame_stack) {
+        throw std::runtime_error("The frame stack should be enabled first.");
+    }
+}
+
+template <typename T>
+pybind11::array_t<T> get_read_only_view(const T* data, const std::vector<size_t>& shape) {
+    std::vector<size_t> strides(shape.size(), sizeof(T));
+
+    for (size_t k = shape.size() - 1; k-- > 0;) {
+        strides[k] = strides[k + 1] * shape[k + 1];
+    }
+
+    pybind11::array_t<T> view{shape, strides, data, pybind11::capsule(data, [](void *) {})};
+
+    pybind11::detail::array_proxy(view.ptr())->flags &= ~pybind11::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+
+    return view;
+}
+
+const cynes::AudioSynthesizer& get_audio_synthesizer(const cynes::NES& nes) {
+    if (nes.apu.get_audio() == nullptr) {
+        throw std::runtime_error("The audio should be enabled first.");
+    }
+
+    return *nes.apu.get_audio();
+}
+
+/// Output buffers of a tape run, null when not captured.
+struct TapeCapture {
+    uint8_t* frames;
+    uint8_t* states;
+    uint8_t* watch_values;
+};
+
+size_t get_tape_captures(size_t length, uint32_t capture_every) {
+    if (length == 0) {
+        throw std::invalid_argument("The tape should contain at least one action.");
+    }
+
+    return capture_every > 0 ? length / capture_every : 1;
+}
+
+size_t get_frame_size(const cynes::NES& nes) {
+    return nes.ppu.get_frame_format() == cynes::FrameFormat::INDEXED ? 0xF000 : 0x2D000;
+}
+
+void capture_tape(cynes::NES& nes, const TapeCapture& capture, size_t index, size_t state_size) {
+    if (capture.frames != nullptr) {
+        const size_t frame_size = get_frame_size(nes);
+        const uint8_t* frame = frame_size == 0xF000 ? nes.get_frame_indices() : nes.get_frame_buffer();
+
+        std::memcpy(capture.frames + index * frame_size, frame, frame_size);
+    }
+
+    if (capture.states != nullptr) {
+        nes.save(capture.states + index * state_size);
+    }
+
+    if (capture.watch_values != nullptr) {
+        const size_t watch_size = nes.get_watch_size();
+
+        std::memcpy(capture.watch_values + index * watch_size, nes.get_watch_values(), watch_size);
+    }
+}
+
+// Step the emulator through the tape, capturing every `capture_every` actions (only at
+// the end of the tape when 0). The tape stops early when the CPU freezes or when a done
+// condition is met, the number of actions run is returned. When only the end of the
+// tape is captured, every action is rendered if a done condition may end it early.
+size_t run_tape(
+    cynes::NES& nes,
+    const uint16_t* controllers,
+    size_t length,
+    uint32_t frames_per_action,
+    uint32_t capture_every,
+    const TapeCapture& capture,
+    size_t state_size,
+    bool& crashed
+) {
+    size_t action = 0;
+
+    const bool may_end_early = capture_every == 0 && nes.has_done_conditions();
+
+    while (action < length && !crashed) {
+        bool captured = capture_every > 0 && (action + 1) % capture_every == 0;
+        bool rendered = capture.frames != nullptr && (captured || may_end_early || action + 1 == length);
+
+        crashed |= nes.step(
+            controllers[action],
+            frames_per_action,
+            rendered ? cynes::RenderPolicy::LAST : cynes::RenderPolicy::NONE
+        );
+
+        action++;
+
+        if (captured) {
+            capture_tape(nes, capture, action / capture_every - 1, state_size);
+        }
+
+        if (nes.is_done()) {
+            break;
+        }
+    }
+
+    if (capture_every == 0) {
+        capture_tape(nes, capture, 0, state_size);
+    }
+
+    return action;
+}
+
+std::vector<uint16_t> get_watch_addresses(
+    const pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast>& addresses
+) {
+    if (addresses.ndim() != 1) {
+        throw std::invalid_argument("The watched addresses should have a shape of (K,).");
+    }
+
+    return {addresses.data(), addresses.data() + addresses.shape(0)};
+}
+}
+
+
+cynes::wrapper::RomWrapper::RomWrapper(const char* path_rom)
+    : _cartridge{Cartridge::load(path_rom)} {}
+
+cynes::wrapper::RomWrapper::RomWrapper(std::shared_ptr<const Cartridge> cartridge)
+    : _cartridge{std::move(cartridge)} {}
+
+cynes::wrapper::RomWrapper cynes::wrapper::RomWrapper::from_bytes(pybind11::buffer data) {
+    pybind11::buffer_info info = data.request();
+
+    if (info.ndim != 1 || info.itemsize != 1 || (info.size > 1 && info.strides[0] != 1)) {
+        throw std::invalid_argument("The ROM should be a contiguous buffer of bytes.");
+    }
+
+    return RomWrapper{Cartridge::load(
+        static_cast<const uint8_t*>(info.ptr),
+        static_cast<size_t>(info.size)
+    )};
+}
+
+
+cynes::wrapper::NesWrapper::NesWrapper(const char* path_rom)
+    : NesWrapper{RomWrapper{path_rom}} {}
+
+cynes::wrapper::NesWrapper::NesWrapper(const RomWrapper& rom)
+    : controller{0x00}
+    , _nes{rom.get_cartridge()}
+    , _save_state_size{_nes.size()}
+    , _crashed{false}
+    , _step_controllers{0x00}
+    , _step_frames{0}
+    , _step_render{RenderPolicy::NONE}
+    , _step_pending{false}
+    , _step_stop{false}
+{
+    add_frame_views();
+}
+
+cynes::wrapper::NesWrapper::NesWrapper(NesWrapper& other)
+    : controller{other.controller}
+    , _nes{other._nes}
+    , _save_state_size{other._save_state_size}
+    , _crashed{other._crashed}
+    , _step_controllers{0x00}
+    , _step_frames{0}
+    , _step_render{RenderPolicy::NONE}
+    , _step_pending{false}
+    , _step_stop{false}
+{
+    add_frame_views();
+
+    if (other._frame_stack) {
+        _frame_stack.reset(new FrameStack{*other._frame_stack});
+        _frame_stack_view = get_frame_stack_view(*_frame_stack, {_frame_stack->get_depth()});
+    }
+}
+
+cynes::wrapper::NesWrapper::~NesWrapper() {
+    if (!_step_worker.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{_step_mutex};
+        _step_stop = true;
+    }
+
+    // The worker runs the pending step, if any, before stopping.
+    _step_condition.notify_all();
+    _step_worker.join();
+}
+
+std::unique_ptr<cynes::wrapper::NesWrapper> cynes::wrapper::NesWrapper::copy() {
+    join_step();
+
+    return std::unique_ptr<NesWrapper>{new NesWrapper{*this}};
+}
+
+const pybind11::array_t<uint8_t>& cynes::wrapper::NesWrapper::step(
+    uint32_t frames,
+    RenderPolicy render
+) {
+    join_step();
+    run_step(controller, frames, render);
+
+    return get_frame();
+}
+
+void cynes::wrapper::NesWrapper::step_async(uint32_t frames, RenderPolicy render) {
+    join_step();
+
+    if (render != RenderPolicy::NONE) {
+        _nes.ppu.rotate_frame();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{_step_mutex};
+
+        _step_controllers = controller;
+        _step_frames = frames;
+        _step_render = render;
+        _step_pending = true;
+    }
+
+    if (!_step_worker.joinable()) {
+        _step_worker = std::thread{&NesWrapper::run_step_worker, this};
+    }
+
+    _step_condition.notify_all();
+}
+
+const pybind11::array_t<uint8_t>& cynes::wrapper::NesWrapper::wait() {
+    {
+        pybind11::gil_scoped_release release{};
+        join_step();
+    }
+
+    return get_frame();
+}
+
+void cynes::wrapper::NesWrapper::set_frame_count(size_t count) {
+    join_step();
+
+    _nes.ppu.set_frame_count(count);
+    add_frame_views();
+}
+
+void cynes::wrapper::NesWrapper::run_step(
+    uint16_t controllers,
+    uint32_t frames,
+    RenderPolicy render
+) {
+    if (_frame_stack) {
+        _crashed |= _frame_stack->step(0, _nes, controllers, frames, render);
+        _frame_stack->advance();
+    } else {
+        _crashed |= _nes.step(controllers, frames, render);
+    }
+}
+
+void cynes::wrapper::NesWrapper::join_step() const {
+    if (!_step_worker.joinable()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock{_step_mutex};
+    _step_condition.wait(lock, [this] { return !_step_pending; });
+
+    if (_step_error) {
+        std::rethrow_exception(std::exchange(_step_error, nullptr));
+    }
+}
+
+void cynes::wrapper::NesWrapper::run_step_worker() {
+    std::unique_lock<std::mutex> lock{_step_mutex};
+
+    while (true) {
+        _step_condition.wait(lock, [this] { return _step_pending || _step_stop; });
+
+        if (!_step_pending) {
+            return;
+        }
+
+        // The caller waits for the step before touching the emulator or the arguments.
+        lock.unlock();
+
+        try {
+            run_step(_step_controllers, _step_frames, _step_render);
+        } catch (...) {
+            _step_error = std::current_exception();
+        }
+
+        lock.lock();
+
+        _step_pending = false;
+        _step_condition.notify_all();
+    }
+}
+
+void cynes::wrapper::NesWrapper::add_frame_views() {
+    // The frame buffers of the PPU are never released, the views stay valid.
+    for (size_t slot = _frames.size(); slot < _nes.ppu.get_frame_count(); slot++) {
+        _frames.push_back(get_read_only_view(_nes.ppu.get_frame_buffer(slot), {240, 256, 3}));
+        _frames_indices.push_back(get_read_only_view(_nes.ppu.get_frame_indices(slot), {240, 256}));
+    }
+}
+
+const pybind11::array_t<uint8_t>& cynes::wrapper::NesWrapper::get_frame() const {
+    const size_t slot = _nes.ppu.get_frame_slot();
+
+    if (get_frame_format() == FrameFormat::INDEXED) {
+        return _frames_indices[slot];
+    }
+
+    return _frames[slot];
+}
+
+cynes::StepResult cynes::wrapper::NesWrapper::step_until(
+    uint32_t frames,
+    RenderPolicy render,
+    uint64_t max_instructions,
+    uint64_t max_cycles,
+    double max_seconds,
+    pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> breakpoints,
+    bool stop_on_watch_change
+) {
+    join_step();
+
+    if (breakpoints.ndim() != 1) {
+        throw std::invalid_argument("The breakpoints should have a shape of (K,).");
+    }
+
+    StepOptions options{};
+    options.max_instructions = max_instructions;
+    options.max_cycles = max_cycles;
+    options.max_seconds = max_seconds;
+    options.breakpoints.assign(breakpoints.data(), breakpoints.data() + breakpoints.shape(0));
+    options.stop_on_watch_change = stop_on_watch_change;
+
+    StepResult result;
+
+    {
+        pybind11::gil_scoped_release release{};
+        result = _nes.step_until(controller, frames, options, render);
+    }
+
+    _crashed |= result.reason == StopReason::CRASHED;
+
+    return result;
+}
+
+void cynes::wrapper::NesWrapper::set_watch_list(
+    pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> addresses
+) {
+    join_step();
+
+    _nes.set_watch_list(get_watch_addresses(addresses));
+}
+
+pybind11::array_t<uint8_t> cynes::wrapper::NesWrapper::get_watch_values() const {
+    join_step();
+
+    pybind11::array_t<uint8_t> values{static_cast<int>(_nes.get_watch_size())};
+    std::memcpy(values.mutable_data(), _nes.get_watch_values(), _nes.get_watch_size());
+
+    return values;
+}
+
+pybind11::dict cynes::wrapper::NesWrapper::run_tape(
+    pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> controllers,
+    uint32_t frames_per_action,
+    uint32_t capture_every,
+    bool capture_frames,
+    bool capture_states,
+    bool capture_watch
+) {
+    join_step();
+
+    if (controllers.ndim() != 1) {
+        throw std::invalid_argument("The tape should have a shape of (T,).");
+    }
+
+    const size_t length = static_cast<size_t>(controllers.shape(0));
+    const size_t captures = get_tape_captures(length, capture_every);
+
+    pybind11::dict result{};
+    TapeCapture capture{nullptr, nullptr, nullptr};
+
+    if (capture_frames) {
+        std::vector<size_t> shape{captures, 240, 256};
+
+        if (get_frame_format() == FrameFormat::RGB) {
+            shape.push_back(3);
+        }
+
+        pybind11::array_t<uint8_t> frames{shape};
+        std::memset(frames.mutable_data(), 0x00, captures * get_frame_size(_nes));
+
+        capture.frames = frames.mutable_data();
+        result["frames"] = frames;
+    }
+
+    if (capture_states) {
+        pybind11::array_t<uint8_t> states{std::vector<size_t>{captures, _save_state_size}};
+        std::memset(states.mutable_data(), 0x00, captures * _save_state_size);
+
+        capture.states = states.mutable_data();
+        result["states"] = states;
+    }
+
+    if (capture_watch) {
+        pybind11::array_t<uint8_t> values{std::vector<size_t>{captures, _nes.get_watch_size()}};
+        std::memset(values.mutable_data(), 0x00, captures * _nes.get_watch_size());
+
+        capture.watch_values = values.mutable_data();
+        result["watch_values"] = values;
+    }
+
+    size_t actions;
+
+    {
+        pybind11::gil_scoped_release release{};
+
+        actions = ::run_tape(
+            _nes,
+            controllers.data(),
+            length,
+            frames_per_action,
+            capture_every,
+            capture,
+            _save_state_size,
+            _crashed
+        );
+    }
+
+    result["length"] = actions;
+
+    return result;
+}
+
+void cynes::wrapper::NesWrapper::set_frame_format(FrameFormat format) {
+    join_step();
+
+    if (_frame_stack && format != FrameFormat::INDEXED) {
+        throw std::runtime_error("The frame buffer format should stay INDEXED while the frame stack is enabled.");
+    }
+
+    _nes.ppu.set_frame_format(format);
+}
+
+void cynes::wrapper::NesWrapper::enable_frame_stack(
+    size_t depth,
+    palette::PixelFormat format,
+    uint8_t downsample,
+    bool max_pool
+) {
+    join_step();
+
+    check_indexed(get_frame_format());
+
+    _frame_stack.reset(new FrameStack{1, depth, format, downsample, max_pool});
+    _frame_stack->fill(0, _nes);
+    _frame_stack_view = get_frame_stack_view(*_frame_stack, {depth});
+}
+
+void cynes::wrapper::NesWrapper::disable_frame_stack() {
+    join_step();
+
+    _frame_stack_view = pybind11::array_t<uint8_t>{};
+    _frame_stack.reset();
+}
+
+void cynes::wrapper::NesWrapper::reset_frame_stack() {
+    join_step();
+
+    check_frame_stack(_frame_stack);
+
+    _frame_stack->fill(0, _nes);
+}
+
+const pybind11::array_t<uint8_t>& cynes::wrapper::NesWrapper::get_frame_stack() const {
+    join_step();
+
+    check_frame_stack(_frame_stack);
+
+    return _frame_stack_view;
+}
+
+size_t cynes::wrapper::NesWrapper::get_frame_stack_start() const {
+    join_step();
+
+    check_frame_stack(_frame_stack);
+
+    return _frame_stack->get_start();
+}
+
+void cynes::wrapper::NesWrapper::enable_audio(unsigned int sample_rate, size_t depth) {
+    join_step();
+
+    _nes.apu.enable_audio(sample_rate, depth);
+
+    const AudioSynthesizer& audio = *_nes.apu.get_audio();
+
+    _audio_view = get_read_only_view(audio.get_data(), {depth, audio.get_frame_capacity()});
+    _audio_lengths_view = get_read_only_view(audio.get_lengths(), {depth});
+}
+
+void cynes::wrapper::NesWrapper::disable_audio() {
+    join_step();
+
+    _audio_view = pybind11::array_t<float>{};
+    _audio_lengths_view = pybind11::array_t<uint32_t>{};
+    _nes.apu.disable_audio();
+}
+
+const pybind11::array_t<float>& cynes::wrapper::NesWrapper::get_audio() const {
+    join_step();
+
+    get_audio_synthesizer(_nes);
+
+    return _audio_view;
+}
+
+const pybind11::array_t<uint32_t>& cynes::wrapper::NesWrapper::get_audio_lengths() const {
+    join_step();
+
+    get_audio_synthesizer(_nes);
+
+    return _audio_lengths_view;
+}
+
+size_t cynes::wrapper::NesWrapper::get_audio_start() const {
+    join_step();
+
+    return get_audio_synthesizer(_nes).get_start();
+}
+
+pybind11::array_t<float> cynes::wrapper::NesWrapper::read_audio(size_t frames) const {
+    join_step();
+
+    const AudioSynthesizer& audio = get_audio_synthesizer(_nes);
+
+    if (frames == 0 || frames > audio.get_depth()) {
+        throw std::invalid_argument("The number of frames should be between 1 and the depth of the ring.");
+    }
+
+    const size_t depth = audio.get_depth();
+    const size_t first = (audio.get_start() + depth - frames) % depth;
+
+    size_t length = 0;
+
+    for (size_t k = 0; k < frames; k++) {
+        length += audio.get_lengths()[(first + k) % depth];
+    }
+
+    pybind11::array_t<float> samples{static_cast<int>(length)};
+    float* output = samples.mutable_data();
+
+    for (size_t k = 0; k < frames; k++) {
+        const size_t slot = (first + k) % depth;
+        const size_t count = audio.get_lengths()[slot];
+
+        std::memcpy(output, audio.get_data() + slot * audio.get_frame_capacity(), count * sizeof(float));
+        output += count;
+    }
+
+    return samples;
+}
+
+pybind11::array_t<uint8_t> cynes::wrapper::NesWrapper::convert_frame(
+    palette::PixelFormat format,
+    uint8_t downsample
+) {
+    join_step();
+
+    check_indexed(get_frame_format());
+
+    pybind11::array_t<uint8_t> frame{get_converted_shape(format, downsample)};
+
+    palette::convert(
+        _nes.get_frame_indices(),
+        _nes.get_frame_emphasis(),
+        frame.mutable_data(),
+        format,
+        downsample
+    );
+
+    return frame;
+}
+
+pybind11::array_t<uint8_t> cynes::wrapper::NesWrapper::save(bool compress) {
+    join_step();
+
+    if (!compress) {
+        pybind11::array_t<uint8_t> buffer{static_cast<int>(_save_state_size)};
+        _nes.save(buffer.mutable_data());
+        return buffer;
+    }
+
+    if (!_compressed_buffer) {
+        _compressed_buffer.reset(new uint8_t[_nes.compressed_size_bound()]);
+    }
+
+    unsigned int size = _nes.save_compressed(_compressed_buffer.get());
+
+    pybind11::array_t<uint8_t> buffer{static_cast<int>(size)};
+    std::memcpy(buffer.mutable_data(), _compressed_buffer.get(), size);
+    return buffer;
+}
+
+void cynes::wrapper::NesWrapper::load(
+    pybind11::array_t<uint8_t, pybind11::array::c_style | pybind11::array::forcecast> buffer
+) {
+    join_step();
+
+    _nes.load(buffer.mutable_data(), static_cast<unsigned int>(buffer.size()));
+    _crashed = false;
+}
+
+void cynes::wrapper::NesWrapper::save_into(pybind11::buffer buffer) {
+    join_step();
+
+    pybind11::buffer_info info = buffer.request(true);
+    _nes.save(get_state_buffer(info, {_save_state_size}));
+}
+
+void cynes::wrapper::NesWrapper::load_from(pybind11::buffer buffer) {
+    join_step();
+
+    pybind11::buffer_info info = buffer.request();
+    uint8_t* data = get_state_buffer(info, {static_cast<size_t>(info.size)});
+
+    _nes.load(data, static_cast<unsigned int>(info.size));
+    _crashed = false;
+}
+
+void cynes::wrapper::NesWrapper::load_slot(StatePool& pool, size_t slot) {
+    join_step();
+
+    pool.load(_nes, slot);
+    _crashed = false;
+}
+
+pybind11::array_t<uint8_t> cynes::wrapper::NesWrapper::save_snapshot() {
+    join_step();
+
+    if (!_nes.has_snapshot_base()) {
+        throw std::runtime_error("The snapshot base has not been set.");
+    }
+
+    pybind11::array_t<uint8_t> buffer{static_cast<int>(_nes.snapshot_size())};
+    _nes.save_snapshot(buffer.mutable_data());
+    return buffer;
+}
+
+void cynes::wrapper::NesWrapper::load_snapshot(
+    pybind11::array_t<uint8_t, pybind11::array::c_style | pybind11::array::forcecast> buffer
+) {
+    join_step();
+
+    _nes.load_snapshot(buffer.mutable_data(), static_cast<unsigned int>(buffer.size()));
+    _crashed = false;
+}
+
+pybind11::array_t<uint8_t> cynes::wrapper::NesWrapper::read_all_ram() {
+    join_step();
+
+    constexpr size_t ram_size = 2048; // NES RAM is 2KB
+    const uint8_t* ram_ptr = _nes.get_ram_pointer();
+
+    // Create a capsule to manage the memory lifetime (i.e., do nothing, as _nes owns it)
+    pybind11::capsule no_delete(ram_ptr, [](void* p) { /* do nothing */ });
+
+    // Return a NumPy array that views the C++ memory without copying it
+    return pybind11::array_t<uint8_t>(
+        {ram_size},         // Shape of the array
+        {sizeof(uint8_t)},  // Strides (bytes to step for each element)
+        ram_ptr,            // Pointer to the data
+        no_delete           // The capsule
+    );
+}
+
+cynes::wrapper::ThreadPool::ThreadPool(size_t threads)
+    : _ranges{new Range[std::max<size_t>(threads, 1)]}
+    , _task{nullptr}
+    , _active{0}
+    , _generation{0}
+    , _stop{false}
+{
+    for (size_t k = 1; k < threads; k++) {
+        _workers.emplace_back(&ThreadPool::run_worker, this, k);
+    }
+}
+
+cynes::wrapper::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _stop = true;
+    }
+
+    _condition_start.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void cynes::wrapper::ThreadPool::parallel_for(
+    size_t count,
+    const std::function<void(size_t)>& task
+) {
+    if (_workers.empty() || count < 2) {
+        for (size_t index = 0; index < count; index++) {
+            task(index);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+
+        const size_t threads = _workers.size() + 1;
+
+        for (size_t thread = 0; thread < threads; thread++) {
+            _ranges[thread].next = count * thread / threads;
+            _ranges[thread].end = count * (thread + 1) / threads;
+        }
+
+        _task = &task;
+        _active = _workers.size();
+        _generation++;
+    }
+
+    _condition_start.notify_all();
+
+    run_task(0);
+
+    std::unique_lock<std::mutex> lock{_mutex};
+    _condition_done.wait(lock, [this] { return _active == 0; });
+
+    _task = nullptr;
+
+    // The workers are done with the task, its exception can leave the call.
+    if (_error) {
+        std::rethrow_exception(std::exchange(_error, nullptr));
+    }
+}
+
+void cynes::wrapper::ThreadPool::run_worker(size_t thread) {
+    uint64_t generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _condition_start.wait(lock, [&] { return _stop || _generation != generation; });
+
+            if (_stop) {
+                return;
+            }
+
+            generation = _generation;
+        }
+
+        run_task(thread);
+
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            if (--_active == 0) {
+                _condition_done.notify_one();
+            }
+        }
+    }
+}
+
+void cynes::wrapper::ThreadPool::run_task(size_t thread) {
+    const size_t threads = _workers.size() + 1;
+
+    // The own range of the thread comes first, then the ones of the other threads.
+    for (size_t k = 0; k < threads; k++) {
+        Range& range = _ranges[(thread + k) % threads];
+        size_t index;
+
+        while ((index = range.next.fetch_add(1)) < range.end) {
+            try {
+                (*_task)(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock{_mutex};
+
+                if (!_error) {
+                    _error = std::current_exception();
+                }
+            }
+        }
+    }
+}
+
+
+cynes::wrapper::VecNesWrapper::VecNesWrapper(
+    const char* path_rom,
+    size_t count,
+    size_t threads
+) : VecNesWrapper{RomWrapper{path_rom}, count, threads} {}
+
+cynes::wrapper::VecNesWrapper::VecNesWrapper(
+    const RomWrapper& rom,
+    size_t count,
+    size_t threads
+) : _controllers(count, 0x00)
+  , _lockstep{false}
+  , _stepped_count{0}
+  , _hashes(count, 0)
+  , _leaders(count, 0)
+  , _frames{new uint8_t[count * 0x2D000]}
+  , _crashed{new bool[count]}
+  , _done{new bool[count]}
+  , _frame_format{FrameFormat::RGB}
+  , _pool{std::min(count, threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))}
+{
+    if (count == 0) {
+        throw std::invalid_argument("The number of emulators should be positive.");
+    }
+
+    _emulators.resize(count);
+    _emulators.front().reset(new NES{rom.get_cartridge()});
+
+    // The other emulators and their frame buffers are created by the threads stepping
+    // them, so that their memory is first touched (and thus placed) close to these
+    // threads. The first one is created first, as the mapper may not be supported.
+    _pool.parallel_for(count, [this, &rom](size_t index) {
+        if (index > 0) {
+            _emulators[index].reset(new NES{rom.get_cartridge()});
+        }
+
+        std::memset(_frames.get() + index * 0x2D000, 0x00, 0x2D000);
+    });
+
+    _save_state_size = _emulators.front()->size();
+
+    std::memset(_crashed.get(), false, count);
+    std::memset(_done.get(), false, count);
+
+    _frames_view = pybind11::array_t<uint8_t>{
+        {count, size_t(240), size_t(256), size_t(3)},
+        {size_t(0x2D000), size_t(256 * 3), size_t(3), size_t(1)},
+        _frames.get(),
+        pybind11::capsule(_frames.get(), [](void *) {})
+    };
+
+    _indices_view = pybind11::array_t<uint8_t>{
+        {count, size_t(240), size_t(256)},
+        {size_t(0xF000), size_t(256), size_t(1)},
+        _frames.get(),
+        pybind11::capsule(_frames.get(), [](void *) {})
+    };
+
+    _crashed_view = pybind11::array_t<bool>{
+        {count},
+        {sizeof(bool)},
+        _crashed.get(),
+        pybind11::capsule(_crashed.get(), [](void *) {})
+    };
+
+    _done_view = pybind11::array_t<bool>{
+        {count},
+        {sizeof(bool)},
+        _done.get(),
+        pybind11::capsule(_done.get(), [](void *) {})
+    };
+
+    pybind11::detail::array_proxy(_frames_view.ptr())->flags &= ~pybind11::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    pybind11::detail::array_proxy(_indices_view.ptr())->flags &= ~pybind11::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    pybind11::detail::array_proxy(_crashed_view.ptr())->flags &= ~pybind11::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    pybind11::detail::array_proxy(_done_view.ptr())->flags &= ~pybind11::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+}
+
+pybind11::tuple cynes::wrapper::VecNesWrapper::step(
+    pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> controllers,
+    uint32_t frames,
+    RenderPolicy render
+) {
+    if (controllers.ndim() != 1 || static_cast<size_t>(controllers.shape(0)) != size()) {
+        throw std::invalid_argument("The controllers array should have a shape of (N,).");
+    }
+
+    std::memcpy(_controllers.data(), controllers.data(), size() * sizeof(uint16_t));
+
+    {
+        pybind11::gil_scoped_release release{};
+
+        if (_lockstep && !_frame_stack) {
+            group_emulators();
+
+            _pool.parallel_for(_stepped.size(), [this, frames, render](size_t index) {
+                step_emulator(_stepped[index], frames, render);
+            });
+
+            // The leaders are done stepping, their states are copied to the other
+            // emulators of their group.
+            _pool.parallel_for(size(), [this, render](size_t index) {
+                const size_t leader = _leaders[index];
+
+                if (leader == index) {
+                    return;
+                }
+
+                _emulators[index]->copy_state(*_emulators[leader], render != RenderPolicy::NONE);
+                _crashed[index] = _crashed[leader];
+                _done[index] = _done[leader];
+
+                if (render == RenderPolicy::NONE) {
+                    return;
+                }
+
+                const size_t frame_size = _frame_format == FrameFormat::INDEXED ? 0xF000 : 0x2D000;
+                copy_frame(
+                    _frames.get() + index * frame_size,
+                    _frames.get() + leader * frame_size,
+                    frame_size,
+                    size() * frame_size
+                );
+            });
+
+            _stepped_count = _stepped.size();
+        } else {
+            _pool.parallel_for(size(), [this, frames, render](size_t index) {
+                step_emulator(index, frames, render);
+            });
+
+            _stepped_count = size();
+        }
+
+        if (_frame_stack) {
+            _frame_stack->advance();
+        }
+    }
+
+    if (_frame_format == FrameFormat::INDEXED) {
+        return pybind11::make_tuple(_indices_view, _crashed_view);
+    }
+
+    return pybind11::make_tuple(_frames_view, _crashed_view);
+}
+
+void cynes::wrapper::VecNesWrapper::step_emulator(
+    size_t index,
+    uint32_t frames,
+    RenderPolicy render
+) {
+    NES& nes = *_emulators[index];
+
+    if (_frame_stack) {
+        _crashed[index] |= _frame_stack->step(index, nes, _controllers[index], frames, render);
+    } else {
+        _crashed[index] |= nes.step(_controllers[index], frames, render);
+    }
+
+    _done[index] = nes.is_done();
+
+    if (render == RenderPolicy::NONE) {
+        return;
+    }
+
+    if (_frame_format == FrameFormat::INDEXED) {
+        copy_frame(_frames.get() + index * 0xF000, nes.get_frame_indices(), 0xF000, size() * 0xF000);
+    } else {
+        copy_frame(_frames.get() + index * 0x2D000, nes.get_frame_buffer(), 0x2D000, size() * 0x2D000);
+    }
+}
+
+void cynes::wrapper::VecNesWrapper::group_emulators() {
+    _pool.parallel_for(size(), [this](size_t index) {
+        _hashes[index] = _emulators[index]->state_hash();
+    });
+
+    std::vector<size_t> order(size());
+    std::iota(order.begin(), order.end(), 0);
+
+    const auto group = [this](size_t index) {
+        return std::make_tuple(_hashes[index], _controllers[index], _crashed[index]);
+    };
+
+    std::sort(order.begin(), order.end(), [&group](size_t lhs, size_t rhs) {
+        return std::make_pair(group(lhs), lhs) < std::make_pair(group(rhs), rhs);
+    });
+
+    _stepped.clear();
+
+    // Within a group, the emulators are sorted by index, the first one is the leader.
+    for (size_t k = 0; k < order.size(); k++) {
+        const size_t index = order[k];
+
+        if (k == 0 || group(order[k - 1]) != group(index)) {
+            _stepped.push_back(index);
+        }
+
+        _leaders[index] = _stepped.back();
+    }
+}
+
+void cynes::wrapper::VecNesWrapper::reset() {
+    pybind11::gil_scoped_release release{};
+
+    _pool.parallel_for(size(), [this](size_t index) {
+        _emulators[index]->reset();
+        _crashed[index] = false;
+    });
+}
+
+void cynes::wrapper::VecNesWrapper::save_into(pybind11::buffer buffer) {
+    pybind11::buffer_info info = buffer.request(true);
+    uint8_t* data = get_state_buffer(info, {size(), _save_state_size});
+
+    pybind11::gil_scoped_release release{};
+
+    _pool.parallel_for(size(), [this, data](size_t index) {
+        _emulators[index]->save(data + index * _save_state_size);
+    });
+}
+
+void cynes::wrapper::VecNesWrapper::load_from(pybind11::buffer buffer) {
+    pybind11::buffer_info info = buffer.request();
+    uint8_t* data = get_state_buffer(info, {size(), _save_state_size});
+
+    // Every state is checked before the GIL is released, so that a bad row does not
+    // leave the batch partially loaded.
+    for (size_t index = 0; index < size(); index++) {
+        check_state(*_emulators[index], data + index * _save_state_size, _save_state_size);
+    }
+
+    pybind11::gil_scoped_release release{};
+
+    _pool.parallel_for(size(), [this, data](size_t index) {
+        _emulators[index]->load(
+            data + index * _save_state_size,
+            static_cast<unsigned int>(_save_state_size)
+        );
+        _crashed[index] = false;
+    });
+}
+
+void cynes::wrapper::VecNesWrapper::save_slots(
+    StatePool& pool,
+    pybind11::array_t<uint64_t, pybind11::array::c_style | pybind11::array::forcecast> slots
+) {
+    const std::vector<size_t> indices = get_pool_slots(pool, slots, size(), _save_state_size);
+    std::vector<size_t> sorted{indices};
+
+    std::sort(sorted.begin(), sorted.end());
+
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+        throw std::invalid_argument("Each emulator should be saved to a distinct slot.");
+    }
+
+    pybind11::gil_scoped_release release{};
+
+    _pool.parallel_for(size(), [this, &pool, &indices](size_t index) {
+        pool.save(*_emulators[index], indices[index]);
+    });
+}
+
+void cynes::wrapper::VecNesWrapper::load_slots(
+    StatePool& pool,
+    pybind11::array_t<uint64_t, pybind11::array::c_style | pybind11::array::forcecast> slots
+) {
+    const std::vector<size_t> indices = get_pool_slots(pool, slots, size(), _save_state_size);
+
+    // Slots saved by the emulators of another ROM may share the same size, their
+    // headers are checked as well.
+    for (size_t index = 0; index < size(); index++) {
+        if (!pool.is_saved(indices[index])) {
+            throw std::invalid_argument("The slot does not hold a state.");
+        }
+
+        check_state(*_emulators[index], pool.get_slot(indices[index]), _save_state_size);
+    }
+
+    pybind11::gil_scoped_release release{};
+
+    _pool.parallel_for(size(), [this, &pool, &indices](size_t index) {
+        pool.load(*_emulators[index], indices[index]);
+        _crashed[index] = false;
+    });
+}
+
+pybind11::dict cynes::wrapper::VecNesWrapper::run_tape(
+    pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> controllers,
+    uint32_t frames_per_action,
+    uint32_t capture_every,
+    bool capture_frames,
+    bool capture_states,
+    bool capture_watch
+) {
+    if (controllers.ndim() != 2 || static_cast<size_t>(controllers.shape(0)) != size()) {
+        throw std::invalid_argument("The tapes should have a shape of (N, T).");
+    }
+
+    const size_t length = static_cast<size_t>(controllers.shape(1));
+    const size_t captures = get_tape_captures(length, capture_every);
+    const size_t frame_size = _frame_format == FrameFormat::INDEXED ? 0xF000 : 0x2D000;
+    const size_t watch_size = _emulators.front()->get_watch_size();
+
+    pybind11::dict result{};
+    uint8_t* frames_data = nullptr;
+    uint8_t* states_data = nullptr;
+    uint8_t* watch_data = nullptr;
+
+    if (capture_frames) {
+        std::vector<size_t> shape{size(), captures, 240, 256};
+
+        if (_frame_format == FrameFormat::RGB) {
+            shape.push_back(3);
+        }
+
+        pybind11::array_t<uint8_t> frames{shape};
+        std::memset(frames.mutable_data(), 0x00, size() * captures * frame_size);
+
+        frames_data = frames.mutable_data();
+        result["frames"] = frames;
+    }
+
+    if (capture_states) {
+        pybind11::array_t<uint8_t> states{std::vector<size_t>{size(), captures, _save_state_size}};
+        std::memset(states.mutable_data(), 0x00, size() * captures * _save_state_size);
+
+        states_data = states.mutable_data();
+        result["states"] = states;
+    }
+
+    if (capture_watch) {
+        pybind11::array_t<uint8_t> values{std::vector<size_t>{size(), captures, watch_size}};
+        std::memset(values.mutable_data(), 0x00, size() * captures * watch_size);
+
+        watch_data = values.mutable_data();
+        result["watch_values"] = values;
+    }
+
+    pybind11::array_t<uint64_t> lengths{static_cast<int>(size())};
+    uint64_t* lengths_data = lengths.mutable_data();
+    const uint16_t* tapes = controllers.data();
+
+    {
+        pybind11::gil_scoped_release release{};
+
+        _pool.parallel_for(size(), [&](size_t index) {
+            TapeCapture capture{
+                frames_data == nullptr ? nullptr : frames_data + index * captures * frame_size,
+                states_data == nullptr ? nullptr : states_data + index * captures * _save_state_size,
+                watch_data == nullptr ? nullptr : watch_data + index * captures * watch_size
+            };
+
+            bool crashed = _crashed[index];
+
+            lengths_data[index] = ::run_tape(
+                *_emulators[index],
+                tapes + index * length,
+                length,
+                frames_per_action,
+                capture_every,
+                capture,
+                _save_state_size,
+                crashed
+            );
+
+            _crashed[index] = crashed;
+            _done[index] = _emulators[index]->is_done();
+        });
+    }
+
+    result["length"] = lengths;
+
+    return result;
+}
+
+pybind11::array_t<uint64_t> cynes::wrapper::VecNesWrapper::state_hash(bool ram_only) {
+    pybind11::array_t<uint64_t> hashes{static_cast<int>(size())};
+    uint64_t* data = hashes.mutable_data();
+
+    pybind11::gil_scoped_release release{};
+
+    _pool.parallel_for(size(), [this, data, ram_only](size_t index) {
+        data[index] = ram_only ? _emulators[index]->ram_hash() : _emulators[index]->state_hash();
+    });
+
+    return hashes;
+}
+
+void cynes::wrapper::VecNesWrapper::set_frame_format(FrameFormat format) {
+    if (_frame_stack && format != FrameFormat::INDEXED) {
+        throw std::runtime_error("The frame buffer format should stay INDEXED while the frame stack is enabled.");
+    }
 
-cynes::wrapper::NesWrapper::NesWrapper(const char* path_rom)
-    : controller{0x00}
-    , _nes{path_rom}
-    , _save_state_size{_nes.size()}
-    , _frame{
-        {240, 256, 3},
-        {256 * 3, 3, 1},
-        _nes.get_frame_buffer(),
-        pybind11::capsule(_nes.get_frame_buffer(), [](void *) {})
+    for (auto& nes : _emulators) {
+        nes->ppu.set_frame_format(format);
     }
-    , _crashed{false}
-{
-    pybind11::detail::array_proxy(_frame.ptr())->flags &= ~pybind11::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+
+    _frame_format = format;
 }
 
-const pybind11::array_t<uint8_t>& cynes::wrapper::NesWrapper::step(uint32_t frames) {
-    _crashed |= _nes.step(controller, frames);
-    return _frame;
+void cynes::wrapper::VecNesWrapper::set_idle_loop_skip(bool enabled) {
+    for (auto& nes : _emulators) {
+        nes->cpu.set_idle_loop_skip(enabled);
+    }
 }
 
-pybind11::array_t<uint8_t> cynes::wrapper::NesWrapper::save() {
-    pybind11::array_t<uint8_t> buffer{static_cast<int>(_save_state_size)};
-    _nes.save(buffer.mutable_data());
-    return buffer;
+void cynes::wrapper::VecNesWrapper::set_watch_list(
+    pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> addresses
+) {
+    std::vector<uint16_t> watched = get_watch_addresses(addresses);
+
+    for (auto& nes : _emulators) {
+        nes->set_watch_list(watched);
+    }
 }
 
-void cynes::wrapper::NesWrapper::load(pybind11::array_t<uint8_t> buffer) {
-    _nes.load(buffer.mutable_data());
-    _crashed = false;
+pybind11::array_t<uint8_t> cynes::wrapper::VecNesWrapper::get_watch_values() const {
+    const size_t watch_size = _emulators.front()->get_watch_size();
+
+    pybind11::array_t<uint8_t> values{std::vector<size_t>{size(), watch_size}};
+    uint8_t* data = values.mutable_data();
+
+    for (size_t k = 0; k < size(); k++) {
+        std::memcpy(data + k * watch_size, _emulators[k]->get_watch_values(), watch_size);
+    }
+
+    return values;
 }
 
-pybind11::array_t<uint8_t> cynes::wrapper::NesWrapper::read_all_ram() {
-    constexpr size_t ram_size = 2048; // NES RAM is 2KB
-    const uint8_t* ram_ptr = _nes.get_ram_pointer();
+void cynes::wrapper::VecNesWrapper::add_done_condition(
+    uint16_t address,
+    uint8_t value,
+    Comparison comparison,
+    uint8_t mask
+) {
+    for (auto& nes : _emulators) {
+        nes->add_done_condition({address, comparison, value, mask});
+    }
+}
 
-    // Create a capsule to manage the memory lifetime (i.e., do nothing, as _nes owns it)
-    pybind11::capsule no_delete(ram_ptr, [](void* p) { /* do nothing */ });
+void cynes::wrapper::VecNesWrapper::clear_done_conditions() {
+    for (auto& nes : _emulators) {
+        nes->clear_done_conditions();
+    }
+}
 
-    // Return a NumPy array that views the C++ memory without copying it
-    return pybind11::array_t<uint8_t>(
-        {ram_size},         // Shape of the array
-        {sizeof(uint8_t)},  // Strides (bytes to step for each element)
-        ram_ptr,            // Pointer to the data
-        no_delete           // The capsule
-    );
+void cynes::wrapper::VecNesWrapper::enable_frame_stack(
+    size_t depth,
+    palette::PixelFormat format,
+    uint8_t downsample,
+    bool max_pool
+) {
+    check_indexed(_frame_format);
+
+    _frame_stack.reset(new FrameStack{size(), depth, format, downsample, max_pool});
+    _frame_stack_view = get_frame_stack_view(*_frame_stack, {size(), depth});
+
+    reset_frame_stack();
+}
+
+void cynes::wrapper::VecNesWrapper::disable_frame_stack() {
+    _frame_stack_view = pybind11::array_t<uint8_t>{};
+    _frame_stack.reset();
+}
+
+void cynes::wrapper::VecNesWrapper::reset_frame_stack() {
+    check_frame_stack(_frame_stack);
+
+    pybind11::gil_scoped_release release{};
+
+    _pool.parallel_for(size(), [this](size_t index) {
+        _frame_stack->fill(index, *_emulators[index]);
+    });
+}
+
+const pybind11::array_t<uint8_t>& cynes::wrapper::VecNesWrapper::get_frame_stack() const {
+    check_frame_stack(_frame_stack);
+
+    return _frame_stack_view;
+}
+
+size_t cynes::wrapper::VecNesWrapper::get_frame_stack_start() const {
+    check_frame_stack(_frame_stack);
+
+    return _frame_stack->get_start();
+}
+
+pybind11::array_t<uint8_t> cynes::wrapper::VecNesWrapper::convert_frames(
+    palette::PixelFormat format,
+    uint8_t downsample
+) {
+    check_indexed(_frame_format);
+
+    std::vector<size_t> shape = get_converted_shape(format, downsample);
+    const size_t frame_size = get_converted_size(shape);
+
+    shape.insert(shape.begin(), size());
+
+    pybind11::array_t<uint8_t> frames{shape};
+    uint8_t* data = frames.mutable_data();
+
+    {
+        pybind11::gil_scoped_release release{};
+
+        _pool.parallel_for(size(), [this, format, downsample, frame_size, data](size_t index) {
+            palette::convert(
+                _emulators[index]->get_frame_indices(),
+                _emulators[index]->get_frame_emphasis(),
+                data + index * frame_size,
+                format,
+                downsample
+            );
+        });
+    }
+
+    return frames;
 }
 
 
@@ -65,12 +1523,207 @@ PYBIND11_MODULE(emulator, mod) {
     mod.attr("__version__") = "0.0.0";
 #endif
 
+    pybind11::enum_<cynes::RenderPolicy>(mod, "RenderPolicy")
+        .value("ALL", cynes::RenderPolicy::ALL)
+        .value("LAST", cynes::RenderPolicy::LAST)
+        .value("NONE", cynes::RenderPolicy::NONE)
+        .doc() = "Frames of a step composed into the framebuffer";
+
+    pybind11::enum_<cynes::FrameFormat>(mod, "FrameFormat")
+        .value("RGB", cynes::FrameFormat::RGB)
+        .value("INDEXED", cynes::FrameFormat::INDEXED)
+        .doc() = "Frame buffer written by the emulator";
+
+    pybind11::enum_<cynes::Comparison>(mod, "Comparison")
+        .value("EQUAL", cynes::Comparison::EQUAL)
+        .value("NOT_EQUAL", cynes::Comparison::NOT_EQUAL)
+        .value("LESS", cynes::Comparison::LESS)
+        .value("GREATER", cynes::Comparison::GREATER)
+        .doc() = "Comparison between a watched byte and the value of a done condition";
+
+    pybind11::enum_<cynes::StopReason>(mod, "StopReason")
+        .value("FRAMES", cynes::StopReason::FRAMES)
+        .value("CRASHED", cynes::StopReason::CRASHED)
+        .value("DONE", cynes::StopReason::DONE)
+        .value("INSTRUCTIONS", cynes::StopReason::INSTRUCTIONS)
+        .value("CYCLES", cynes::StopReason::CYCLES)
+        .value("BREAKPOINT", cynes::StopReason::BREAKPOINT)
+        .value("WATCH", cynes::StopReason::WATCH)
+        .value("TIME", cynes::StopReason::TIME)
+        .doc() = "Reason for which a step ended";
+
+    pybind11::enum_<cynes::palette::PixelFormat>(mod, "PixelFormat")
+        .value("RGB24", cynes::palette::PixelFormat::RGB24)
+        .value("RGBA32", cynes::palette::PixelFormat::RGBA32)
+        .value("LUMA", cynes::palette::PixelFormat::LUMA)
+        .doc() = "Pixel formats an indexed frame buffer can be converted to";
+
+    mod.attr("PROFILING_ENABLED") = cynes::PROFILING_ENABLED;
+
+    pybind11::class_<cynes::Counters>(mod, "Counters")
+        .def_readonly("frames", &cynes::Counters::frames, "Number of frames stepped.")
+        .def_readonly("cpu_instructions", &cynes::Counters::cpu_instructions, "Number of CPU instructions executed.")
+        .def_readonly("cpu_cycles", &cynes::Counters::cpu_cycles, "Number of CPU cycles, including the DMA stalls.")
+        .def_readonly("ppu_dots", &cynes::Counters::ppu_dots, "Number of PPU dots.")
+        .def_readonly("oam_dma_stalls", &cynes::Counters::oam_dma_stalls, "Number of CPU cycles stalled by the OAM DMA.")
+        .def_readonly("dmc_stalls", &cynes::Counters::dmc_stalls, "Number of CPU cycles stalled by the DMC sample fetches.")
+        .def_readonly("idle_cycles", &cynes::Counters::idle_cycles, "Number of CPU cycles skipped in idle loops.")
+        .def_readonly("mapper_writes", &cynes::Counters::mapper_writes, "Number of CPU writes to the mapper registers and RAM.")
+        .def_readonly("non_maskable_interrupts", &cynes::Counters::non_maskable_interrupts, "Number of non-maskable interrupts serviced by the CPU.")
+        .def_readonly("interrupts", &cynes::Counters::interrupts, "Number of interrupt requests serviced by the CPU.")
+        .def_readonly("step_time", &cynes::Counters::step_time, "Time spent stepping the emulator.")
+        .def_readonly("ppu_time", &cynes::Counters::ppu_time, "Time spent catching the PPU up.")
+        .def_readonly("oam_dma_time", &cynes::Counters::oam_dma_time, "Time spent in the OAM DMA transfers.")
+        .def_readonly("dmc_time", &cynes::Counters::dmc_time, "Time spent in the DMC sample fetches.")
+        .doc() = "Profiling counters of an emulator, times are in timestamp counter ticks";
+
+    pybind11::class_<cynes::StepResult>(mod, "StepResult")
+        .def_readonly("reason", &cynes::StepResult::reason, "Reason for which the step ended.")
+        .def_readonly("frames", &cynes::StepResult::frames, "Number of frames completed.")
+        .def_readonly("instructions", &cynes::StepResult::instructions, "Number of CPU instructions executed.")
+        .def_readonly("cycles", &cynes::StepResult::cycles, "Number of CPU cycles elapsed.")
+        .doc() = "Outcome of a step with early stop conditions";
+
+    pybind11::class_<cynes::wrapper::RomWrapper>(mod, "ROM")
+        .def(
+            pybind11::init<const char*>(),
+            pybind11::arg("path_rom"),
+            "Load a ROM file."
+        )
+        .def_static(
+            "from_bytes",
+            &cynes::wrapper::RomWrapper::from_bytes,
+            pybind11::arg("data"),
+            "Parse a ROM from an in-memory iNES or NES 2.0 image."
+        )
+        .def_property_readonly(
+            "mapper",
+            &cynes::wrapper::RomWrapper::get_mapper_index,
+            "iNES mapper id used by the ROM."
+        )
+        .def_property_readonly(
+            "submapper",
+            &cynes::wrapper::RomWrapper::get_submapper_index,
+            "NES 2.0 submapper id, always 0 for iNES headers."
+        )
+        .def_property_readonly(
+            "nes2",
+            &cynes::wrapper::RomWrapper::is_nes2,
+            "Indicate whether the header uses the NES 2.0 format."
+        )
+        .def_property_readonly(
+            "has_battery",
+            &cynes::wrapper::RomWrapper::has_battery,
+            "Indicate whether the cartridge has a battery keeping its memory powered."
+        )
+        .def_property_readonly(
+            "prg_size",
+            &cynes::wrapper::RomWrapper::get_size_prg,
+            "Size of the PRG-ROM in bytes."
+        )
+        .def_property_readonly(
+            "chr_size",
+            &cynes::wrapper::RomWrapper::get_size_chr,
+            "Size of the CHR memory in bytes."
+        )
+        .def_property_readonly(
+            "has_chr_ram",
+            &cynes::wrapper::RomWrapper::has_chr_ram,
+            "Indicate whether the cartridge uses CHR-RAM instead of CHR-ROM."
+        )
+        .def_property_readonly(
+            "prg_ram_size",
+            &cynes::wrapper::RomWrapper::get_size_prg_ram,
+            "Size of the volatile PRG-RAM in bytes."
+        )
+        .def_property_readonly(
+            "prg_nvram_size",
+            &cynes::wrapper::RomWrapper::get_size_prg_nvram,
+            "Size of the battery backed PRG-RAM in bytes."
+        )
+        .def_property_readonly(
+            "chr_ram_size",
+            &cynes::wrapper::RomWrapper::get_size_chr_ram,
+            "Size of the volatile CHR-RAM in bytes, as declared by the header."
+        )
+        .def_property_readonly(
+            "chr_nvram_size",
+            &cynes::wrapper::RomWrapper::get_size_chr_nvram,
+            "Size of the battery backed CHR-RAM in bytes."
+        )
+        .doc() = "ROM image shared by the emulators created from it";
+
+    pybind11::class_<cynes::StatePool>(mod, "StatePool")
+        .def(
+            pybind11::init<size_t, size_t, const std::string&>(),
+            pybind11::arg("slot_size"),
+            pybind11::arg("capacity"),
+            pybind11::arg("path") = "",
+            "Allocate the arena of the pool, on the heap or mapped from a file."
+        )
+        .def(
+            "allocate",
+            &cynes::StatePool::allocate,
+            "Allocate a free slot."
+        )
+        .def(
+            "allocate_batch",
+            &allocate_slots,
+            pybind11::arg("count"),
+            "Allocate the given amount of free slots at once."
+        )
+        .def(
+            "release",
+            &cynes::StatePool::release,
+            pybind11::arg("slot"),
+            "Release an allocated slot."
+        )
+        .def(
+            "copy",
+            &cynes::StatePool::copy,
+            pybind11::arg("source"),
+            pybind11::arg("destination"),
+            "Copy the content of a slot to another one."
+        )
+        .def(
+            "is_saved",
+            &cynes::StatePool::is_saved,
+            pybind11::arg("slot"),
+            "Indicate whether a slot holds a state."
+        )
+        .def_property_readonly(
+            "slot_size",
+            &cynes::StatePool::get_slot_size,
+            "Size of a slot in bytes."
+        )
+        .def_property_readonly(
+            "capacity",
+            &cynes::StatePool::get_capacity,
+            "Number of slots."
+        )
+        .def_property_readonly(
+            "free_count",
+            &cynes::StatePool::get_free_count,
+            "Number of free slots."
+        )
+        .def_property_readonly(
+            "is_mapped",
+            &cynes::StatePool::is_mapped,
+            "Indicate whether the arena is mapped from a file."
+        )
+        .doc() = "Fixed-size save state slots allocated from a single arena";
+
     pybind11::class_<cynes::wrapper::NesWrapper>(mod, "NES")
         .def(
             pybind11::init<const char*>(),
             pybind11::arg("path_rom"),
             "Initialize the emulator."
         )
+        .def(
+            pybind11::init<const cynes::wrapper::RomWrapper&>(),
+            pybind11::arg("rom"),
+            "Initialize the emulator from an already loaded ROM."
+        )
         .def(
             "__setitem__",
             &cynes::wrapper::NesWrapper::write,
@@ -94,15 +1747,57 @@ PYBIND11_MODULE(emulator, mod) {
             &cynes::wrapper::NesWrapper::reset,
             "Send a reset signal to the emulator."
         )
+        .def(
+            "copy",
+            &cynes::wrapper::NesWrapper::copy,
+            "Create an independent copy of the emulator, sharing its ROM."
+        )
+        .def(
+            "__copy__",
+            &cynes::wrapper::NesWrapper::copy,
+            "Create an independent copy of the emulator, sharing its ROM."
+        )
         .def(
             "step",
             &cynes::wrapper::NesWrapper::step,
             pybind11::arg("frames") = 1,
+            pybind11::arg("render") = cynes::RenderPolicy::ALL,
             "Run the emulator for the specified amount of frame."
         )
+        .def(
+            "step_async",
+            &cynes::wrapper::NesWrapper::step_async,
+            pybind11::arg("frames") = 1,
+            pybind11::arg("render") = cynes::RenderPolicy::ALL,
+            "Start running the emulator for the specified amount of frame on a worker thread."
+        )
+        .def(
+            "wait",
+            &cynes::wrapper::NesWrapper::wait,
+            "Wait for the step started by step_async, and return its frame buffer."
+        )
+        .def_property(
+            "frame_buffers",
+            &cynes::wrapper::NesWrapper::get_frame_count,
+            &cynes::wrapper::NesWrapper::set_frame_count,
+            "Number of frame buffers rotated through by step_async."
+        )
+        .def(
+            "step_until",
+            &cynes::wrapper::NesWrapper::step_until,
+            pybind11::arg("frames") = 1,
+            pybind11::arg("render") = cynes::RenderPolicy::ALL,
+            pybind11::arg("max_instructions") = 0,
+            pybind11::arg("max_cycles") = 0,
+            pybind11::arg("max_seconds") = 0.0,
+            pybind11::arg("breakpoints") = pybind11::array_t<uint16_t>(0),
+            pybind11::arg("stop_on_watch_change") = false,
+            "Run the emulator until the end of its frames or an early stop condition."
+        )
         .def(
             "save",
             &cynes::wrapper::NesWrapper::save,
+            pybind11::arg("compress") = false,
             "Dump the current emulator state into a save state."
         )
         .def(
@@ -111,15 +1806,377 @@ PYBIND11_MODULE(emulator, mod) {
             pybind11::arg("buffer"),
             "Restore the emulator state from a save state."
         )
+        .def(
+            "save_into",
+            &cynes::wrapper::NesWrapper::save_into,
+            pybind11::arg("buffer"),
+            "Dump the current emulator state into a preallocated buffer."
+        )
+        .def(
+            "load_from",
+            &cynes::wrapper::NesWrapper::load_from,
+            pybind11::arg("buffer"),
+            "Restore the emulator state from a buffer, without copying it."
+        )
+        .def_property_readonly(
+            "state_size",
+            &cynes::wrapper::NesWrapper::get_state_size,
+            "Size of a save state in bytes."
+        )
+        .def(
+            "save_slot",
+            &cynes::wrapper::NesWrapper::save_slot,
+            pybind11::arg("pool"),
+            pybind11::arg("slot"),
+            "Dump the current emulator state into a slot of a state pool."
+        )
+        .def(
+            "load_slot",
+            &cynes::wrapper::NesWrapper::load_slot,
+            pybind11::arg("pool"),
+            pybind11::arg("slot"),
+            "Restore the emulator state from a slot of a state pool."
+        )
+        .def(
+            "state_hash",
+            &cynes::wrapper::NesWrapper::state_hash,
+            pybind11::arg("ram_only") = false,
+            "Compute a 64-bit fingerprint of the emulator state."
+        )
+        .def(
+            "set_snapshot_base",
+            &cynes::wrapper::NesWrapper::set_snapshot_base,
+            "Use the current state as the base of the incremental snapshots."
+        )
+        .def(
+            "save_snapshot",
+            &cynes::wrapper::NesWrapper::save_snapshot,
+            "Dump the memory blocks written since the snapshot base into a snapshot."
+        )
+        .def(
+            "load_snapshot",
+            &cynes::wrapper::NesWrapper::load_snapshot,
+            pybind11::arg("buffer"),
+            "Restore the emulator state from an incremental snapshot."
+        )
+        .def(
+            "convert_frame",
+            &cynes::wrapper::NesWrapper::convert_frame,
+            pybind11::arg("format") = cynes::palette::PixelFormat::RGB24,
+            pybind11::arg("downsample") = 1,
+            "Convert the indexed frame buffer into the given pixel format."
+        )
         .def_readwrite(
             "controller",
             &cynes::wrapper::NesWrapper::controller,
             "Emulator controller state."
         )
+        .def_property(
+            "frame_format",
+            &cynes::wrapper::NesWrapper::get_frame_format,
+            &cynes::wrapper::NesWrapper::set_frame_format,
+            "Frame buffer written by the emulator and returned by step."
+        )
+        .def_property(
+            "idle_loop_skip",
+            &cynes::wrapper::NesWrapper::get_idle_loop_skip,
+            &cynes::wrapper::NesWrapper::set_idle_loop_skip,
+            "Whether or not the idle loops are fast-forwarded."
+        )
         .def_property_readonly(
             "has_crashed",
             &cynes::wrapper::NesWrapper::has_crashed,
             "Indicate whether the CPU crashed after hitting an invalid op-code."
         )
+        .def_property_readonly(
+            "counters",
+            &cynes::wrapper::NesWrapper::get_counters,
+            "Copy of the profiling counters, zero unless built with CYNES_PROFILE."
+        )
+        .def(
+            "reset_counters",
+            &cynes::wrapper::NesWrapper::reset_counters,
+            "Reset the profiling counters to zero."
+        )
+        .def(
+            "set_watch_list",
+            &cynes::wrapper::NesWrapper::set_watch_list,
+            pybind11::arg("addresses"),
+            "Set the addresses whose values are gathered at the end of every frame."
+        )
+        .def_property_readonly(
+            "watch_values",
+            &cynes::wrapper::NesWrapper::get_watch_values,
+            "Values of the watched addresses, as of the end of the last frame."
+        )
+        .def(
+            "add_done_condition",
+            &cynes::wrapper::NesWrapper::add_done_condition,
+            pybind11::arg("address"),
+            pybind11::arg("value"),
+            pybind11::arg("comparison") = cynes::Comparison::EQUAL,
+            pybind11::arg("mask") = 0xFF,
+            "Add a condition on a byte of the memory ending the steps early."
+        )
+        .def(
+            "clear_done_conditions",
+            &cynes::wrapper::NesWrapper::clear_done_conditions,
+            "Remove every done condition."
+        )
+        .def_property_readonly(
+            "done",
+            &cynes::wrapper::NesWrapper::is_done,
+            "Indicate whether a done condition ended the last step."
+        )
+        .def(
+            "enable_frame_stack",
+            &cynes::wrapper::NesWrapper::enable_frame_stack,
+            pybind11::arg("depth") = 4,
+            pybind11::arg("format") = cynes::palette::PixelFormat::LUMA,
+            pybind11::arg("downsample") = 1,
+            pybind11::arg("max_pool") = true,
+            "Keep a ring of the last processed observations, updated by every step."
+        )
+        .def(
+            "disable_frame_stack",
+            &cynes::wrapper::NesWrapper::disable_frame_stack,
+            "Stop updating the ring of observations, and release it."
+        )
+        .def(
+            "reset_frame_stack",
+            &cynes::wrapper::NesWrapper::reset_frame_stack,
+            "Fill the ring of observations with the current frame."
+        )
+        .def_property_readonly(
+            "frame_stack",
+            &cynes::wrapper::NesWrapper::get_frame_stack,
+            "Read-only ring of the last observations."
+        )
+        .def_property_readonly(
+            "frame_stack_start",
+            &cynes::wrapper::NesWrapper::get_frame_stack_start,
+            "Slot of the ring holding the oldest observation."
+        )
+        .def(
+            "enable_audio",
+            &cynes::wrapper::NesWrapper::enable_audio,
+            pybind11::arg("sample_rate") = 44100,
+            pybind11::arg("depth") = 4,
+            "Start synthesizing the audio of the following frames."
+        )
+        .def(
+            "disable_audio",
+            &cynes::wrapper::NesWrapper::disable_audio,
+            "Stop synthesizing audio, and release the ring of samples."
+        )
+        .def_property_readonly(
+            "audio",
+            &cynes::wrapper::NesWrapper::get_audio,
+            "Read-only ring of the samples of the last frames."
+        )
+        .def_property_readonly(
+            "audio_lengths",
+            &cynes::wrapper::NesWrapper::get_audio_lengths,
+            "Read-only number of samples written to each slot of the ring."
+        )
+        .def_property_readonly(
+            "audio_start",
+            &cynes::wrapper::NesWrapper::get_audio_start,
+            "Slot of the ring holding the oldest frame of samples."
+        )
+        .def(
+            "read_audio",
+            &cynes::wrapper::NesWrapper::read_audio,
+            pybind11::arg("frames") = 1,
+            "Gather the samples of the last frames, in chronological order."
+        )
+        .def(
+            "run_tape",
+            &cynes::wrapper::NesWrapper::run_tape,
+            pybind11::arg("controllers"),
+            pybind11::arg("frames_per_action") = 1,
+            pybind11::arg("capture_every") = 0,
+            pybind11::arg("capture_frames") = false,
+            pybind11::arg("capture_states") = false,
+            pybind11::arg("capture_watch") = true,
+            "Step through a whole tape of controller states in a single call."
+        )
         .doc() = "Headless NES emulator";
+
+    pybind11::class_<cynes::wrapper::VecNesWrapper>(mod, "VecNES")
+        .def(
+            pybind11::init<const char*, size_t, size_t>(),
+            pybind11::arg("path_rom"),
+            pybind11::arg("count"),
+            pybind11::arg("threads") = 0,
+            "Initialize the emulators."
+        )
+        .def(
+            pybind11::init<const cynes::wrapper::RomWrapper&, size_t, size_t>(),
+            pybind11::arg("rom"),
+            pybind11::arg("count"),
+            pybind11::arg("threads") = 0,
+            "Initialize the emulators from an already loaded ROM."
+        )
+        .def(
+            "__len__",
+            &cynes::wrapper::VecNesWrapper::size,
+            "Get the number of emulators."
+        )
+        .def(
+            "save_into",
+            &cynes::wrapper::VecNesWrapper::save_into,
+            pybind11::arg("buffer"),
+            "Dump the state of every emulator into a preallocated (N, state_size) buffer."
+        )
+        .def(
+            "load_from",
+            &cynes::wrapper::VecNesWrapper::load_from,
+            pybind11::arg("buffer"),
+            "Restore the state of every emulator from a (N, state_size) buffer, without copying it."
+        )
+        .def_property_readonly(
+            "state_size",
+            &cynes::wrapper::VecNesWrapper::get_state_size,
+            "Size of the save state of a single emulator in bytes."
+        )
+        .def(
+            "save_slots",
+            &cynes::wrapper::VecNesWrapper::save_slots,
+            pybind11::arg("pool"),
+            pybind11::arg("slots"),
+            "Dump the state of every emulator into its own slot of a state pool."
+        )
+        .def(
+            "load_slots",
+            &cynes::wrapper::VecNesWrapper::load_slots,
+            pybind11::arg("pool"),
+            pybind11::arg("slots"),
+            "Restore the state of every emulator from a slot of a state pool."
+        )
+        .def(
+            "state_hash",
+            &cynes::wrapper::VecNesWrapper::state_hash,
+            pybind11::arg("ram_only") = false,
+            "Compute a 64-bit fingerprint of the state of every emulator."
+        )
+        .def(
+            "reset",
+            &cynes::wrapper::VecNesWrapper::reset,
+            "Send a reset signal to every emulator."
+        )
+        .def(
+            "step",
+            &cynes::wrapper::VecNesWrapper::step,
+            pybind11::arg("controllers"),
+            pybind11::arg("frames") = 1,
+            pybind11::arg("render") = cynes::RenderPolicy::ALL,
+            "Run every emulator for the specified amount of frame."
+        )
+        .def(
+            "convert_frames",
+            &cynes::wrapper::VecNesWrapper::convert_frames,
+            pybind11::arg("format") = cynes::palette::PixelFormat::RGB24,
+            pybind11::arg("downsample") = 1,
+            "Convert the indexed frame buffer of every emulator into the given pixel format."
+        )
+        .def_property(
+            "frame_format",
+            &cynes::wrapper::VecNesWrapper::get_frame_format,
+            &cynes::wrapper::VecNesWrapper::set_frame_format,
+            "Frame buffer written by the emulators and returned by step."
+        )
+        .def_property(
+            "idle_loop_skip",
+            &cynes::wrapper::VecNesWrapper::get_idle_loop_skip,
+            &cynes::wrapper::VecNesWrapper::set_idle_loop_skip,
+            "Whether or not the idle loops of the emulators are fast-forwarded."
+        )
+        .def_property(
+            "lockstep",
+            &cynes::wrapper::VecNesWrapper::get_lockstep,
+            &cynes::wrapper::VecNesWrapper::set_lockstep,
+            "Whether or not the identical emulators are only stepped once."
+        )
+        .def_property_readonly(
+            "stepped_count",
+            &cynes::wrapper::VecNesWrapper::get_stepped_count,
+            "Number of emulators actually stepped by the last step."
+        )
+        .def_property_readonly(
+            "has_crashed",
+            &cynes::wrapper::VecNesWrapper::has_crashed,
+            "Indicate whether each CPU crashed after hitting an invalid op-code."
+        )
+        .def(
+            "set_watch_list",
+            &cynes::wrapper::VecNesWrapper::set_watch_list,
+            pybind11::arg("addresses"),
+            "Set the addresses whose values are gathered at the end of every frame."
+        )
+        .def_property_readonly(
+            "watch_values",
+            &cynes::wrapper::VecNesWrapper::get_watch_values,
+            "Values of the watched addresses, as of the end of the last frame."
+        )
+        .def(
+            "add_done_condition",
+            &cynes::wrapper::VecNesWrapper::add_done_condition,
+            pybind11::arg("address"),
+            pybind11::arg("value"),
+            pybind11::arg("comparison") = cynes::Comparison::EQUAL,
+            pybind11::arg("mask") = 0xFF,
+            "Add a condition on a byte of the memory ending the steps early."
+        )
+        .def(
+            "clear_done_conditions",
+            &cynes::wrapper::VecNesWrapper::clear_done_conditions,
+            "Remove every done condition."
+        )
+        .def_property_readonly(
+            "done",
+            &cynes::wrapper::VecNesWrapper::is_done,
+            "Done flags of the emulators, set when a done condition ended their last step."
+        )
+        .def(
+            "enable_frame_stack",
+            &cynes::wrapper::VecNesWrapper::enable_frame_stack,
+            pybind11::arg("depth") = 4,
+            pybind11::arg("format") = cynes::palette::PixelFormat::LUMA,
+            pybind11::arg("downsample") = 1,
+            pybind11::arg("max_pool") = true,
+            "Keep a ring of the last processed observations, updated by every step."
+        )
+        .def(
+            "disable_frame_stack",
+            &cynes::wrapper::VecNesWrapper::disable_frame_stack,
+            "Stop updating the ring of observations, and release it."
+        )
+        .def(
+            "reset_frame_stack",
+            &cynes::wrapper::VecNesWrapper::reset_frame_stack,
+            "Fill the ring of observations with the current frame."
+        )
+        .def_property_readonly(
+            "frame_stack",
+            &cynes::wrapper::VecNesWrapper::get_frame_stack,
+            "Read-only ring of the last observations."
+        )
+        .def_property_readonly(
+            "frame_stack_start",
+            &cynes::wrapper::VecNesWrapper::get_frame_stack_start,
+            "Slot of the ring holding the oldest observation."
+        )
+        .def(
+            "run_tape",
+            &cynes::wrapper::VecNesWrapper::run_tape,
+            pybind11::arg("controllers"),
+            pybind11::arg("frames_per_action") = 1,
+            pybind11::arg("capture_every") = 0,
+            pybind11::arg("capture_frames") = false,
+            pybind11::arg("capture_states") = false,
+            pybind11::arg("capture_watch") = true,
+            "Step every emulator through its own tape of controller states."
+        )
+        .doc() = "Batch of headless NES emulators stepped in parallel";
 }
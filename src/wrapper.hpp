@@ -1,14 +1,85 @@
 #ifndef __CYNES_WRAPPER__
 #define __CYNES_WRAPPER__
 
+#include "frame_stack.hpp"
 #include "nes.hpp"
+#include "palette.hpp"
+#include "state_pool.hpp"
 
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
+
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace cynes {
 namespace wrapper {
+/// ROM Wrapper for Python bindings.
+/// @note The ROM is parsed once and shared by every emulator created from it.
+class RomWrapper {
+public:
+    /// Load a ROM file.
+    /// @param path_rom Path to the ROM file.
+    RomWrapper(const char* path_rom);
+
+    // Default destructor.
+    ~RomWrapper() = default;
+
+    /// Parse an in-memory iNES or NES 2.0 image.
+    /// @param data Buffer containing the image.
+    /// @return The loaded ROM.
+    static RomWrapper from_bytes(pybind11::buffer data);
+
+    /// Get the shared ROM image.
+    inline const std::shared_ptr<const Cartridge>& get_cartridge() const { return _cartridge; }
+
+    /// Get the iNES mapper id used by the ROM.
+    inline uint16_t get_mapper_index() const { return _cartridge->get_mapper_index(); }
+
+    /// Get the NES 2.0 submapper id, always 0 for iNES headers.
+    inline uint8_t get_submapper_index() const { return _cartridge->get_submapper_index(); }
+
+    /// Check whether or not the header uses the NES 2.0 format.
+    inline bool is_nes2() const { return _cartridge->is_nes2(); }
+
+    /// Check whether or not the cartridge has a battery keeping its memory powered.
+    inline bool has_battery() const { return _cartridge->has_battery(); }
+
+    /// Get the size of the PRG-ROM in bytes.
+    inline size_t get_size_prg() const { return static_cast<size_t>(_cartridge->get_size_prg()) << 10; }
+
+    /// Get the size of the CHR memory in bytes.
+    inline size_t get_size_chr() const { return static_cast<size_t>(_cartridge->get_size_chr()) << 10; }
+
+    /// Check whether or not the cartridge uses CHR-RAM instead of CHR-ROM.
+    inline bool has_chr_ram() const { return !_cartridge->is_read_only_chr(); }
+
+    /// Get the size of the volatile PRG-RAM in bytes.
+    inline size_t get_size_prg_ram() const { return _cartridge->get_size_prg_ram(); }
+
+    /// Get the size of the battery backed PRG-RAM in bytes.
+    inline size_t get_size_prg_nvram() const { return _cartridge->get_size_prg_nvram(); }
+
+    /// Get the size of the volatile CHR-RAM in bytes, as declared by the header.
+    inline size_t get_size_chr_ram() const { return _cartridge->get_size_chr_ram(); }
+
+    /// Get the size of the battery backed CHR-RAM in bytes.
+    inline size_t get_size_chr_nvram() const { return _cartridge->get_size_chr_nvram(); }
+
+private:
+    RomWrapper(std::shared_ptr<const Cartridge> cartridge);
+
+private:
+    std::shared_ptr<const Cartridge> _cartridge;
+};
+
 /// NES Wrapper for Python bindings.
 class NesWrapper {
 public:
@@ -16,22 +87,152 @@ public:
     /// @param path_rom Path to the ROM file.
     NesWrapper(const char* path_rom);
 
-    // Default destructor.
-    ~NesWrapper() = default;
+    /// Initialize the emulator from an already loaded ROM.
+    /// @param rom Shared ROM.
+    NesWrapper(const RomWrapper& rom);
+
+    /// Wait for the pending step, if any, and stop the step worker.
+    ~NesWrapper();
+
+    /// Create an independent copy of the emulator.
+    /// @note The copy shares the ROM image, and copies the state of the emulator
+    /// directly, without going through a save state. The controller, the crashed flag,
+    /// the frame stack, the watch list and the done conditions are copied as well, the
+    /// copy has a single frame buffer holding the current frame.
+    /// @return The new emulator.
+    std::unique_ptr<NesWrapper> copy();
 
     /// Step the emulation by the given amount of frame.
     /// @param frames Number of frame of the step.
+    /// @param render Frames of the step composed into the framebuffer.
     /// @return Read-only framebuffer.
-    const pybind11::array_t<uint8_t>& step(uint32_t frames);
+    const pybind11::array_t<uint8_t>& step(uint32_t frames, RenderPolicy render);
+
+    /// Start stepping the emulation on a worker thread, see `NesWrapper::wait`.
+    /// @note Unless nothing is rendered, the step composes into the next of the rotating
+    /// frame buffers, leaving the framebuffer returned by the previous step untouched.
+    /// The controllers are read right away. Every other function waits for the pending
+    /// step before touching the emulator, so that only `NesWrapper::wait` and the
+    /// framebuffers returned by the previous steps can overlap with it. The step runs
+    /// on a worker thread started by the first call and reused afterwards.
+    /// @param frames Number of frame of the step.
+    /// @param render Frames of the step composed into the framebuffer.
+    void step_async(uint32_t frames, RenderPolicy render);
+
+    /// Wait for the step started by `NesWrapper::step_async`.
+    /// @note The GIL is released while waiting.
+    /// @return Read-only framebuffer of the step.
+    const pybind11::array_t<uint8_t>& wait();
+
+    /// Set the number of frame buffers rotated through by `NesWrapper::step_async`.
+    /// @param count Number of frame buffers, at least 1.
+    void set_frame_count(size_t count);
+
+    /// Get the number of frame buffers rotated through by `NesWrapper::step_async`.
+    inline size_t get_frame_count() const { return _nes.ppu.get_frame_count(); }
+
+    /// Step the emulation until the end of its frames or an early stop condition.
+    /// @note The frame stack is not updated by this step.
+    /// @param frames Maximum number of frame of the step.
+    /// @param render Frames of the step composed into the framebuffer.
+    /// @param max_instructions Maximum number of CPU instructions, 0 to disable.
+    /// @param max_cycles Maximum number of CPU cycles, 0 to disable.
+    /// @param max_seconds Maximum wall-clock duration in seconds, 0 to disable.
+    /// @param breakpoints Program counter values stopping the step.
+    /// @param stop_on_watch_change Whether or not a write changing a watched byte
+    /// stops the step.
+    /// @return The reason and the progress of the step.
+    StepResult step_until(
+        uint32_t frames,
+        RenderPolicy render,
+        uint64_t max_instructions,
+        uint64_t max_cycles,
+        double max_seconds,
+        pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> breakpoints,
+        bool stop_on_watch_change
+    );
+
+    /// Step the emulator through a whole tape of controller states.
+    /// @note The tape stops early when the CPU freezes or when a done condition is
+    /// met. The frame stack is not updated by the tape.
+    /// @param controllers Controllers state of each action.
+    /// @param frames_per_action Number of frame each action is held for.
+    /// @param capture_every Number of actions between two captures, 0 to only capture
+    /// the end of the tape.
+    /// @param capture_frames Whether or not the frame buffers are captured.
+    /// @param capture_states Whether or not the save states are captured.
+    /// @param capture_watch Whether or not the watched values are captured.
+    /// @return A dictionary holding the number of actions run and the captures.
+    pybind11::dict run_tape(
+        pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> controllers,
+        uint32_t frames_per_action,
+        uint32_t capture_every,
+        bool capture_frames,
+        bool capture_states,
+        bool capture_watch
+    );
 
     /// Return a save state of the emulator.
+    /// @param compress Whether or not the save state should be compressed.
     /// @return Save state buffer.
-    pybind11::array_t<uint8_t> save();
+    pybind11::array_t<uint8_t> save(bool compress);
 
     /// Load a previous emulator state from a buffer.
     /// @note This function also reset the crashed flag.
     /// @param buffer Save state buffer.
-    void load(pybind11::array_t<uint8_t> buffer);
+    void load(pybind11::array_t<uint8_t, pybind11::array::c_style | pybind11::array::forcecast> buffer);
+
+    /// Save the state of the emulator into a caller-provided buffer.
+    /// @note The buffer is written in place, nothing is allocated.
+    /// @param buffer Writable contiguous buffer of `get_state_size` bytes.
+    void save_into(pybind11::buffer buffer);
+
+    /// Load a previous emulator state directly from a caller-provided buffer.
+    /// @note The buffer is read in place, without any copy. This function also reset
+    /// the crashed flag.
+    /// @param buffer Contiguous buffer containing a save state, compressed or not.
+    void load_from(pybind11::buffer buffer);
+
+    /// Get the size of a save state in bytes.
+    inline size_t get_state_size() const { return _save_state_size; }
+
+    /// Save the state of the emulator into a slot of a state pool.
+    /// @param pool State pool, whose slot size should match the save state size.
+    /// @param slot Allocated slot index.
+    inline void save_slot(StatePool& pool, size_t slot) {
+        join_step();
+        pool.save(_nes, slot);
+    }
+
+    /// Load a previous emulator state from a slot of a state pool.
+    /// @note This function also reset the crashed flag.
+    /// @param pool State pool, whose slot size should match the save state size.
+    /// @param slot Allocated slot index, previously saved.
+    void load_slot(StatePool& pool, size_t slot);
+
+    /// Compute a fingerprint of the emulator state.
+    /// @param ram_only Whether or not only the console RAM and the mapper CPU RAM are
+    /// hashed.
+    /// @return The 64-bit XXH64 hash.
+    inline uint64_t state_hash(bool ram_only) {
+        join_step();
+        return ram_only ? _nes.ram_hash() : _nes.state_hash();
+    }
+
+    /// Use the current state as the base of the incremental snapshots.
+    inline void set_snapshot_base() {
+        join_step();
+        _nes.set_snapshot_base();
+    }
+
+    /// Return an incremental snapshot of the emulator, relative to the snapshot base.
+    /// @return Snapshot buffer.
+    pybind11::array_t<uint8_t> save_snapshot();
+
+    /// Load an incremental snapshot taken since the current snapshot base.
+    /// @note This function also reset the crashed flag.
+    /// @param buffer Snapshot buffer.
+    void load_snapshot(pybind11::array_t<uint8_t, pybind11::array::c_style | pybind11::array::forcecast> buffer);
 
     pybind11::array_t<uint8_t> read_all_ram();
 
@@ -41,6 +242,7 @@ public:
     /// @param address Memory address within the console memory address space.
     /// @param value Value to write.
     inline void write(uint16_t address, uint8_t value) {
+        join_step();
         _nes.write_cpu(address, value);
     }
 
@@ -49,27 +251,460 @@ public:
     /// should not be used as a memory watch function.
     /// @param address Memory address within the console memory address space.
     /// @return The value stored at the given address.
-    inline uint8_t read(uint16_t address) { return _nes.read_cpu(address); }
+    inline uint8_t read(uint16_t address) {
+        join_step();
+        return _nes.read_cpu(address);
+    }
 
     /// Reset the emulator (same effect as pressing the reset button).
-    inline void reset() { _nes.reset(); }
+    inline void reset() {
+        join_step();
+        _nes.reset();
+    }
+
+    /// Select the frame buffer written by the emulator and returned by `step`.
+    /// @param format Frame buffer format.
+    void set_frame_format(FrameFormat format);
+
+    /// Get the frame buffer written by the emulator and returned by `step`.
+    inline FrameFormat get_frame_format() const { return _nes.ppu.get_frame_format(); }
+
+    /// Enable or disable the idle loop skipping, see `CPU::set_idle_loop_skip`.
+    /// @param enabled True to skip the idle loops.
+    inline void set_idle_loop_skip(bool enabled) {
+        join_step();
+        _nes.cpu.set_idle_loop_skip(enabled);
+    }
+
+    /// Check whether or not the idle loops are skipped.
+    inline bool get_idle_loop_skip() const { return _nes.cpu.get_idle_loop_skip(); }
+
+    /// Convert the indexed frame buffer into the given pixel format.
+    /// @param format Output pixel format.
+    /// @param downsample Downsampling factor (1, 2 or 4, luma only).
+    /// @return The converted frame.
+    pybind11::array_t<uint8_t> convert_frame(palette::PixelFormat format, uint8_t downsample);
 
     /// Check whether or not the emulator has hit a JAM instruction.
     /// @note When the emulator has crashed, subsequent calls to `NesWrapper::step` will
     /// not do anything. Resetting the emulator or loading a valid save-state will reset
     /// this flag.
     /// @return True if the emulator crashed, false otherwise.
-    inline bool has_crashed() const { return _crashed; }
+    inline bool has_crashed() const {
+        join_step();
+        return _crashed;
+    }
+
+    /// Get the profiling counters of the emulator.
+    /// @note The counters stay zero unless the module is built with `CYNES_PROFILE`.
+    inline Counters get_counters() const {
+        join_step();
+        return _nes.counters;
+    }
+
+    /// Reset the profiling counters to zero.
+    inline void reset_counters() {
+        join_step();
+        _nes.reset_counters();
+    }
+
+    /// Set the addresses whose values are gathered at the end of every frame.
+    /// @param addresses Watched addresses, in the console RAM or the mapper space.
+    void set_watch_list(pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> addresses);
+
+    /// Get the values of the watched addresses, as of the end of the last frame.
+    /// @return Watched values.
+    pybind11::array_t<uint8_t> get_watch_values() const;
+
+    /// Add a condition ending the steps early.
+    /// @param address Address of the watched byte.
+    /// @param value Value compared against.
+    /// @param comparison Comparison between the masked byte and the value.
+    /// @param mask Mask applied to the byte before the comparison.
+    inline void add_done_condition(uint16_t address, uint8_t value, Comparison comparison, uint8_t mask) {
+        join_step();
+        _nes.add_done_condition({address, comparison, value, mask});
+    }
+
+    /// Remove every done condition.
+    inline void clear_done_conditions() {
+        join_step();
+        _nes.clear_done_conditions();
+    }
+
+    /// Check whether or not a done condition ended the last step.
+    inline bool is_done() const {
+        join_step();
+        return _nes.is_done();
+    }
+
+    /// Keep a ring of the last processed observations, updated by every step.
+    /// @note The frame buffer format should be `FrameFormat::INDEXED`.
+    /// @param depth Number of observations kept.
+    /// @param format Pixel format of the observations.
+    /// @param downsample Downsampling factor (1, 2 or 4, luma only).
+    /// @param max_pool Whether or not the observations are max-pooled over the last two
+    /// frames of each step.
+    void enable_frame_stack(size_t depth, palette::PixelFormat format, uint8_t downsample, bool max_pool);
+
+    /// Stop updating the ring of observations, and release it.
+    void disable_frame_stack();
+
+    /// Fill the ring of observations with the current frame.
+    void reset_frame_stack();
+
+    /// Get the read-only ring of observations.
+    /// @return Zero-copy view of the ring.
+    const pybind11::array_t<uint8_t>& get_frame_stack() const;
+
+    /// Get the slot of the ring holding the oldest observation.
+    size_t get_frame_stack_start() const;
+
+    /// Start synthesizing the audio of the following frames.
+    /// @note The audio is not part of the save states, nor of the copies. The
+    /// synthesizer is seeded again from the APU registers after every load or reset.
+    /// @param sample_rate Output sample rate in Hz.
+    /// @param depth Number of frames kept in the ring of samples.
+    void enable_audio(unsigned int sample_rate, size_t depth);
+
+    /// Stop synthesizing audio, and release the ring of samples.
+    void disable_audio();
+
+    /// Get the read-only ring of samples, with a shape of (depth, frame capacity).
+    /// @return Zero-copy view of the ring.
+    const pybind11::array_t<float>& get_audio() const;
+
+    /// Get the read-only number of samples written to each slot of the ring.
+    /// @return Zero-copy view of the lengths.
+    const pybind11::array_t<uint32_t>& get_audio_lengths() const;
+
+    /// Get the slot of the ring holding the oldest frame of samples.
+    size_t get_audio_start() const;
+
+    /// Gather the samples of the last frames, in chronological order.
+    /// @param frames Number of frames, at most the depth of the ring.
+    /// @return The concatenated samples.
+    pybind11::array_t<float> read_audio(size_t frames) const;
 
 public:
     uint16_t controller;
 
+private:
+    NesWrapper(NesWrapper& other);
+
+    /// Step the emulation, through the frame stack if enabled.
+    void run_step(uint16_t controllers, uint32_t frames, RenderPolicy render);
+
+    /// Wait for the pending step, if any.
+    /// @note The exception thrown by the step, if any, is rethrown.
+    void join_step() const;
+
+    /// Run the steps started by `NesWrapper::step_async`, until the wrapper is
+    /// destroyed.
+    void run_step_worker();
+
+    /// Create the read-only views of the frame buffers missing one.
+    void add_frame_views();
+
+    /// Get the read-only view of the frame buffer currently composed into.
+    const pybind11::array_t<uint8_t>& get_frame() const;
+
 private:
     NES _nes;
     const size_t _save_state_size;
 
-    pybind11::array_t<uint8_t> _frame;
+    std::vector<pybind11::array_t<uint8_t>> _frames;
+    std::vector<pybind11::array_t<uint8_t>> _frames_indices;
     bool _crashed;
+
+    // The pending step is handed to a single persistent worker, the synchronization
+    // members are mutable as the const getters wait for the step as well.
+    std::thread _step_worker;
+    mutable std::mutex _step_mutex;
+    mutable std::condition_variable _step_condition;
+    mutable std::exception_ptr _step_error;
+
+    uint16_t _step_controllers;
+    uint32_t _step_frames;
+    RenderPolicy _step_render;
+    bool _step_pending;
+    bool _step_stop;
+
+    std::unique_ptr<FrameStack> _frame_stack;
+    pybind11::array_t<uint8_t> _frame_stack_view;
+
+    pybind11::array_t<float> _audio_view;
+    pybind11::array_t<uint32_t> _audio_lengths_view;
+
+    std::unique_ptr<uint8_t[]> _compressed_buffer;
+};
+
+/// Fixed set of worker threads used to dispatch batched jobs.
+class ThreadPool {
+public:
+    /// Initialize the pool.
+    /// @param threads Number of threads used to run the jobs, including the calling
+    /// thread.
+    ThreadPool(size_t threads);
+
+    /// Stop and join the worker threads.
+    ~ThreadPool();
+
+    /// Run the given task for every index in [0, count).
+    /// @note The calling thread takes part in the work, this function only returns once
+    /// every index has been processed. The indices are split into one contiguous range
+    /// per thread, which only takes indices from the other ranges once its own is
+    /// exhausted. A given index is therefore run by the same thread from one call to
+    /// the next, unless it was taken by an idle thread. If the task throws, the other
+    /// indices are still processed, and the first exception is rethrown once every
+    /// thread is done.
+    /// @param count Number of indices.
+    /// @param task Task to run.
+    void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    /// Indices left to a single thread, on their own cache line.
+    struct alignas(64) Range {
+        std::atomic<size_t> next;
+        size_t end;
+    };
+
+    std::vector<std::thread> _workers;
+    std::unique_ptr<Range[]> _ranges;
+
+    std::mutex _mutex;
+    std::condition_variable _condition_start;
+    std::condition_variable _condition_done;
+
+    const std::function<void(size_t)>* _task;
+    std::exception_ptr _error;
+
+    size_t _active;
+    uint64_t _generation;
+    bool _stop;
+
+private:
+    void run_worker(size_t thread);
+    void run_task(size_t thread);
+};
+
+/// Batched NES wrapper for Python bindings.
+/// @note Every emulator of the batch is stepped at once on a pool of worker threads,
+/// with the GIL released during the whole emulation.
+class VecNesWrapper {
+public:
+    /// Initialize the emulators.
+    /// @param path_rom Path to the ROM file.
+    /// @param count Number of emulators.
+    /// @param threads Number of threads used to step the emulators, 0 to use the
+    /// hardware concurrency.
+    VecNesWrapper(const char* path_rom, size_t count, size_t threads);
+
+    /// Initialize the emulators from an already loaded ROM.
+    /// @param rom Shared ROM.
+    /// @param count Number of emulators.
+    /// @param threads Number of threads used to step the emulators, 0 to use the
+    /// hardware concurrency.
+    VecNesWrapper(const RomWrapper& rom, size_t count, size_t threads);
+
+    // Default destructor.
+    ~VecNesWrapper() = default;
+
+    /// Step every emulator by the given amount of frame.
+    /// @param controllers Controllers states of each emulator.
+    /// @param frames Number of frame of the step.
+    /// @param render Frames of the step composed into the framebuffers.
+    /// @return A tuple containing the read-only framebuffers and the crashed flags.
+    pybind11::tuple step(
+        pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> controllers,
+        uint32_t frames,
+        RenderPolicy render
+    );
+
+    /// Step every emulator through its own tape of controller states, in parallel.
+    /// @note The tape stops early when the CPU freezes or when a done condition is
+    /// met. The frame stack is not updated by the tape.
+    /// @param controllers Controllers state of each action of each emulator, (N, T).
+    /// @param frames_per_action Number of frame each action is held for.
+    /// @param capture_every Number of actions between two captures, 0 to only capture
+    /// the end of the tape.
+    /// @param capture_frames Whether or not the frame buffers are captured.
+    /// @param capture_states Whether or not the save states are captured.
+    /// @param capture_watch Whether or not the watched values are captured.
+    /// @return A dictionary holding the number of actions run and the captures.
+    pybind11::dict run_tape(
+        pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> controllers,
+        uint32_t frames_per_action,
+        uint32_t capture_every,
+        bool capture_frames,
+        bool capture_states,
+        bool capture_watch
+    );
+
+    /// Reset every emulator (same effect as pressing the reset button).
+    void reset();
+
+    /// Save the state of every emulator into a caller-provided buffer.
+    /// @note The buffer is written in place, nothing is allocated.
+    /// @param buffer Writable contiguous buffer with a shape of (N, `get_state_size`).
+    void save_into(pybind11::buffer buffer);
+
+    /// Load the state of every emulator directly from a caller-provided buffer.
+    /// @note The buffer is read in place, without any copy. This function also reset
+    /// the crashed flags.
+    /// @param buffer Contiguous buffer with a shape of (N, `get_state_size`).
+    void load_from(pybind11::buffer buffer);
+
+    /// Get the size of the save state of a single emulator in bytes.
+    inline size_t get_state_size() const { return _save_state_size; }
+
+    /// Save the state of every emulator into a slot of a state pool.
+    /// @param pool State pool, whose slot size should match the save state size.
+    /// @param slots Distinct allocated slot index of each emulator.
+    void save_slots(
+        StatePool& pool,
+        pybind11::array_t<uint64_t, pybind11::array::c_style | pybind11::array::forcecast> slots
+    );
+
+    /// Load the state of every emulator from a slot of a state pool.
+    /// @note A slot can be loaded by several emulators. This function also reset the
+    /// crashed flags.
+    /// @param pool State pool, whose slot size should match the save state size.
+    /// @param slots Allocated slot index of each emulator, previously saved.
+    void load_slots(
+        StatePool& pool,
+        pybind11::array_t<uint64_t, pybind11::array::c_style | pybind11::array::forcecast> slots
+    );
+
+    /// Compute a fingerprint of the state of every emulator.
+    /// @param ram_only Whether or not only the console RAM and the mapper CPU RAM are
+    /// hashed.
+    /// @return The 64-bit XXH64 hash of each emulator.
+    pybind11::array_t<uint64_t> state_hash(bool ram_only);
+
+    /// Select the frame buffer written by every emulator and returned by `step`.
+    /// @param format Frame buffer format.
+    void set_frame_format(FrameFormat format);
+
+    /// Get the frame buffer written by the emulators and returned by `step`.
+    inline FrameFormat get_frame_format() const { return _frame_format; }
+
+    /// Enable or disable the idle loop skipping of every emulator, see
+    /// `CPU::set_idle_loop_skip`.
+    /// @param enabled True to skip the idle loops.
+    void set_idle_loop_skip(bool enabled);
+
+    /// Check whether or not the idle loops are skipped.
+    inline bool get_idle_loop_skip() const { return _emulators.front()->cpu.get_idle_loop_skip(); }
+
+    /// Enable or disable the lockstep stepping of the emulators.
+    /// @note Emulators with identical states (same state hash and crashed flag) stepped
+    /// with the same controllers are only stepped once, and the resulting state is
+    /// copied to the others. The lockstep is ignored while the frame stack is enabled.
+    /// @param enabled True to step the identical emulators once.
+    inline void set_lockstep(bool enabled) { _lockstep = enabled; }
+
+    /// Check whether or not the identical emulators are stepped once.
+    inline bool get_lockstep() const { return _lockstep; }
+
+    /// Get the number of emulators actually stepped by the last step.
+    inline size_t get_stepped_count() const { return _stepped_count; }
+
+    /// Convert the indexed frame buffer of every emulator into the given pixel format.
+    /// @param format Output pixel format.
+    /// @param downsample Downsampling factor (1, 2 or 4, luma only).
+    /// @return The converted frames.
+    pybind11::array_t<uint8_t> convert_frames(palette::PixelFormat format, uint8_t downsample);
+
+    /// Get the number of emulators.
+    inline size_t size() const { return _emulators.size(); }
+
+    /// Get the crashed flags of the emulators.
+    inline const pybind11::array_t<bool>& has_crashed() const { return _crashed_view; }
+
+    /// Set the addresses whose values are gathered at the end of every frame, for
+    /// every emulator.
+    /// @param addresses Watched addresses, in the console RAM or the mapper space.
+    void set_watch_list(pybind11::array_t<uint16_t, pybind11::array::c_style | pybind11::array::forcecast> addresses);
+
+    /// Get the values of the watched addresses of every emulator, as of the end of
+    /// their last frame.
+    /// @return Watched values, with a shape of (N, K).
+    pybind11::array_t<uint8_t> get_watch_values() const;
+
+    /// Add a condition ending the steps of every emulator early.
+    /// @param address Address of the watched byte.
+    /// @param value Value compared against.
+    /// @param comparison Comparison between the masked byte and the value.
+    /// @param mask Mask applied to the byte before the comparison.
+    void add_done_condition(uint16_t address, uint8_t value, Comparison comparison, uint8_t mask);
+
+    /// Remove every done condition.
+    void clear_done_conditions();
+
+    /// Get the done flags of the emulators, set when a done condition ended their
+    /// last step.
+    inline const pybind11::array_t<bool>& is_done() const { return _done_view; }
+
+    /// Keep a ring of the last processed observations of every emulator, updated by
+    /// every step.
+    /// @note The frame buffer format of the emulators should be `FrameFormat::INDEXED`.
+    /// @param depth Number of observations kept.
+    /// @param format Pixel format of the observations.
+    /// @param downsample Downsampling factor (1, 2 or 4, luma only).
+    /// @param max_pool Whether or not the observations are max-pooled over the last two
+    /// frames of each step.
+    void enable_frame_stack(size_t depth, palette::PixelFormat format, uint8_t downsample, bool max_pool);
+
+    /// Stop updating the ring of observations, and release it.
+    void disable_frame_stack();
+
+    /// Fill the ring of observations of every emulator with its current frame.
+    void reset_frame_stack();
+
+    /// Get the read-only ring of observations, with a shape of (N, K, ...).
+    /// @return Zero-copy view of the ring.
+    const pybind11::array_t<uint8_t>& get_frame_stack() const;
+
+    /// Get the slot of the ring holding the oldest observation.
+    size_t get_frame_stack_start() const;
+
+private:
+    std::vector<std::unique_ptr<NES>> _emulators;
+    std::vector<uint16_t> _controllers;
+
+    bool _lockstep;
+    size_t _stepped_count;
+
+    std::vector<uint64_t> _hashes;
+    std::vector<size_t> _leaders;
+    std::vector<size_t> _stepped;
+
+    size_t _save_state_size;
+
+    std::unique_ptr<uint8_t[]> _frames;
+    std::unique_ptr<bool[]> _crashed;
+    std::unique_ptr<bool[]> _done;
+
+    pybind11::array_t<uint8_t> _frames_view;
+    pybind11::array_t<uint8_t> _indices_view;
+    pybind11::array_t<bool> _crashed_view;
+    pybind11::array_t<bool> _done_view;
+
+    FrameFormat _frame_format;
+
+    std::unique_ptr<FrameStack> _frame_stack;
+    pybind11::array_t<uint8_t> _frame_stack_view;
+
+    ThreadPool _pool;
+
+private:
+    /// Step a single emulator, and copy its frame buffer into the batch.
+    void step_emulator(size_t index, uint32_t frames, RenderPolicy render);
+
+    /// Group the emulators with identical states and controllers, filling the
+    /// emulators to step and the leader of every emulator.
+    void group_emulators();
 };
 }
 }